@@ -0,0 +1,42 @@
+/*
+ * Article block codec
+ */
+
+#include "article_bpe.h"
+
+bool article_bpe_check(const uint8_t pairs[ARTICLE_BPE_PAIRS][2]) {
+    for (int c = 0; c < ARTICLE_BPE_PAIRS; c++) {
+        if (pairs[c][0] == c) continue;
+        for (int k = 0; k < 2; k++) {
+            uint8_t b = pairs[c][k];
+            if (pairs[b][0] != b && b >= c) return false;
+        }
+    }
+    return true;
+}
+
+int article_bpe_decode(const uint8_t* src, int len, const uint8_t pairs[ARTICLE_BPE_PAIRS][2],
+                       uint8_t* out, int out_len) {
+    // Pairs only hold smaller pairs, so the right halves waiting to be
+    // expanded never number more than the pair bytes
+    uint8_t stack[ARTICLE_BPE_PAIRS];
+    uint8_t* o = out;
+    uint8_t* o_end = out + out_len;
+    
+    for (int i = 0; i < len; i++) {
+        int sp = 0;
+        uint8_t c = src[i];
+        while (true) {
+            if (pairs[c][0] == c) {
+                if (o == o_end) return -1;
+                *o++ = c;
+                if (sp == 0) break;
+                c = stack[--sp];
+            } else {
+                stack[sp++] = pairs[c][1];
+                c = pairs[c][0];
+            }
+        }
+    }
+    return o == o_end ? out_len : -1;
+}
@@ -0,0 +1,33 @@
+/*
+ * Article block codec
+ *
+ * Byte pair encoding with a static dictionary: each byte value that never
+ * occurs in the text stands for a pair of bytes, either of which may be
+ * a pair again. article_manager.py trains the pairs on the whole corpus,
+ * merging the most frequent pair of English prose ("E ", "TH", then
+ * "THE ", ...) into a free byte value until none is left, and codes every
+ * block with them. A block then decodes on its own, by looking bytes up
+ * and nothing else.
+ *
+ * The dictionary is 256 pairs, one for every byte value. A byte whose
+ * pair starts with itself is text; any other pair holds only text bytes
+ * and smaller pair bytes, so that expanding one always comes to an end.
+ */
+
+#ifndef ARTICLE_BPE_H
+#define ARTICLE_BPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ARTICLE_BPE_PAIRS   256
+
+// Check that pairs is a dictionary as above
+bool article_bpe_check(const uint8_t pairs[ARTICLE_BPE_PAIRS][2]);
+
+// Decode the len bytes at src, which expand to exactly out_len bytes, into
+// out. Returns out_len, or -1 if they expand to anything else.
+int article_bpe_decode(const uint8_t* src, int len, const uint8_t pairs[ARTICLE_BPE_PAIRS][2],
+                       uint8_t* out, int out_len);
+
+#endif // ARTICLE_BPE_H
@@ -1,13 +1,20 @@
 #!/usr/bin/env python3
 """
 Hitchhiker's Guide Article Manager
-Helps create, edit, and organize Guide articles
+Helps create, edit, and organize Guide articles, and packs the built-in
+ones into C for the firmware
 """
 
 import os
+import re
+import struct
 import sys
+from collections import Counter
 from pathlib import Path
 
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+import gen_glyph_atlas
+
 GUIDE_DIR = "sd_card/guide"
 INDEX_FILE = f"{GUIDE_DIR}/index.txt"
 
@@ -311,7 +318,336 @@ def show_stats():
         count = by_category[category]
         print(f"  {category}: {count}")
 
+def fold_upper(text):
+    """Upper case the way LCD_GLYPH_UPPER folds it: a-z and Latin-1 letters"""
+    return "".join(chr(ord(c) - 32) if "a" <= c <= "z" or (0xE0 <= ord(c) <= 0xFE and c != "\u00F7") else c
+                   for c in text)
+
+def wrap_lines(text, width, advance, kerns):
+    """(byte offset, byte length) of every line of text, broken exactly as
+    lcd_metrics_wrap breaks it"""
+    chars = []
+    offset = 0
+    for c in text:
+        chars.append((offset, ord(c)))
+        offset += len(c.encode("utf-8"))
+    end = offset
+    chars.append((end, 0))
+
+    def trim(i, j):
+        while j > i and chars[j - 1][1] == 0x20:
+            j -= 1
+        return chars[j][0] - chars[i][0]
+
+    lines = []
+    i = 0
+    while True:
+        # One line from character i: (length, where the next one starts)
+        space = None
+        prev = 0
+        pen = 0
+        j = i
+        line = None
+        while j < len(chars) - 1:
+            cp = chars[j][1]
+            if cp == 0x0A:
+                line = (trim(i, j), j + 1)
+                break
+            w = pen + (kerns.get((prev, cp), 0) if prev else 0) + advance(cp)
+            if w > width and j > i:
+                cut = j if cp == 0x20 else (space if space is not None else j)
+                resume = cut
+                while resume < len(chars) - 1 and chars[resume][1] == 0x20:
+                    resume += 1
+                line = (trim(i, cut), resume)
+                break
+            if cp == 0x20:
+                space = j
+            pen = w
+            prev = cp
+            j += 1
+        if line is None:
+            line = (end - chars[i][0], len(chars) - 1)
+        lines.append((chars[i][0], line[0]))
+        if line[1] >= len(chars) - 1:
+            return lines
+        i = line[1]
+
+# Pack format and block codec, read from article_pack.h and article_bpe.h
+# so the firmware and this tool cannot disagree about them
+C_TYPES = {"uint8_t": "B", "uint16_t": "H", "uint32_t": "I"}
+
+def read_pack_format(here):
+    """({define: number}, {struct name: (struct.Struct, field names)}) of
+    the headers in here, defines without their ARTICLE_ prefix"""
+    defines, structs = {}, {}
+    for header in ("article_pack.h", "article_bpe.h"):
+        text = (Path(here) / header).read_text()
+        defines.update({name: int(value, 0) for name, value in
+                        re.findall(r"#define\s+ARTICLE_(\w+)\s+(0x[0-9A-Fa-f]+|\d+)", text)})
+        for body, name in re.findall(r"typedef struct \{(.*?)\} (\w+);", text, re.S):
+            fields = re.findall(r"^\s*(uint\d+_t)\s+(\w+);", body, re.M)
+            layout = struct.Struct("<" + "".join(C_TYPES[t] for t, _ in fields))
+            structs[name] = (layout, [f for _, f in fields])
+    return defines, structs
+
+BPE_TRAIN = 256 * 1024     # most text the pairs are trained on
+
+def bpe_train(blocks, num_pairs):
+    """article_bpe.h dictionary for blocks, as a list of num_pairs (left,
+    right) pairs, one per byte value: the most frequent pair of bytes or
+    pairs, merged into free byte values in increasing order while one
+    still occurs twice. None if every byte value is taken. A large corpus
+    is trained on blocks spread evenly through it."""
+    used = set(b for block in blocks for b in block)
+    free = [c for c in range(num_pairs) if c not in used]
+    if not free:
+        return None
+
+    total = sum(len(block) for block in blocks)
+    if total > BPE_TRAIN:
+        step = total / BPE_TRAIN
+        blocks = [blocks[int(k * step)] for k in range(int(len(blocks) / step))] or blocks[:1]
+
+    pairs = [(c, c) for c in range(num_pairs)]
+    for code in free:
+        counts = Counter()
+        for block in blocks:
+            counts.update(zip(block, block[1:]))
+        best = max(counts, key=counts.get, default=None)
+        if best is None or counts[best] < 2:
+            break
+        pairs[code] = best
+        blocks = [block.replace(bytes(best), bytes([code])) for block in blocks]
+    return pairs
+
+def bpe_encode(block, pairs):
+    """block coded with pairs (as bpe_train), merged in the order trained"""
+    for code in sorted(c for c, pair in enumerate(pairs) if pair[0] != c):
+        block = block.replace(bytes(pairs[code]), bytes([code]))
+    return block
+
+def bpe_decode(src, pairs):
+    """The bytes src expands to, as article_bpe_decode"""
+    out = bytearray()
+
+    def expand(c):
+        if pairs[c][0] == c:
+            out.append(c)
+        else:
+            expand(pairs[c][0])
+            expand(pairs[c][1])
+
+    for c in src:
+        expand(c)
+    return bytes(out)
+
+def write_pack(articles, layout, fmt):
+    """Pack bytes for [(title, category, body, [(start, length)])], the
+    line tables wrapped as layout = (scale, flags, width)"""
+    defines, structs = fmt
+    header, header_fields = structs["article_pack_header_t"]
+    entry, entry_fields = structs["article_pack_entry_t"]
+    block_size = defines["PACK_BLOCK"]
+
+    bodies = [body.encode("utf-8") for _, _, body, _ in articles]
+    blocks = [[body[k:k + block_size] for k in range(0, len(body), block_size)] for body in bodies]
+    pairs = bpe_train([block for body in blocks for block in body], defines["BPE_PAIRS"])
+
+    data = bytearray(header.size + entry.size * len(articles))
+    entries = []
+    for (title, category, _, lines), body in zip(articles, bodies):
+        fields = {"body_len": len(body), "num_lines": len(lines), "reserved": 0}
+        for name, text in (("title", title), ("category", category)):
+            raw = text.encode("utf-8")
+            fields[name] = len(data)
+            fields[name + "_len"] = len(raw)
+            data += raw + b"\0"
+        entries.append(fields)
+    dict_offset = len(data)
+    if pairs:
+        data += bytes(b for pair in pairs for b in pair)
+    dict_len = len(data) - dict_offset
+    offsets = []
+    for body in blocks:
+        offsets.append([len(data)])
+        for block in body:
+            data += bpe_encode(block, pairs) if pairs else block
+            offsets[-1].append(len(data))
+    for fields, starts, (_, _, _, lines) in zip(entries, offsets, articles):
+        data += bytes(-len(data) % 4)
+        fields["blocks"] = len(data)
+        data += struct.pack(f"<{len(starts)}I", *starts)
+        fields["lines"] = len(data)
+        data += struct.pack(f"<{len(lines)}I", *(start for start, _ in lines))
+        data += struct.pack(f"<{len(lines)}H", *(length for _, length in lines))
+    data += bytes(-len(data) % 4)
+
+    scale, flags, width = layout
+    values = {"magic": defines["PACK_MAGIC"], "version": defines["PACK_VERSION"],
+              "header_size": header.size, "size": len(data), "num_articles": len(articles),
+              "entry_size": entry.size, "scale": scale, "flags": flags, "width": width,
+              "dict": dict_offset, "dict_len": dict_len, "block_size": block_size}
+    header.pack_into(data, 0, *(values[f] for f in header_fields))
+    for i, fields in enumerate(entries):
+        entry.pack_into(data, header.size + i * entry.size, *(fields[f] for f in entry_fields))
+    return bytes(data)
+
+def read_pack(data, fmt):
+    """(layout, articles, sizes, dictionary length) of pack bytes, layout
+    and articles as write_pack takes them, sizes (text, compressed) of
+    each body"""
+    defines, structs = fmt
+    header, header_fields = structs["article_pack_header_t"]
+    entry, entry_fields = structs["article_pack_entry_t"]
+
+    h = dict(zip(header_fields, header.unpack_from(data, 0)))
+    if h["magic"] != defines["PACK_MAGIC"]:
+        raise ValueError("not an article pack")
+    if h["version"] != defines["PACK_VERSION"]:
+        raise ValueError(f"pack version {h['version']}, expected {defines['PACK_VERSION']}")
+    if (h["header_size"], h["entry_size"], h["size"]) != (header.size, entry.size, len(data)):
+        raise ValueError("pack header does not match its size")
+    pairs = None
+    if h["dict_len"]:
+        raw = data[h["dict"]:h["dict"] + h["dict_len"]]
+        pairs = list(zip(raw[0::2], raw[1::2]))
+        if any(pairs[c][0] != c and any(pairs[b][0] != b and b >= c for b in pairs[c])
+               for c in range(len(pairs))):
+            raise ValueError("pairs that do not come to an end")
+
+    def string(offset, length):
+        if data[offset + length] != 0:
+            raise ValueError(f"string at {offset} is not terminated")
+        return data[offset:offset + length].decode("utf-8")
+
+    articles, sizes = [], []
+    for i in range(h["num_articles"]):
+        e = dict(zip(entry_fields, entry.unpack_from(data, h["header_size"] + i * h["entry_size"])))
+        num_blocks = -(-e["body_len"] // h["block_size"])
+        starts = struct.unpack_from(f"<{num_blocks + 1}I", data, e["blocks"])
+        body = bytearray()
+        for k in range(num_blocks):
+            block = data[starts[k]:starts[k + 1]]
+            text = bpe_decode(block, pairs) if pairs else block
+            if len(text) != min(h["block_size"], e["body_len"] - k * h["block_size"]):
+                raise ValueError(f"block {k} of article {i} has the wrong length")
+            body += text
+        n = e["num_lines"]
+        lines = list(zip(struct.unpack_from(f"<{n}I", data, e["lines"]),
+                         struct.unpack_from(f"<{n}H", data, e["lines"] + 4 * n)))
+        articles.append((string(e["title"], e["title_len"]), string(e["category"], e["category_len"]),
+                         body.decode("utf-8"), lines))
+        sizes.append((e["body_len"], starts[-1] - starts[0]))
+    return (h["scale"], h["flags"], h["width"]), articles, sizes, h["dict_len"]
+
+def c_array(data, name, source):
+    """C source for pack bytes, in a flash section of their own"""
+    out = []
+    out.append(f"/* Generated by article_manager.py from {source} - do not edit */")
+    out.append("")
+    out.append('#include "article_pack.h"')
+    out.append('#include "pico.h"')
+    out.append("")
+    out.append(f"// {len(data)} bytes, read in place through XIP")
+    out.append(f'const uint8_t __in_flash("article_pack") __attribute__((aligned(4))) {name}[{len(data)}] = {{')
+    for k in range(0, len(data), 16):
+        out.append("    " + " ".join(f"0x{b:02X}," for b in data[k:k + 16]))
+    out.append("};")
+    return "\n".join(out) + "\n"
+
+def compression(sizes, dict_len):
+    """Summary of how well bodies of sizes (as read_pack) compressed"""
+    text = sum(t for t, _ in sizes)
+    packed = sum(c for _, c in sizes) + dict_len
+    return (f"{text} bytes of text in {packed} ({100 * packed / max(text, 1):.1f}%, "
+            f"{dict_len} of them dictionary)")
+
+def pack_articles(guide_dir, out_path, sets, width):
+    """Pack the articles of guide_dir/index.txt (see article_pack.h):
+    bodies in upper case, wrapped for the teleprinter view in the 5x7
+    font at 1x, width pixels wide, and compressed. A .c out_path gets the
+    pack as a C array to link into the firmware, anything else the pack
+    itself."""
+    here = Path(gen_glyph_atlas.__file__).parent
+    glyphs = gen_glyph_atlas.load_glyphs(here / "font5x7.c", here / "font5x7_ext.txt", sets)
+    kerns = {(left, right): adjust for left, right, adjust in
+             gen_glyph_atlas.kerning({cp: cols for cp, (cols, _) in glyphs.items()})}
+    missing = gen_glyph_atlas.advance(*glyphs[0x20])
+
+    def advance(cp):
+        return gen_glyph_atlas.advance(*glyphs[cp]) if cp in glyphs else missing
+
+    articles = []
+    with open(f"{guide_dir}/index.txt", encoding="utf-8") as f:
+        for i, line in enumerate(f, 1):
+            if not line.strip():
+                continue
+            parts = line.strip().split('|')
+            if len(parts) != 3:
+                sys.exit(f"{guide_dir}/index.txt:{i}: expected title|file|category")
+            title, filename, category = parts
+            try:
+                with open(f"{guide_dir}/{filename}", encoding="utf-8") as af:
+                    body = fold_upper(af.read().rstrip("\n"))
+            except UnicodeDecodeError as e:
+                sys.exit(f"{guide_dir}/{filename}: not UTF-8 ({e.reason})")
+            articles.append((title, category, body, wrap_lines(body, width, advance, kerns)))
+
+    # Whatever is packed has to read back the same
+    fmt = read_pack_format(here)
+    layout = (1, 0, width)
+    data = write_pack(articles, layout, fmt)
+    read_layout, read_articles, sizes, dict_len = read_pack(data, fmt)
+    if (read_layout, read_articles) != (layout, articles):
+        sys.exit("article pack does not read back as written")
+    print(f"{out_path}: {len(articles)} articles, {compression(sizes, dict_len)}")
+
+    if str(out_path).endswith(".c"):
+        with open(out_path, "w", encoding="utf-8") as f:
+            f.write(c_array(data, "guide_pack", f"{guide_dir}/"))
+    else:
+        with open(out_path, "wb") as f:
+            f.write(data)
+
+def dump_pack(pack_path):
+    """List what a pack holds"""
+    here = Path(__file__).resolve().parent
+    with open(pack_path, "rb") as f:
+        data = f.read()
+    try:
+        (scale, flags, width), articles, sizes, dict_len = read_pack(data, read_pack_format(here))
+    except (ValueError, struct.error, IndexError, UnicodeDecodeError) as e:
+        sys.exit(f"{pack_path}: {e}")
+    print(f"{pack_path}: {len(data)} bytes, {len(articles)} articles, "
+          f"lines wrapped at scale {scale}, flags {flags}, {width} px")
+    print(f"  {compression(sizes, dict_len)}")
+    for (title, category, _, lines), (text, packed) in zip(articles, sizes):
+        print(f"  {title:<30} {category:<18} {text:7} bytes in {packed:7} {len(lines):6} lines")
+
+def pack_command(args):
+    """article_manager.py pack [--sets a,b,...] [--width N] DIR OUT"""
+    sets, width = None, 305
+    while len(args) > 2 and args[0] in ("--sets", "--width"):
+        if args[0] == "--sets":
+            sets = [name for name in args[1].split(",") if name]
+        else:
+            width = int(args[1])
+        args = args[2:]
+    if len(args) != 2:
+        print("Usage: article_manager.py pack [--sets a,b,...] [--width N] DIR OUT.pack|OUT.c")
+        sys.exit(1)
+    pack_articles(args[0], args[1], sets, width)
+
 def main():
+    # Packing runs in the build tree and must not create a guide there
+    if len(sys.argv) >= 2 and sys.argv[1].lower() == "pack":
+        pack_command(sys.argv[2:])
+        return
+    if len(sys.argv) == 3 and sys.argv[1].lower() == "dump":
+        dump_pack(sys.argv[2])
+        return
+
     ensure_guide_dir()
     
     if len(sys.argv) < 2:
@@ -325,6 +661,8 @@ def main():
         print("  validate     - Check for issues")
         print("  stats        - Show statistics")
         print("  export       - Export instructions")
+        print("  pack DIR OUT - Pack DIR/index.txt for the firmware (.pack, or .c to link)")
+        print("  dump PACK    - List the articles in a pack")
         print("\nExample:")
         print("  python3 article_manager.py create")
         print("  python3 article_manager.py search earth")
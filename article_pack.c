@@ -0,0 +1,206 @@
+/*
+ * Article pack
+ */
+
+#include "article_pack.h"
+#include "article_bpe.h"
+#include <stddef.h>
+#include <string.h>
+
+_Static_assert(sizeof(article_pack_header_t) == 28, "article pack header has padding");
+_Static_assert(sizeof(article_pack_entry_t) == 28, "article pack entry has padding");
+
+static const uint8_t* article_pack = NULL;
+
+// Blocks decoded lately. Two, so that a window of text that straddles a
+// block boundary does not decode the same blocks over and over.
+typedef struct {
+    const article_pack_entry_t* entry;      // NULL for an unused buffer
+    int block;
+    int len;
+    uint8_t text[ARTICLE_PACK_BLOCK];
+} article_pack_cached_t;
+
+static article_pack_cached_t article_pack_cache[2];
+static int article_pack_oldest;
+
+static const article_pack_header_t* article_pack_header(void) {
+    return (const article_pack_header_t*)article_pack;
+}
+
+static const article_pack_entry_t* article_pack_entry(const uint8_t* pack, int index) {
+    const article_pack_header_t* h = (const article_pack_header_t*)pack;
+    return (const article_pack_entry_t*)(pack + h->header_size + index * h->entry_size);
+}
+
+static int article_pack_num_blocks(const uint8_t* pack, const article_pack_entry_t* e) {
+    uint32_t block_size = ((const article_pack_header_t*)pack)->block_size;
+    return (e->body_len + block_size - 1) / block_size;
+}
+
+// A NUL-terminated string of len bytes at offset, all inside the pack
+static bool article_pack_has_string(const uint8_t* pack, uint32_t offset, uint32_t len) {
+    uint32_t size = ((const article_pack_header_t*)pack)->size;
+    return offset < size && len < size - offset && pack[offset + len] == '\0';
+}
+
+// An aligned table of count entries of entry_size bytes inside the pack
+static bool article_pack_has_table(const uint8_t* pack, uint32_t offset, uint32_t count,
+                                   uint32_t entry_size) {
+    uint32_t size = ((const article_pack_header_t*)pack)->size;
+    return offset % 4 == 0 && offset <= size && count * entry_size <= size - offset;
+}
+
+// Everything an entry points at is inside the pack, every line inside the
+// body and no longer than the reader fetches, and no block bigger than
+// its text
+static bool article_pack_entry_ok(const uint8_t* pack, const article_pack_entry_t* e) {
+    const article_pack_header_t* h = (const article_pack_header_t*)pack;
+    int num_blocks = article_pack_num_blocks(pack, e);
+    if (!article_pack_has_string(pack, e->title, e->title_len) ||
+        !article_pack_has_string(pack, e->category, e->category_len) ||
+        !article_pack_has_table(pack, e->blocks, num_blocks + 1, sizeof(uint32_t)) ||
+        !article_pack_has_table(pack, e->lines, e->num_lines, sizeof(uint32_t) + sizeof(uint16_t))) {
+        return false;
+    }
+    
+    const uint32_t* blocks = (const uint32_t*)(pack + e->blocks);
+    for (int i = 0; i < num_blocks; i++) {
+        uint32_t text = e->body_len - i * h->block_size;
+        if (text > h->block_size) text = h->block_size;
+        if (blocks[i] > blocks[i + 1] || blocks[i + 1] > h->size || blocks[i + 1] - blocks[i] > text) {
+            return false;
+        }
+    }
+    
+    const uint32_t* starts = (const uint32_t*)(pack + e->lines);
+    const uint16_t* lengths = (const uint16_t*)(starts + e->num_lines);
+    for (int i = 0; i < e->num_lines; i++) {
+        if (starts[i] > e->body_len || lengths[i] > e->body_len - starts[i] ||
+            lengths[i] > ARTICLE_READER_MAX_LINE) return false;
+    }
+    return true;
+}
+
+// The whole pack is checked once here, so that article_pack_get, called
+// for every list row and body line drawn, only has to look things up
+bool article_pack_open(const uint8_t* data) {
+    const article_pack_header_t* h = (const article_pack_header_t*)data;
+    
+    article_pack = NULL;
+    for (int i = 0; i < 2; i++) {
+        article_pack_cache[i].entry = NULL;
+    }
+    
+    if (h->magic != ARTICLE_PACK_MAGIC || h->version != ARTICLE_PACK_VERSION) return false;
+    if (h->header_size != sizeof(article_pack_header_t) ||
+        h->entry_size != sizeof(article_pack_entry_t)) return false;
+    if (h->header_size + (uint32_t)h->num_articles * h->entry_size > h->size) return false;
+    if (h->block_size == 0 || h->block_size > ARTICLE_PACK_BLOCK) return false;
+    if (h->dict_len != 0) {
+        if (h->dict_len != sizeof(uint8_t[ARTICLE_BPE_PAIRS][2]) || h->dict > h->size ||
+            h->dict_len > h->size - h->dict) return false;
+        if (!article_bpe_check((const uint8_t (*)[2])(data + h->dict))) return false;
+    }
+    
+    for (int i = 0; i < h->num_articles; i++) {
+        if (!article_pack_entry_ok(data, article_pack_entry(data, i))) return false;
+    }
+    
+    article_pack = data;
+    return true;
+}
+
+int article_pack_count(void) {
+    return article_pack ? article_pack_header()->num_articles : 0;
+}
+
+static int article_pack_decode(const article_pack_entry_t* e, int block, uint8_t* out) {
+    const article_pack_header_t* h = article_pack_header();
+    if (block >= article_pack_num_blocks(article_pack, e)) return 0;
+    
+    const uint32_t* blocks = (const uint32_t*)(article_pack + e->blocks);
+    const uint8_t* src = article_pack + blocks[block];
+    int len = blocks[block + 1] - blocks[block];
+    int text = e->body_len - block * h->block_size;
+    if (text > h->block_size) text = h->block_size;
+    
+    if (h->dict_len == 0) {
+        if (len != text) return -1;
+        memcpy(out, src, len);
+        return len;
+    }
+    return article_bpe_decode(src, len, (const uint8_t (*)[2])(article_pack + h->dict), out, text);
+}
+
+// Read callback of every packed body: source is its entry
+static int article_pack_read(void* source, uint32_t offset, uint8_t* buf, int len) {
+    const article_pack_entry_t* e = source;
+    uint32_t block_size = article_pack_header()->block_size;
+    
+    int done = 0;
+    while (done < len) {
+        int block = offset / block_size;
+        article_pack_cached_t* c = NULL;
+        for (int i = 0; i < 2; i++) {
+            if (article_pack_cache[i].entry == e && article_pack_cache[i].block == block) {
+                c = &article_pack_cache[i];
+                article_pack_oldest = 1 - i;
+            }
+        }
+        if (!c) {
+            c = &article_pack_cache[article_pack_oldest];
+            c->entry = NULL;
+            c->len = article_pack_decode(e, block, c->text);
+            if (c->len <= 0) break;
+            c->entry = e;
+            c->block = block;
+            article_pack_oldest = 1 - article_pack_oldest;
+        }
+    
+        int at = offset - block * block_size;
+        int n = c->len - at;
+        if (n > len - done) n = len - done;
+        if (n <= 0) break;
+        memcpy(buf + done, c->text + at, n);
+        done += n;
+        offset += n;
+    }
+    return done;
+}
+
+bool article_pack_get(int index, Article* art) {
+    if (index < 0 || index >= article_pack_count()) return false;
+    
+    const article_pack_header_t* h = article_pack_header();
+    const article_pack_entry_t* e = article_pack_entry(article_pack, index);
+    
+    art->title = (const char*)(article_pack + e->title);
+    art->category = (const char*)(article_pack + e->category);
+    art->size = e->body_len;
+    art->num_lines = e->num_lines;
+    art->line_starts = e->num_lines ? (const uint32_t*)(article_pack + e->lines) : NULL;
+    art->line_lengths = (const uint16_t*)(article_pack + e->lines + e->num_lines * sizeof(uint32_t));
+    art->layout.scale = h->scale;
+    art->layout.flags = h->flags;
+    art->layout.width = h->width;
+    art->read = article_pack_read;
+    art->source = (void*)e;
+    return true;
+}
+
+int article_pack_block(int index, int block, uint8_t* out) {
+    if (index < 0 || index >= article_pack_count() || block < 0) return 0;
+    return article_pack_decode(article_pack_entry(article_pack, index), block, out);
+}
+
+void article_pack_sizes(uint32_t* text, uint32_t* packed) {
+    *text = 0;
+    *packed = article_pack ? article_pack_header()->dict_len : 0;
+    for (int i = 0; i < article_pack_count(); i++) {
+        const article_pack_entry_t* e = article_pack_entry(article_pack, i);
+        const uint32_t* blocks = (const uint32_t*)(article_pack + e->blocks);
+        *text += e->body_len;
+        *packed += blocks[article_pack_num_blocks(article_pack, e)] - blocks[0];
+    }
+}
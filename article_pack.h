@@ -0,0 +1,91 @@
+/*
+ * Article pack
+ *
+ * The built-in articles as one versioned binary image, linked into its
+ * own flash section and read where it lies through XIP. Titles and
+ * categories are used in place. Bodies are compressed (article_bpe.h) in
+ * blocks of block_size bytes of text, each of which decodes on its own,
+ * so reading any part of an article decodes a block or two into RAM and
+ * no more.
+ *
+ *   header     article_pack_header_t
+ *   index      num_articles article_pack_entry_t, fixed width
+ *   strings    titles and categories, UTF-8, NUL-terminated
+ *   dictionary the article_bpe.h pairs of every block, or nothing for
+ *              blocks of plain text (dict_len 0)
+ *   blocks     the compressed blocks of every body
+ *   tables     per article, 4-byte aligned: where each of its blocks
+ *              starts, and where the last one ends (uint32_t); then
+ *              num_lines uint32_t line starts and num_lines uint16_t
+ *              line lengths, in bytes of the text
+ *
+ * Offsets are from the start of the pack, numbers little-endian like the
+ * RP2040, and every field aligned to its size, since the M0+ cannot load
+ * unaligned words. article_manager.py writes and reads packs from the
+ * structs and numbers below (and article_bpe.h), so this file is the one
+ * definition of the format: change it, and bump ARTICLE_PACK_VERSION.
+ */
+
+#ifndef ARTICLE_PACK_H
+#define ARTICLE_PACK_H
+
+#include "articles.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ARTICLE_PACK_MAGIC      0x4B504748      // "HGPK"
+#define ARTICLE_PACK_VERSION    2
+#define ARTICLE_PACK_BLOCK      4096            // text in a block, at most
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;   // where the index starts
+    uint32_t size;          // of the whole pack
+    uint16_t num_articles;
+    uint16_t entry_size;
+    uint8_t scale;          // how the line tables were wrapped
+    uint8_t flags;
+    uint16_t width;
+    uint32_t dict;
+    uint16_t dict_len;
+    uint16_t block_size;    // text in every block but an article's last
+} article_pack_header_t;
+
+typedef struct {
+    uint32_t title;
+    uint32_t category;
+    uint32_t blocks;        // table of block offsets
+    uint32_t body_len;      // of the text
+    uint32_t lines;
+    uint16_t title_len;
+    uint16_t category_len;
+    uint16_t num_lines;
+    uint16_t reserved;
+} article_pack_entry_t;
+
+// The pack built from articles/, in flash
+extern const uint8_t guide_pack[];
+
+// Check the pack at data and read articles from it from now on. False
+// (and no articles) if it is not a pack of this version, or anything in
+// it points outside it.
+bool article_pack_open(const uint8_t* data);
+
+int article_pack_count(void);
+
+// Point *art at article index of the open pack; false if there is no
+// such article. The body is read through art->read,
+// which decodes the blocks asked for into one of two block buffers.
+bool article_pack_get(int index, Article* art);
+
+// Decode block `block` of article index into out (ARTICLE_PACK_BLOCK
+// bytes). Returns how much text it holds, 0 past the last block or -1 if
+// it is damaged.
+int article_pack_block(int index, int block, uint8_t* out);
+
+// Bytes of body text in the pack, and what they take compressed
+// (dictionary included)
+void article_pack_sizes(uint32_t* text, uint32_t* packed);
+
+#endif // ARTICLE_PACK_H
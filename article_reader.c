@@ -0,0 +1,183 @@
+/*
+ * Streaming article reader
+ */
+
+#include "article_reader.h"
+#include "lcd_metrics.h"
+#include <string.h>
+
+void article_reader_open(article_reader_t* reader, article_read_fn read, void* source, uint32_t size,
+                         int scale, int flags, int max_width) {
+    reader->read = read;
+    reader->source = source;
+    reader->size = size;
+    reader->scale = scale;
+    reader->flags = flags;
+    reader->width = max_width;
+    reader->num_lines = -1;
+    reader->starts = NULL;
+    reader->lengths = NULL;
+    
+    reader->checkpoints[0] = 0;
+    reader->num_checkpoints = 1;
+    reader->every = ARTICLE_READER_FIRST_EVERY;
+    
+    for (int i = 0; i < ARTICLE_READER_CACHE; i++) {
+        reader->cache[i].line = -1;
+    }
+    
+    reader->window_start = 0;
+    reader->window_len = 0;
+    reader->bytes_read = 0;
+}
+
+static bool article_reader_read(article_reader_t* reader, uint32_t offset, char* buf, int len) {
+    reader->bytes_read += len;
+    return reader->read(reader->source, offset, (uint8_t*)buf, len) == len;
+}
+
+// Move the window to start at `start`, reading only what it did not hold
+static bool article_reader_load(article_reader_t* reader, uint32_t start) {
+    uint32_t end = start + ARTICLE_READER_WINDOW;
+    if (end > reader->size) end = reader->size;
+    
+    uint32_t old_start = reader->window_start;
+    uint32_t old_end = old_start + reader->window_len;
+    reader->window_start = start;
+    reader->window_len = 0;
+    
+    bool ok;
+    if (start >= old_start && start < old_end) {
+        // Forward: the tail of the old window becomes the head
+        int keep = old_end - start;
+        memmove(reader->window, reader->window + (start - old_start), keep);
+        ok = article_reader_read(reader, old_end, reader->window + keep, end - old_end);
+    } else if (start < old_start && end > old_start) {
+        // Back: the head of the old window becomes the tail
+        int keep = (end < old_end ? end : old_end) - old_start;
+        memmove(reader->window + (old_start - start), reader->window, keep);
+        ok = article_reader_read(reader, start, reader->window, old_start - start);
+        if (ok && old_end < end) {
+            ok = article_reader_read(reader, old_end, reader->window + (old_end - start), end - old_end);
+        }
+    } else {
+        ok = article_reader_read(reader, start, reader->window, end - start);
+    }
+    
+    if (ok) reader->window_len = end - start;
+    return ok;
+}
+
+// Make the window hold body[offset..offset+len) (cut at the end of the
+// body) and return where offset is in it
+static const char* article_reader_fetch(article_reader_t* reader, uint32_t offset, int len) {
+    if (offset + len > reader->size) len = reader->size - offset;
+    
+    uint32_t start = reader->window_start;
+    if (offset < start || offset + len > start + reader->window_len) {
+        // Going back, keep a little of what comes before too
+        start = offset;
+        if (offset < reader->window_start) {
+            start = offset > ARTICLE_READER_WINDOW / 4 ? offset - ARTICLE_READER_WINDOW / 4 : 0;
+        }
+        if (!article_reader_load(reader, start)) return NULL;
+    }
+    return reader->window + (offset - start);
+}
+
+// Wrap the line starting at offset into *entry
+static bool article_reader_wrap(article_reader_t* reader, uint32_t offset, article_reader_line_t* entry) {
+    int avail = reader->size - offset;
+    if (avail > ARTICLE_READER_MAX_LINE) avail = ARTICLE_READER_MAX_LINE;
+    
+    const char* str = article_reader_fetch(reader, offset, avail);
+    if (!str) return false;
+    
+    int next;
+    entry->start = offset;
+    entry->len = lcd_metrics_wrap(str, avail, reader->scale, reader->flags, reader->width, &next);
+    entry->next = offset + next;
+    
+    // The spaces dropped at a wrap can run on past what was fetched
+    if (next == avail) {
+        while (entry->next < reader->size) {
+            const char* c = article_reader_fetch(reader, entry->next, 1);
+            if (!c) return false;
+            if (*c != ' ') break;
+            entry->next++;
+        }
+    }
+    return true;
+}
+
+static void article_reader_checkpoint(article_reader_t* reader, int line, uint32_t start) {
+    if (line != reader->num_checkpoints * reader->every) return;
+    
+    if (reader->num_checkpoints == ARTICLE_READER_CHECKPOINTS) {
+        for (int i = 0; i < ARTICLE_READER_CHECKPOINTS / 2; i++) {
+            reader->checkpoints[i] = reader->checkpoints[2 * i];
+        }
+        reader->num_checkpoints = ARTICLE_READER_CHECKPOINTS / 2;
+        reader->every *= 2;
+    }
+    reader->checkpoints[reader->num_checkpoints++] = start;
+}
+
+void article_reader_use_lines(article_reader_t* reader, const uint32_t* starts,
+                              const uint16_t* lengths, int num_lines) {
+    reader->starts = starts;
+    reader->lengths = lengths;
+    reader->num_lines = num_lines;
+}
+
+const char* article_reader_line(article_reader_t* reader, int line, int* len) {
+    if (line < 0 || (reader->num_lines >= 0 && line >= reader->num_lines)) return NULL;
+    
+    if (reader->starts) {
+        *len = reader->lengths[line];
+        if (*len > ARTICLE_READER_MAX_LINE) *len = ARTICLE_READER_MAX_LINE;
+        return article_reader_fetch(reader, reader->starts[line], *len);
+    }
+    
+    // Start from the closest line at or before this one whose start is
+    // known: a checkpoint, or a line wrapped lately
+    int k = line / reader->every;
+    if (k >= reader->num_checkpoints) k = reader->num_checkpoints - 1;
+    int at = k * reader->every;
+    uint32_t start = reader->checkpoints[k];
+    for (int i = 0; i < ARTICLE_READER_CACHE; i++) {
+        const article_reader_line_t* e = &reader->cache[i];
+        if (e->line > at && e->line <= line) {
+            at = e->line;
+            start = e->start;
+        }
+    }
+    
+    while (true) {
+        article_reader_line_t* e = &reader->cache[at % ARTICLE_READER_CACHE];
+        if (e->line != at) {
+            if (!article_reader_wrap(reader, start, e)) {
+                e->line = -1;
+                return NULL;
+            }
+            e->line = at;
+            article_reader_checkpoint(reader, at, start);
+        }
+    
+        if (e->next >= reader->size) reader->num_lines = at + 1;
+        if (at == line) {
+            const char* str = article_reader_fetch(reader, e->start, e->len);
+            *len = e->len;
+            return str;
+        }
+        if (e->next >= reader->size) return NULL;
+    
+        at++;
+        start = e->next;
+    }
+}
+
+int article_read_memory(void* source, uint32_t offset, uint8_t* buf, int len) {
+    memcpy(buf, (const char*)source + offset, len);
+    return len;
+}
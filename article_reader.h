@@ -0,0 +1,92 @@
+/*
+ * Streaming article reader
+ *
+ * Reads an article body that need not be in memory (a file on the SD
+ * card, or anything else with a read callback) a window at a time, and
+ * finds its wrapped lines as lcd_metrics_wrap would without wrapping the
+ * whole text first. Opening costs nothing, and memory stays the same
+ * whatever the article's length:
+ *
+ * - a window of ARTICLE_READER_WINDOW bytes around the line being looked
+ *   up, reloaded (keeping whatever part of it is still wanted) when a
+ *   line falls outside it;
+ * - a checkpoint, the byte offset of a line, every `every` lines of the
+ *   text scanned so far. When the table fills up every other checkpoint
+ *   is dropped and `every` doubles, so any line is at most `every` wraps
+ *   from one;
+ * - the lines most recently wrapped, so scrolling by a line wraps one.
+ *
+ * Lines break exactly as lcd_metrics_wrap breaks the whole text, as long
+ * as no line is longer than ARTICLE_READER_MAX_LINE bytes, which needs
+ * far more characters than fit across the screen. The number of lines
+ * is only known once the last one has been looked up.
+ *
+ * A body that comes with line tables (a packed one) is not wrapped at
+ * all: a line is looked up and only the text around it is read.
+ */
+
+#ifndef ARTICLE_READER_H
+#define ARTICLE_READER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ARTICLE_READER_WINDOW       4096
+#define ARTICLE_READER_MAX_LINE     1024
+#define ARTICLE_READER_CHECKPOINTS  256
+#define ARTICLE_READER_FIRST_EVERY  16      // lines between checkpoints at first
+#define ARTICLE_READER_CACHE        32      // recently wrapped lines
+
+// Copy len bytes of the body from offset into buf. Returns the number of
+// bytes copied, less than len only on a read error.
+typedef int (*article_read_fn)(void* source, uint32_t offset, uint8_t* buf, int len);
+
+typedef struct {
+    int line;               // -1 for an unused entry
+    uint32_t start;
+    uint32_t next;          // where line + 1 starts, or size after the last line
+    uint16_t len;
+} article_reader_line_t;
+
+typedef struct {
+    article_read_fn read;
+    void* source;
+    uint32_t size;
+    int scale;              // as lcd_metrics_wrap
+    int flags;
+    int width;
+    int num_lines;          // -1 until the last line has been found
+    const uint32_t* starts; // line tables, or NULL to wrap
+    const uint16_t* lengths;
+    
+    uint32_t checkpoints[ARTICLE_READER_CHECKPOINTS];
+    int num_checkpoints;
+    int every;
+    
+    article_reader_line_t cache[ARTICLE_READER_CACHE];
+    
+    uint32_t window_start;  // body offset of window[0]
+    int window_len;
+    uint32_t bytes_read;    // through read, for the curious
+    char window[ARTICLE_READER_WINDOW];
+} article_reader_t;
+
+// Start reading a body of size bytes, wrapped as lcd_metrics_wrap with
+// scale, flags and max_width. Nothing is read yet.
+void article_reader_open(article_reader_t* reader, article_read_fn read, void* source, uint32_t size,
+                         int scale, int flags, int max_width);
+
+// Take the lines of the body from tables made with the same scale, flags
+// and width instead of wrapping it
+void article_reader_use_lines(article_reader_t* reader, const uint32_t* starts,
+                              const uint16_t* lengths, int num_lines);
+
+// Line `line` of the body: its first byte, and in *len its length with
+// the '\n' or spaces it was broken at left out. The pointer is into the window and only good until the next call.
+// NULL past the last line, or if the body could not be read.
+const char* article_reader_line(article_reader_t* reader, int line, int* len);
+
+// Source for a body that is in memory after all: source is the text
+int article_read_memory(void* source, uint32_t offset, uint8_t* buf, int len);
+
+#endif // ARTICLE_READER_H
@@ -0,0 +1,43 @@
+/*
+ * Guide articles
+ *
+ * An article as the views use it. The built-in ones come out of the
+ * article pack in flash (article_pack.h) with their bodies ready for the
+ * teleprinter view: already in upper case, and wrapped once for its font
+ * and width, with the start and length of every line. The view draws
+ * those lines as they are, and wraps at run time only when it lays text
+ * out differently from how the tables were made.
+ *
+ * A body is never in memory as a whole: packed bodies are compressed, and
+ * those from elsewhere (the SD card) are files, so both are read through
+ * an article_reader.h source.
+ */
+
+#ifndef ARTICLES_H
+#define ARTICLES_H
+
+#include "article_reader.h"
+#include <stdint.h>
+
+// How line tables were wrapped (as lcd_metrics_wrap)
+typedef struct {
+    int scale;
+    int flags;
+    int width;
+} article_layout_t;
+
+typedef struct {
+    const char* title;
+    const char* category;
+    uint32_t size;                  // body length in bytes
+    const uint32_t* line_starts;    // byte offset of each body line, or NULL
+    const uint16_t* line_lengths;
+    uint16_t num_lines;
+    article_layout_t layout;        // of the line tables
+    
+    // The body, UTF-8 in any case, is streamed through read(source, ...)
+    article_read_fn read;
+    void* source;
+} Article;
+
+#endif // ARTICLES_H
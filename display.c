@@ -4,7 +4,9 @@
  */
 
 #include "display.h"
-#include "font.h"
+#include "lcd_font.h"
+#include "lcd_glyph.h"
+#include "lcd_metrics.h"
 #include <string.h>
 
 // Draw a single pixel
@@ -23,17 +25,128 @@ void lcd_draw_pixel(int x, int y, uint16_t color) {
     gpio_put(LCD_CS, 1);
 }
 
-// Draw text using bitmap font
+// One row of an opaque text run, RGB565
+static uint8_t text_line[LCD_WIDTH * 2];
+
+// Text here is drawn in the 8x8 terminal font of lcd_font.h, through the
+// same glyph tables and lookup as the main driver. This panel takes RGB565
+// over its own SPI port, so the pixels go out through the loops below.
+static const lcd_font_t* text_font(void) {
+    return lcd_font_get(LCD_FONT_8X8);
+}
+
+static int text_width(const char* text, int len) {
+    return lcd_metrics_font_width(text_font(), text, len, 0);
+}
+
+// Lit pixels of one line of glyphs: one fill per horizontal span
+static void draw_text_spans(int x, int y, const char* text, int len, uint16_t color) {
+    const lcd_font_t* font = text_font();
+    const char* end = text + len;
+    int pen = x;
+    
+    while (text < end) {
+        const lcd_font_glyph_t* g = lcd_font_glyph(font, lcd_glyph_decode(&text, end, 0));
+        const uint8_t* bits = lcd_font_bitmap(font, g);
+        int stride = lcd_font_stride(font, g);
+        
+        for (int row = 0; row < g->height; row++, bits += stride) {
+            int col = 0;
+            while (col < g->width) {
+                if (!lcd_font_alpha(font, bits, col)) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < g->width && lcd_font_alpha(font, bits, col)) col++;
+                lcd_fill_rect(pen + g->x_offset + start, y + g->y_offset + row, col - start, 1, color);
+            }
+        }
+        pen += g->advance;
+    }
+}
+
+// Row `row` of a line of glyphs on bg, into text_line for columns x0..x1-1
+static void expand_text_row(int x, int x0, int x1, int row, const char* text, int len,
+                            uint16_t fg, uint16_t bg) {
+    const lcd_font_t* font = text_font();
+    const char* end = text + len;
+    int pen = x;
+    
+    for (int i = 0; i < x1 - x0; i++) {
+        text_line[i * 2] = bg >> 8;
+        text_line[i * 2 + 1] = bg & 0xFF;
+    }
+    
+    while (text < end) {
+        const lcd_font_glyph_t* g = lcd_font_glyph(font, lcd_glyph_decode(&text, end, 0));
+        int r = row - g->y_offset;
+        if (r >= 0 && r < g->height) {
+            const uint8_t* bits = lcd_font_bitmap(font, g) + r * lcd_font_stride(font, g);
+            for (int col = 0; col < g->width; col++) {
+                int px = pen + g->x_offset + col;
+                if (px < x0 || px >= x1 || !lcd_font_alpha(font, bits, col)) continue;
+                text_line[(px - x0) * 2] = fg >> 8;
+                text_line[(px - x0) * 2 + 1] = fg & 0xFF;
+            }
+        }
+        pen += g->advance;
+    }
+}
+
+// One line of glyphs on a background box with a 1 pixel margin
+// (x - 1, y - 1, width + 2, height + 2), expanded row by row and sent in
+// a single window
+static void draw_text_run_bg(int x, int y, const char* text, int len, uint16_t fg, uint16_t bg) {
+    int bx = x - 1, by = y - 1;
+    int bw = text_width(text, len) + 2;
+    int bh = text_font()->height + 2;
+    int x0 = bx < 0 ? 0 : bx;
+    int y0 = by < 0 ? 0 : by;
+    int x1 = bx + bw > LCD_WIDTH ? LCD_WIDTH : bx + bw;
+    int y1 = by + bh > LCD_HEIGHT ? LCD_HEIGHT : by + bh;
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    lcd_set_window(x0, y0, x1 - 1, y1 - 1);
+    
+    gpio_put(LCD_CS, 0);
+    gpio_put(LCD_DC, 1);
+    
+    for (int py = y0; py < y1; py++) {
+        expand_text_row(x, x0, x1, py - y, text, len, fg, bg);
+        spi_write_blocking(LCD_SPI, text_line, (x1 - x0) * 2);
+    }
+    
+    gpio_put(LCD_CS, 1);
+}
+
+// Draw text in the 8x8 font ('\n' moves down 10 px, '\r' returns to x),
+// one run per line
 void lcd_draw_text(int x, int y, const char* text, uint16_t color) {
-    draw_string_8x8(x, y, text, color, lcd_draw_pixel);
+    int cursor_y = y;
+    
+    while (*text) {
+        int len = strcspn(text, "\r\n");
+        draw_text_spans(x, cursor_y, text, len, color);
+        
+        text += len;
+        if (*text == '\n') cursor_y += 10; // 8 pixels + 2 spacing
+        if (*text) text++;
+    }
 }
 
 // Draw text with background
 void lcd_draw_text_bg(int x, int y, const char* text, uint16_t fg, uint16_t bg) {
     int len = strlen(text);
     
+    // Single line: background and glyphs in one burst
+    if (strcspn(text, "\r\n") == (size_t)len) {
+        draw_text_run_bg(x, y, text, len, fg, bg);
+        return;
+    }
+    
     // Draw background rectangle
-    lcd_fill_rect(x - 1, y - 1, len * 8 + 2, 10, bg);
+    lcd_fill_rect(x - 1, y - 1, text_width(text, len) + 2, 10, bg);
     
     // Draw text on top
     lcd_draw_text(x, y, text, fg);
@@ -118,7 +231,7 @@ int lcd_draw_text_wrapped(int x, int y, int max_width, const char* text,
         if (c == ' ' || c == '\t') {
             if (word_len > 0) {
                 word[word_len] = '\0';
-                int word_width = word_len * 8;
+                int word_width = text_width(word, word_len);
                 
                 // Check if word fits on current line
                 if (cursor_x + word_width > x + max_width) {
@@ -135,10 +248,10 @@ int lcd_draw_text_wrapped(int x, int y, int max_width, const char* text,
                     lcd_draw_text(cursor_x, cursor_y, word, color);
                 }
                 
-                cursor_x += word_width + 8; // Add space width
+                cursor_x += word_width + text_width(" ", 1);
                 word_len = 0;
             } else {
-                cursor_x += 8; // Just a space
+                cursor_x += text_width(" ", 1); // Just a space
             }
         } else {
             word[word_len++] = c;
@@ -191,8 +304,7 @@ void lcd_draw_title_box(const char* title, uint16_t fg, uint16_t bg) {
     lcd_fill_rect(0, 0, LCD_WIDTH, 40, bg);
     lcd_draw_rect(5, 5, LCD_WIDTH - 10, 30, fg);
     
-    int title_len = strlen(title);
-    int title_x = (LCD_WIDTH - (title_len * 8)) / 2;
+    int title_x = (LCD_WIDTH - text_width(title, strlen(title))) / 2;
     lcd_draw_text(title_x, 13, title, fg);
 }
 
@@ -278,8 +390,8 @@ void lcd_matrix_effect(int duration_ms) {
         }
         
         for (int i = 0; i < cols; i++) {
-            char c = 33 + (rand() % 94); // Random printable char
-            lcd_draw_text(i * 8, drops[i], &c, COLOR_HGTTG);
+            char c[2] = { 33 + (rand() % 94), '\0' }; // Random printable char
+            lcd_draw_text(i * 8, drops[i], c, COLOR_HGTTG);
             
             drops[i] += 10;
             if (drops[i] > LCD_HEIGHT && rand() % 10 > 7) {
@@ -301,8 +413,7 @@ void lcd_draw_status_bar(const char* left, const char* right) {
     }
     
     if (right) {
-        int len = strlen(right);
-        lcd_draw_text(LCD_WIDTH - (len * 8) - 5, y + 2, right, COLOR_GRAY);
+        lcd_draw_text(LCD_WIDTH - text_width(right, strlen(right)) - 5, y + 2, right, COLOR_GRAY);
     }
 }
 
@@ -1,27 +1,15 @@
 #include "dont_panic_image.h"
+#include "lcd_cmd.h"
 #include "pico/stdlib.h"
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
 
-extern void spi_write_command(uint8_t cmd);
-extern void spi_write_data(uint8_t data);
+extern void lcd_set_window(int x0, int y0, int x1, int y1);
+extern const lcd_bus_t* lcd_bus;
 
 void draw_compressed_image(const uint32_t* compressed, uint32_t size) {
-    // Set full screen window
-    spi_write_command(0x2A);
-    spi_write_data(0); spi_write_data(0);
-    spi_write_data(0x01); spi_write_data(0x3F);
-    
-    spi_write_command(0x2B);
-    spi_write_data(0); spi_write_data(0);
-    spi_write_data(0x01); spi_write_data(0x3F);
-    
-    spi_write_command(0x2C);
+    // Set full screen window; leaves CS asserted in data mode
+    lcd_set_window(0, 0, 319, 319);
     
     // Decompress and send
-    gpio_put(14, 1);  // LCD_DC
-    gpio_put(13, 0);  // LCD_CS
-    
     for (uint32_t i = 0; i < size; i++) {
         uint32_t packed = compressed[i];
         uint8_t count = (packed >> 24) & 0xFF;
@@ -31,9 +19,9 @@ void draw_compressed_image(const uint32_t* compressed, uint32_t size) {
         
         uint8_t rgb[3] = {r, g, b};
         for (int j = 0; j < count; j++) {
-            spi_write_blocking(spi1, rgb, 3);
+            lcd_bus->write(rgb, 3);
         }
     }
     
-    gpio_put(13, 1);  // LCD_CS high
+    lcd_bus->select(false);
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
  */
 
 #include "enhanced_display.h"
+#include "lcd_glyph.h"
+#include "lcd_metrics.h"
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
@@ -23,69 +25,37 @@ extern void lcd_text(int x, int y, const char* str, uint32_t color);
 extern void lcd_hline(int x0, int x1, int y, uint32_t color);
 extern void lcd_vline(int x, int y0, int y1, uint32_t color);
 
-// External font reference
-extern const uint8_t font5x7[96][5];
-
-// 12x16 large font (enhanced version of original 5x7)
-static const uint16_t large_font_12x16[][16] = {
-    // Space (0x20)
-    {0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
-     0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000},
-    // ! (0x21)
-    {0x0000, 0x0180, 0x03C0, 0x03C0, 0x03C0, 0x03C0, 0x01C0, 0x0180,
-     0x0180, 0x0000, 0x0000, 0x0180, 0x03C0, 0x0180, 0x0000, 0x0000},
-    // Add more characters as needed...
-    // For now, let's define A-Z and 0-9
-    
-    // A (0x41)
-    {0x0000, 0x0180, 0x03C0, 0x07E0, 0x0660, 0x0C30, 0x0C30, 0x1818,
-     0x1FFE, 0x3FFF, 0x300C, 0x7006, 0x6006, 0x0000, 0x0000, 0x0000},
-};
-
+// Uppercase, one glyph run per line: the 12x16 font at scale 2, the
+// scaled 5x7 font otherwise (lcd_font_for_scale)
 void draw_large_text(int x, int y, const char* text, uint32_t color, int scale) {
-    int cx = x;
     int cy = y;
     
-    while (*text) {
-        char c = *text;
-        if (c >= 'a' && c <= 'z') c -= 32; // Convert to uppercase
+    while (true) {
+        const char* end = strchr(text, '\n');
+        int len = end ? end - text : (int)strlen(text);
         
-        if (c == '\n') {
-            cx = x;
-            cy += 16 * scale;
-        } else if (c >= 32 && c <= 126) {
-            // Use original 5x7 font but scaled up
-            for (int col = 0; col < 5; col++) {
-                uint8_t line = font5x7[c - 32][col];
-                for (int row = 0; row < 7; row++) {
-                    if (line & (1 << row)) {
-                        // Draw scaled pixel block
-                        for (int sx = 0; sx < scale; sx++) {
-                            for (int sy = 0; sy < scale; sy++) {
-                                lcd_pixel(cx + col * scale + sx, cy + row * scale + sy, color);
-                            }
-                        }
-                    }
-                }
-            }
-            cx += 6 * scale;
-        } else {
-            cx += 6 * scale; // Space for unrecognized chars
-        }
-        text++;
+        lcd_glyph_run(x, cy, text, len, scale, color, LCD_GLYPH_NO_BG, LCD_GLYPH_UPPER);
+        
+        if (!end) break;
+        text = end + 1;
+        cy += 16 * scale;
     }
 }
 
+// Outline and fill in one pass per line (see lcd_glyph_run_outlined)
 void draw_outlined_text(int x, int y, const char* text, uint32_t fg_color, uint32_t outline_color, int scale) {
-    // Draw outline by rendering text at surrounding positions
-    for (int ox = -1; ox <= 1; ox++) {
-        for (int oy = -1; oy <= 1; oy++) {
-            if (ox == 0 && oy == 0) continue;
-            draw_large_text(x + ox, y + oy, text, outline_color, scale);
-        }
+    int cy = y;
+    
+    while (true) {
+        const char* end = strchr(text, '\n');
+        int len = end ? end - text : (int)strlen(text);
+        
+        lcd_glyph_run_outlined(x, cy, text, len, scale, fg_color, outline_color, LCD_GLYPH_UPPER);
+        
+        if (!end) break;
+        text = end + 1;
+        cy += 16 * scale;
     }
-    // Draw main text on top
-    draw_large_text(x, y, text, fg_color, scale);
 }
 
 void draw_gradient_rect(int x, int y, int w, int h, uint32_t color1, uint32_t color2, bool horizontal) {
@@ -116,54 +86,34 @@ void draw_gradient_rect(int x, int y, int w, int h, uint32_t color1, uint32_t co
     }
 }
 
+// Widest dx with dx*dx + dy*dy inside the corner radius
+static int corner_extent(int radius, int dy) {
+    int dx = radius;
+    while (dx > 0 && dx * dx + dy * dy > radius * radius) dx--;
+    return dx;
+}
+
 void draw_rounded_rect(int x, int y, int w, int h, int radius, uint32_t color) {
     // Draw main rectangle
     lcd_fill_rect(x + radius, y, w - 2 * radius, h, color);
     lcd_fill_rect(x, y + radius, w, h - 2 * radius, color);
     
-    // Draw corners using circle segments
-    // Top-left
+    // Draw corners as one span per row on each side
     for (int cy = 0; cy < radius; cy++) {
-        for (int cx = 0; cx < radius; cx++) {
-            int dx = radius - cx;
-            int dy = radius - cy;
-            if (dx * dx + dy * dy <= radius * radius) {
-                lcd_pixel(x + cx, y + cy, color);
-            }
-        }
-    }
-    
-    // Top-right
-    for (int cy = 0; cy < radius; cy++) {
-        for (int cx = 0; cx < radius; cx++) {
-            int dx = cx;
-            int dy = radius - cy;
-            if (dx * dx + dy * dy <= radius * radius) {
-                lcd_pixel(x + w - radius + cx, y + cy, color);
-            }
-        }
-    }
-    
-    // Bottom-left
-    for (int cy = 0; cy < radius; cy++) {
-        for (int cx = 0; cx < radius; cx++) {
-            int dx = radius - cx;
-            int dy = cy;
-            if (dx * dx + dy * dy <= radius * radius) {
-                lcd_pixel(x + cx, y + h - radius + cy, color);
-            }
-        }
-    }
-    
-    // Bottom-right
-    for (int cy = 0; cy < radius; cy++) {
-        for (int cx = 0; cx < radius; cx++) {
-            int dx = cx;
-            int dy = cy;
-            if (dx * dx + dy * dy <= radius * radius) {
-                lcd_pixel(x + w - radius + cx, y + h - radius + cy, color);
-            }
-        }
+        // Distance of this row from the corner centres above and below
+        int top = corner_extent(radius, radius - cy);
+        int bottom = corner_extent(radius, cy);
+    
+        // Left corners cover dx = 1..radius, right corners dx = 0..radius-1
+        int top_left = top < radius ? top : radius;
+        int top_right = (top < radius - 1 ? top : radius - 1) + 1;
+        int bottom_left = bottom < radius ? bottom : radius;
+        int bottom_right = (bottom < radius - 1 ? bottom : radius - 1) + 1;
+    
+        lcd_fill_rect(x + radius - top_left, y + cy, top_left, 1, color);
+        lcd_fill_rect(x + w - radius, y + cy, top_right, 1, color);
+        lcd_fill_rect(x + radius - bottom_left, y + h - radius + cy, bottom_left, 1, color);
+        lcd_fill_rect(x + w - radius, y + h - radius + cy, bottom_right, 1, color);
     }
 }
 
@@ -174,8 +124,8 @@ void draw_article_header(const char* title, const char* category) {
     // Title with outline
     draw_outlined_text(10, 10, title, COLOR_HGTTG_BRIGHT, COLOR_BLACK, 2);
     
-    // Category badge
-    int cat_len = strlen(category) * 6 + 10;
+    // Category badge: the text plus a 5 px margin each side
+    int cat_len = lcd_metrics_width_cached(category, 1, 0) + 10;
     draw_rounded_rect(320 - cat_len - 10, 15, cat_len, 20, 10, COLOR_AMBER_MEDIUM);
     lcd_text(320 - cat_len - 5, 20, category, COLOR_BLACK);
 }
@@ -537,12 +487,23 @@ void draw_menu_item(int x, int y, const char* text, int number, bool selected) {
     lcd_text(x + 25, y + 8, text, fg_color);
 }
 
+#define SCROLL_BAR_HEIGHT 100
+
+static int scroll_thumb_height(int total_lines, int visible_lines) {
+    return (visible_lines * SCROLL_BAR_HEIGHT) / total_lines;
+}
+
+static int scroll_thumb_pos(int total_lines, int visible_lines, int scroll_pos) {
+    int thumb_height = scroll_thumb_height(total_lines, visible_lines);
+    return (scroll_pos * (SCROLL_BAR_HEIGHT - thumb_height)) / (total_lines - visible_lines);
+}
+
 void draw_scroll_indicator(int x, int y, int total_lines, int visible_lines, int scroll_pos) {
     if (total_lines <= visible_lines) return;
     
-    int bar_height = 100;
-    int thumb_height = (visible_lines * bar_height) / total_lines;
-    int thumb_pos = (scroll_pos * (bar_height - thumb_height)) / (total_lines - visible_lines);
+    int bar_height = SCROLL_BAR_HEIGHT;
+    int thumb_height = scroll_thumb_height(total_lines, visible_lines);
+    int thumb_pos = scroll_thumb_pos(total_lines, visible_lines, scroll_pos);
     
     // Track
     lcd_rect(x, y, 8, bar_height, COLOR_GRAY);
@@ -551,11 +512,21 @@ void draw_scroll_indicator(int x, int y, int total_lines, int visible_lines, int
     lcd_fill_rect(x + 1, y + thumb_pos, 6, thumb_height, COLOR_HGTTG_BRIGHT);
 }
 
+// Rows draw_scroll_indicator covers below y. Lists that let the selection
+// go past the last page push the thumb beyond the end of the track.
+int scroll_indicator_height(int total_lines, int visible_lines, int scroll_pos) {
+    if (total_lines <= visible_lines) return 0;
+    
+    int thumb_end = 1 + scroll_thumb_pos(total_lines, visible_lines, scroll_pos) +
+                    scroll_thumb_height(total_lines, visible_lines);
+    return thumb_end > SCROLL_BAR_HEIGHT + 1 ? thumb_end : SCROLL_BAR_HEIGHT + 1;
+}
+
 void draw_loading_animation(int x, int y, int frame) {
     const char* spinner = "|/-\\";
-    char spinner_char = spinner[frame % 4];
+    char spinner_char[2] = { spinner[frame % 4], '\0' };
     
-    draw_large_text(x, y, &spinner_char, COLOR_HGTTG_BRIGHT, 2);
+    draw_large_text(x, y, spinner_char, COLOR_HGTTG_BRIGHT, 2);
     
     // Surrounding dots
     for (int i = 0; i < 8; i++) {
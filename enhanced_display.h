@@ -42,6 +42,7 @@ void draw_pan_galactic_diagram(int x, int y);
 // UI enhancement functions
 void draw_menu_item(int x, int y, const char* text, int number, bool selected);
 void draw_scroll_indicator(int x, int y, int total_lines, int visible_lines, int scroll_pos);
+int scroll_indicator_height(int total_lines, int visible_lines, int scroll_pos);
 void draw_loading_animation(int x, int y, int frame);
 
 #endif
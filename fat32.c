@@ -0,0 +1,427 @@
+/*
+ * Read-only FAT32
+ */
+
+#include "fat32.h"
+#include <string.h>
+
+#define FAT32_EOC           0x0FFFFFF8  // this and above end a chain
+#define FAT32_MIN_CLUSTERS  65525       // fewer, and it is FAT16
+#define FAT32_ENTRY         32          // directory entry
+
+// Directory entry attributes
+#define FAT32_ATTR_VOLUME   0x08
+#define FAT32_ATTR_DIR      0x10
+#define FAT32_ATTR_LFN      0x0F        // all of the long name mask 0x3F
+#define FAT32_LFN_LAST      0x40
+#define FAT32_LFN_CHARS     13          // of the long name in an entry
+
+#define FAT32_DELETED       0xE5
+#define FAT32_KANJI_E5      0x05        // a first byte of 0xE5 that is not deletion
+
+// Where the 13 UCS-2 characters of a long name entry are
+static const uint8_t fat32_lfn_offsets[FAT32_LFN_CHARS] = {
+    1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30
+};
+
+static uint16_t fat32_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t fat32_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int fat32_upper(int c) {
+    return (c >= 'a' && c <= 'z') ? c - 'a' + 'A' : c;
+}
+
+// A FAT32 boot sector with a BPB this code can use
+static bool fat32_is_boot(const uint8_t* s) {
+    uint8_t per_cluster = s[13];
+    return (s[0] == 0xEB || s[0] == 0xE9) &&
+           s[510] == 0x55 && s[511] == 0xAA &&
+           fat32_u16(s + 11) == FAT32_SECTOR &&
+           per_cluster != 0 && (per_cluster & (per_cluster - 1)) == 0 &&
+           fat32_u16(s + 14) != 0 &&           // reserved sectors
+           s[16] != 0 &&                       // FATs
+           fat32_u16(s + 17) == 0 &&           // root entries (FAT12/16 only)
+           fat32_u16(s + 22) == 0 &&           // FAT size (FAT12/16 only)
+           fat32_u32(s + 36) != 0;             // FAT size
+}
+
+bool fat32_mount(fat32_t* vol, fat32_read_fn read, void* device) {
+    memset(vol, 0, sizeof(*vol));
+    vol->read = read;
+    vol->device = device;
+    vol->error = FAT32_IO_ERROR;
+    
+    uint8_t* s = vol->sector;
+    if (!read(device, 0, s, 1)) return false;
+    
+    // A card comes partitioned; take the first FAT32 partition
+    uint32_t start = 0;
+    if (!fat32_is_boot(s)) {
+        vol->error = FAT32_NOT_FAT32;
+        if (s[510] != 0x55 || s[511] != 0xAA) return false;
+        for (int i = 0; i < 4 && start == 0; i++) {
+            const uint8_t* p = s + 446 + i * 16;
+            if (p[4] == 0x0B || p[4] == 0x0C) start = fat32_u32(p + 8);
+        }
+        if (start == 0) return false;
+    
+        vol->error = FAT32_IO_ERROR;
+        if (!read(device, start, s, 1)) return false;
+        vol->error = FAT32_NOT_FAT32;
+        if (!fat32_is_boot(s)) return false;
+    }
+    vol->error = FAT32_NOT_FAT32;
+    
+    uint32_t reserved = fat32_u16(s + 14);
+    uint32_t num_fats = s[16];
+    uint32_t total = fat32_u16(s + 19) ? fat32_u16(s + 19) : fat32_u32(s + 32);
+    uint32_t fat_size = fat32_u32(s + 36);
+    uint16_t ext_flags = fat32_u16(s + 40);
+    
+    int shift = 0;
+    while ((1 << shift) < s[13]) shift++;
+    
+    uint32_t meta = reserved + num_fats * fat_size;
+    if (total <= meta) return false;
+    uint32_t clusters = (total - meta) >> shift;
+    if (clusters < FAT32_MIN_CLUSTERS) return false;
+    if (fat_size < (clusters + 2 + FAT32_SECTOR / 4 - 1) / (FAT32_SECTOR / 4)) return false;
+    
+    // With mirroring off, only the active FAT is kept up to date
+    uint32_t active = (ext_flags & 0x80) ? (ext_flags & 0x0F) : 0;
+    if (active >= num_fats) return false;
+    
+    vol->fat = start + reserved + active * fat_size;
+    vol->data = start + meta;
+    vol->num_clusters = clusters;
+    vol->cluster_shift = shift;
+    vol->root = fat32_u32(s + 44);
+    if (vol->root < 2 || vol->root > clusters + 1) return false;
+    
+    vol->error = FAT32_OK;
+    return true;
+}
+
+// The cluster after cluster in its chain in *next, or 0 if it is the last
+static bool fat32_next(fat32_t* vol, uint32_t cluster, uint32_t* next) {
+    uint32_t lba = vol->fat + cluster / (FAT32_SECTOR / 4);
+    if (lba != vol->fat_lba) {
+        vol->fat_lba = 0;
+        if (!vol->read(vol->device, lba, vol->fat_sector, 1)) {
+            vol->error = FAT32_IO_ERROR;
+            return false;
+        }
+        vol->fat_lba = lba;
+        vol->fat_reads++;
+    }
+    
+    uint32_t n = fat32_u32(vol->fat_sector + (cluster % (FAT32_SECTOR / 4)) * 4) & 0x0FFFFFFF;
+    if (n >= FAT32_EOC) {
+        n = 0;
+    } else if (n < 2 || n > vol->num_clusters + 1) {
+        // Free, bad (0x0FFFFFF7) or off the end of the volume
+        vol->error = FAT32_CORRUPT;
+        return false;
+    }
+    *next = n;
+    return true;
+}
+
+// Clusters of the file that are ever read
+static uint32_t fat32_limit(const fat32_file_t* file) {
+    int shift = file->vol->cluster_shift + 9;
+    return file->size ? ((file->size - 1) >> shift) + 1 : 0;
+}
+
+// Start run r at cluster, cluster index of the file, and take in the
+// consecutive clusters after it, leaving where the chain goes from there
+// in file->next
+static bool fat32_start_run(fat32_file_t* file, fat32_run_t* r, uint32_t index, uint32_t cluster) {
+    uint32_t limit = fat32_limit(file);
+    r->index = index;
+    r->cluster = cluster;
+    r->count = 1;
+    file->next = 0;
+    
+    while (index + r->count < limit) {
+        uint32_t n;
+        if (!fat32_next(file->vol, cluster + r->count - 1, &n)) return false;
+        if (n != cluster + r->count) {
+            file->next = n;
+            break;
+        }
+        r->count++;
+    }
+    return true;
+}
+
+// Keep run r, just found further along the chain than any before it, if
+// it is one of every `every`
+static void fat32_found_run(fat32_file_t* file, const fat32_run_t* r) {
+    file->found = r->index + r->count;
+    if (++file->skipped < file->every) return;
+    file->skipped = 0;
+    
+    if (file->num_runs == FAT32_RUNS) {
+        for (int i = 0; i < FAT32_RUNS / 2; i++) {
+            file->runs[i] = file->runs[i * 2];
+        }
+        file->num_runs = FAT32_RUNS / 2;
+        file->every *= 2;
+    }
+    file->runs[file->num_runs++] = *r;
+}
+
+// Cluster index of the file, and in *run how many clusters from it on
+// are consecutive. 0 past the end of the chain or on an error.
+static uint32_t fat32_cluster(fat32_file_t* file, uint32_t index, uint32_t* run) {
+    if (file->num_runs == 0 || index >= fat32_limit(file)) return 0;
+    
+    fat32_run_t* c = &file->cursor;
+    if (index < c->index || index - c->index >= c->count) {
+        int i = file->num_runs - 1;
+        while (file->runs[i].index > index) i--;
+        fat32_run_t* r = &file->runs[i];
+        if (index - r->index < r->count) {
+            *run = r->count - (index - r->index);
+            return r->cluster + (index - r->index);
+        }
+    
+        // Follow the chain on from the cursor, or from the run kept before
+        // index if that is nearer
+        if (c->index < r->index || c->index > index) {
+            uint32_t n;
+            if (!fat32_next(file->vol, r->cluster + r->count - 1, &n)) return 0;
+            *c = *r;
+            file->next = n;
+        }
+        while (index - c->index >= c->count) {
+            if (file->next == 0) return 0;
+            if (!fat32_start_run(file, c, c->index + c->count, file->next)) return 0;
+            if (c->index == file->found) fat32_found_run(file, c);
+        }
+    }
+    *run = c->count - (index - c->index);
+    return c->cluster + (index - c->index);
+}
+
+// Get ready to read size bytes of the chain from cluster
+static bool fat32_start(fat32_t* vol, fat32_file_t* file, uint32_t cluster, uint32_t size, bool directory) {
+    file->vol = vol;
+    file->size = size;
+    file->directory = directory;
+    file->num_runs = 0;
+    file->every = 1;
+    file->skipped = 0;
+    file->found = 0;
+    if (cluster == 0 && size == 0) return true;
+    
+    if (cluster < 2 || cluster > vol->num_clusters + 1) {
+        vol->error = FAT32_CORRUPT;
+        return false;
+    }
+    if (!fat32_start_run(file, &file->cursor, 0, cluster)) return false;
+    fat32_found_run(file, &file->cursor);
+    return true;
+}
+
+// Make sector lba the one in vol->sector
+static bool fat32_load(fat32_t* vol, uint32_t lba) {
+    if (lba == vol->sector_lba) return true;
+    vol->sector_lba = 0;
+    if (!vol->read(vol->device, lba, vol->sector, 1)) {
+        vol->error = FAT32_IO_ERROR;
+        return false;
+    }
+    vol->sector_lba = lba;
+    return true;
+}
+
+int fat32_read(void* source, uint32_t offset, uint8_t* buf, int len) {
+    fat32_file_t* file = (fat32_file_t*)source;
+    fat32_t* vol = file->vol;
+    vol->error = FAT32_OK;
+    if (offset >= file->size || len <= 0) return 0;
+    if ((uint32_t)len > file->size - offset) len = file->size - offset;
+    
+    int shift = vol->cluster_shift;
+    uint32_t cluster_mask = (FAT32_SECTOR << shift) - 1;
+    int done = 0;
+    while (done < len) {
+        uint32_t run;
+        uint32_t cluster = fat32_cluster(file, offset >> (shift + 9), &run);
+        if (cluster == 0) {
+            // A directory ends with its chain; a file should not
+            if (vol->error == FAT32_OK && !file->directory) vol->error = FAT32_CORRUPT;
+            break;
+        }
+    
+        uint32_t sector = (offset & cluster_mask) / FAT32_SECTOR;
+        uint32_t lba = vol->data + ((cluster - 2) << shift) + sector;
+        uint32_t within = offset % FAT32_SECTOR;
+        uint32_t want = len - done;
+        uint32_t n;
+        if (within == 0 && want >= FAT32_SECTOR) {
+            // Whole sectors go straight into buf, as many in one read as
+            // the run has
+            uint32_t count = want / FAT32_SECTOR;
+            if (run > count) run = count;
+            uint32_t left = (run << shift) - sector;
+            if (count > left) count = left;
+            if (!vol->read(vol->device, lba, buf + done, count)) {
+                vol->error = FAT32_IO_ERROR;
+                break;
+            }
+            n = count * FAT32_SECTOR;
+        } else {
+            if (!fat32_load(vol, lba)) break;
+            n = FAT32_SECTOR - within;
+            if (n > want) n = want;
+            memcpy(buf + done, vol->sector + within, n);
+        }
+        done += n;
+        offset += n;
+    }
+    return done;
+}
+
+// The 8.3 form of a name (padded with spaces, in capitals) in out; false
+// if it has none
+static bool fat32_short_name(const char* name, int len, uint8_t out[11]) {
+    memset(out, ' ', 11);
+    if ((len == 1 || len == 2) && memcmp(name, "..", len) == 0) {
+        memcpy(out, name, len);
+        return true;
+    }
+    
+    int dot = -1;
+    for (int i = 0; i < len; i++) {
+        if (name[i] != '.') continue;
+        if (dot >= 0) return false;
+        dot = i;
+    }
+    int base = dot < 0 ? len : dot;
+    int ext = dot < 0 ? 0 : len - dot - 1;
+    if (base == 0 || base > 8 || ext > 3) return false;
+    
+    for (int i = 0; i < base; i++) out[i] = fat32_upper((uint8_t)name[i]);
+    for (int i = 0; i < ext; i++) out[8 + i] = fat32_upper((uint8_t)name[dot + 1 + i]);
+    return true;
+}
+
+static uint8_t fat32_checksum(const uint8_t* short_name) {
+    uint8_t sum = 0;
+    for (int i = 0; i < 11; i++) {
+        sum = ((sum & 1) << 7) + (sum >> 1) + short_name[i];
+    }
+    return sum;
+}
+
+// Whether the part of a long name in long name entry e, which starts at
+// character at, matches name
+static bool fat32_lfn_matches(const uint8_t* e, int at, const char* name, int len) {
+    for (int i = 0; i < FAT32_LFN_CHARS; i++) {
+        uint16_t c = fat32_u16(e + fat32_lfn_offsets[i]);
+        int p = at + i;
+        if (p > len) break;
+        if (p == len) return c == 0;
+        if (c >= 0x80 || fat32_upper(c) != fat32_upper((uint8_t)name[p])) return false;
+    }
+    return true;
+}
+
+// Find name (len bytes) in the directory read through dir, and copy its
+// entry into entry
+static bool fat32_find(fat32_file_t* dir, const char* name, int len, uint8_t entry[FAT32_ENTRY]) {
+    uint8_t short_name[11];
+    bool has_short = fat32_short_name(name, len, short_name);
+    
+    // The long name entries before a short one, last part first: which
+    // one is expected next (-1 for none), and whether they match so far
+    int lfn = -1;
+    bool lfn_match = false;
+    uint8_t lfn_sum = 0;
+    
+    uint8_t* e = entry;
+    for (uint32_t pos = 0; ; pos += FAT32_ENTRY) {
+        if (fat32_read(dir, pos, e, FAT32_ENTRY) != FAT32_ENTRY) break;
+        if (e[0] == 0) break;       // the end of the directory
+        if (e[0] == FAT32_DELETED) {
+            lfn = -1;
+            continue;
+        }
+    
+        if ((e[11] & 0x3F) == FAT32_ATTR_LFN) {
+            int ord = e[0] & 0x1F;
+            if (e[0] & FAT32_LFN_LAST) {
+                lfn = ord;
+                lfn_sum = e[13];
+                lfn_match = len <= ord * FAT32_LFN_CHARS;
+            }
+            if (ord == 0 || ord != lfn || e[13] != lfn_sum) {
+                lfn = -1;
+                continue;
+            }
+            lfn_match = lfn_match && fat32_lfn_matches(e, (ord - 1) * FAT32_LFN_CHARS, name, len);
+            lfn--;
+            continue;
+        }
+    
+        bool long_match = lfn == 0 && lfn_match && fat32_checksum(e) == lfn_sum;
+        lfn = -1;
+        if (e[11] & FAT32_ATTR_VOLUME) continue;
+        if (long_match) return true;
+    
+        if (has_short) {
+            int i = 0;
+            for (; i < 11; i++) {
+                uint8_t c = (i == 0 && e[0] == FAT32_KANJI_E5) ? FAT32_DELETED : e[i];
+                if (fat32_upper(c) != short_name[i]) break;
+            }
+            if (i == 11) return true;
+        }
+    }
+    
+    if (dir->vol->error == FAT32_OK) dir->vol->error = FAT32_NOT_FOUND;
+    return false;
+}
+
+bool fat32_open(fat32_t* vol, fat32_file_t* file, const char* path) {
+    // Walk the path with file reading each directory on it
+    uint32_t cluster = vol->root;
+    uint32_t size = 0;
+    bool directory = true;
+    vol->error = FAT32_OK;
+    
+    while (true) {
+        while (*path == '/') path++;
+        if (*path == 0) break;
+        const char* end = path;
+        while (*end && *end != '/') end++;
+    
+        if (!directory) {
+            vol->error = FAT32_NOT_FOUND;
+            return false;
+        }
+        uint8_t entry[FAT32_ENTRY];
+        if (!fat32_start(vol, file, cluster, FAT32_DIR_MAX, true)) return false;
+        if (!fat32_find(file, path, end - path, entry)) return false;
+    
+        cluster = ((uint32_t)fat32_u16(entry + 20) << 16) | fat32_u16(entry + 26);
+        size = fat32_u32(entry + 28);
+        directory = (entry[11] & FAT32_ATTR_DIR) != 0;
+        if (directory && cluster == 0) cluster = vol->root;     // ".." of the root's child
+        path = end;
+    }
+    
+    if (directory) {
+        vol->error = FAT32_NOT_FOUND;
+        return false;
+    }
+    return fat32_start(vol, file, cluster, size, false);
+}
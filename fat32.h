@@ -0,0 +1,97 @@
+/*
+ * Read-only FAT32
+ *
+ * Just enough FAT32 to read the guide off a card: mount the volume (on
+ * the whole card, or in the first FAT32 partition of an MBR), open a file
+ * by path (guide/index.txt) and read any part of it.
+ *
+ * An open file keeps its cluster chain as runs of consecutive clusters,
+ * found the first time the file is read that far. A freshly copied file
+ * is one run, so after that reading anywhere in it, backwards or
+ * forwards, costs no FAT reads at all. A file in more pieces than the
+ * FAT32_RUNS kept keeps them as article_reader keeps its checkpoints:
+ * when the table fills up every other run is dropped and `every` doubles,
+ * so getting anywhere follows the chain across at most `every` runs.
+ * The run read last is kept as well, so reading on from it never does.
+ *
+ * Names are matched without regard to case, against the long name and
+ * the 8.3 one. Long names are compared in ASCII: a character outside it
+ * only matches itself, which a UTF-8 path never contains.
+ *
+ * Sectors come from a callback, sd_card_read on the card (a one-line
+ * wrapper), or a disk image on the host.
+ */
+
+#ifndef FAT32_H
+#define FAT32_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FAT32_SECTOR        512
+#define FAT32_RUNS          16          // cluster runs cached per open file
+#define FAT32_DIR_MAX       (65536 * 32) // the most a directory can hold
+
+// Read count sectors from sector lba on into buf
+typedef bool (*fat32_read_fn)(void* device, uint32_t lba, uint8_t* buf, uint32_t count);
+
+typedef enum {
+    FAT32_OK,
+    FAT32_IO_ERROR,     // a sector could not be read
+    FAT32_NOT_FAT32,    // no FAT32 volume there
+    FAT32_NOT_FOUND,    // no such file
+    FAT32_CORRUPT,      // a cluster chain leads somewhere impossible
+} fat32_error_t;
+
+typedef struct {
+    fat32_read_fn read;
+    void* device;
+    uint32_t fat;           // first sector of the FAT in use
+    uint32_t data;          // first sector of cluster 2
+    uint32_t num_clusters;
+    uint32_t root;          // first cluster of the root directory
+    int cluster_shift;      // log2 of sectors per cluster
+    fat32_error_t error;    // why the last call failed
+    
+    uint32_t fat_lba;       // FAT sector in fat_sector, or 0
+    uint32_t sector_lba;    // data sector in sector, or 0
+    uint32_t fat_reads;     // FAT sectors read, for the curious
+    uint8_t fat_sector[FAT32_SECTOR];
+    uint8_t sector[FAT32_SECTOR];
+} fat32_t;
+
+typedef struct {
+    uint32_t index;         // of its first cluster in the file
+    uint32_t cluster;
+    uint32_t count;
+} fat32_run_t;
+
+typedef struct {
+    fat32_t* vol;
+    uint32_t size;
+    bool directory;         // read until the chain ends
+    
+    fat32_run_t runs[FAT32_RUNS];
+    int num_runs;
+    int every;              // runs found for every one kept
+    int skipped;            // runs found since the last one kept
+    uint32_t found;         // clusters of the chain found so far
+    
+    fat32_run_t cursor;     // the run read last
+    uint32_t next;          // where the chain goes after it, 0 if nowhere
+} fat32_file_t;
+
+// Mount the FAT32 volume that device holds. False (and vol->error) if
+// there is none.
+bool fat32_mount(fat32_t* vol, fat32_read_fn read, void* device);
+
+// Open the file at path, '/'-separated from the root directory. False
+// (and vol->error) if there is no such file or it is a directory.
+bool fat32_open(fat32_t* vol, fat32_file_t* file, const char* path);
+
+// Copy len bytes of the file from offset into buf. Returns the number of
+// bytes copied, which is less than len past the end of the file or on an
+// error (file->vol->error). An article_read_fn with the file as source.
+int fat32_read(void* file, uint32_t offset, uint8_t* buf, int len);
+
+#endif // FAT32_H
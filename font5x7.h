@@ -0,0 +1,17 @@
+/*
+ * 5x7 font, printable ASCII
+ */
+
+#ifndef FONT5X7_H
+#define FONT5X7_H
+
+#include <stdint.h>
+
+#define FONT5X7_FIRST  0x20
+#define FONT5X7_COUNT  96
+#define FONT5X7_WIDTH  5
+#define FONT5X7_HEIGHT 7
+
+extern const uint8_t font5x7[FONT5X7_COUNT][FONT5X7_WIDTH];
+
+#endif // FONT5X7_H
@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""Compile a BDF bitmap font into C tables for lcd_font.h
+
+Usage: python3 font_compiler.py [--oversample N] [--bpp B] font.bdf output.c symbol
+
+Every glyph is cropped to its ink and stored as a row-major bitmap
+(leftmost pixel in the top bits, rows padded to whole bytes) with its own
+offset, size and advance. Bitmaps are laid out back to back in code-point
+order, so drawing a string mostly reads flash forward. Code points are
+mapped through a sorted table of runs of consecutive code points, which
+keeps sparse sets (ASCII plus a handful of symbols) small.
+
+With --oversample N the BDF is drawn at N times the size wanted: each NxN
+block of it becomes one pixel whose alpha is the block's ink coverage,
+stored with B bits per pixel (2 unless --bpp says otherwise; 1, 2 or 4).
+Without it the font is copied as is, 1bpp.
+
+TrueType sources have to be rendered to BDF first (e.g. with otf2bdf at
+the target pixel size, or N times it for --oversample).
+"""
+import sys
+
+def parse_bdf(path):
+    """Font properties and a {code point: glyph} dict"""
+    props = {}
+    glyphs = {}
+    lines = iter(open(path).read().splitlines())
+    for line in lines:
+        words = line.split()
+        if not words:
+            continue
+        if words[0] == "FONTBOUNDINGBOX":
+            props["bbox"] = [int(v) for v in words[1:5]]
+        elif words[0] in ("FONT_ASCENT", "FONT_DESCENT", "DEFAULT_CHAR"):
+            props[words[0]] = int(words[1])
+        elif words[0] == "STARTCHAR":
+            glyph = {"name": " ".join(words[1:])}
+            for line in lines:
+                words = line.split()
+                if words[0] == "ENCODING":
+                    glyph["encoding"] = int(words[1])
+                elif words[0] == "DWIDTH":
+                    glyph["advance"] = int(words[1])
+                elif words[0] == "BBX":
+                    glyph["bbx"] = [int(v) for v in words[1:5]]
+                elif words[0] == "BITMAP":
+                    width, height = glyph["bbx"][0], glyph["bbx"][1]
+                    rows = []
+                    for _ in range(height):
+                        hexrow = next(lines).strip()
+                        bits = int(hexrow, 16) if hexrow else 0
+                        rows.append([(bits >> (len(hexrow) * 4 - 1 - x)) & 1 for x in range(width)])
+                    glyph["rows"] = rows
+                elif words[0] == "ENDCHAR":
+                    break
+            # ENCODING -1 marks glyphs without a code point
+            if glyph.get("encoding", -1) >= 0:
+                glyphs[glyph["encoding"]] = glyph
+    return props, glyphs
+
+def crop(rows):
+    """Trim blank rows and columns: (rows, dx, dy)"""
+    ink = [(x, y) for y, row in enumerate(rows) for x, v in enumerate(row) if v]
+    if not ink:
+        return [], 0, 0
+    x0 = min(x for x, _ in ink)
+    x1 = max(x for x, _ in ink)
+    y0 = min(y for _, y in ink)
+    y1 = max(y for _, y in ink)
+    return [row[x0:x1 + 1] for row in rows[y0:y1 + 1]], x0, y0
+
+def downsample(rows, left, top, n, levels):
+    """Box-filter a glyph drawn at n times the size, with its top left
+    `left` columns right of the pen and `top` rows below the top of the
+    cell: (alpha rows, left, top) in output pixels, alpha 0..levels"""
+    x0, y0 = left // n, top // n
+    width = -(-(left + (len(rows[0]) if rows else 0)) // n) - x0
+    height = -(-(top + len(rows)) // n) - y0
+    out = [[0] * width for _ in range(height)]
+    for y, row in enumerate(rows):
+        for x, v in enumerate(row):
+            if v:
+                out[(top + y) // n - y0][(left + x) // n - x0] += 1
+    area = n * n
+    out = [[(v * levels + area // 2) // area for v in row] for row in out]
+    return out, x0, y0
+
+def pack_row(row, bpp):
+    out = [0] * ((len(row) * bpp + 7) // 8)
+    for x, v in enumerate(row):
+        bit = x * bpp
+        out[bit // 8] |= v << (8 - bpp - bit % 8)
+    return out
+
+def glyph_label(cp):
+    c = chr(cp)
+    return f"U+{cp:04X} {c!r}" if c.isprintable() else f"U+{cp:04X}"
+
+def main():
+    args = sys.argv[1:]
+    oversample, bpp = 1, None
+    while len(args) > 3 and args[0] in ("--oversample", "--bpp"):
+        if args[0] == "--oversample":
+            oversample = int(args[1])
+        else:
+            bpp = int(args[1])
+        args = args[2:]
+    if len(args) != 3 or oversample < 1 or bpp not in (None, 1, 2, 4):
+        print("Usage: python3 font_compiler.py [--oversample N] [--bpp B] font.bdf output.c symbol")
+        sys.exit(1)
+    src, dst, symbol = args
+    if bpp is None:
+        bpp = 1 if oversample == 1 else 2
+    levels = (1 << bpp) - 1
+
+    props, glyphs = parse_bdf(src)
+    if "FONT_ASCENT" in props and "FONT_DESCENT" in props:
+        ascent, descent = props["FONT_ASCENT"], props["FONT_DESCENT"]
+    else:
+        bw, bh, bx, by = props["bbox"]
+        ascent, descent = bh + by, -by
+    if ascent % oversample or descent % oversample:
+        sys.exit(f"{src}: ascent {ascent} and descent {descent} are not multiples of {oversample}")
+    ascent //= oversample
+    descent //= oversample
+    height = ascent + descent
+
+    codes = sorted(glyphs)
+    if not codes:
+        sys.exit(f"{src}: no encoded glyphs")
+
+    bitmaps = []
+    entries = []
+    offset = 0
+    for cp in codes:
+        g = glyphs[cp]
+        width, rows_h, xoff, yoff = g["bbx"]
+        top = ascent * oversample - (yoff + rows_h)   # first row below the top of the cell
+        rows, dx, dy = crop(g["rows"])
+        xoff += dx
+        top += dy
+        if rows:
+            rows, xoff, top = downsample(rows, xoff, top, oversample, levels)
+            rows, dx, dy = crop(rows)
+            xoff += dx
+            top += dy
+
+        # Keep the ink inside the cell so callers can rely on `height`
+        if rows and (top < 0 or top + len(rows) > height):
+            print(f"{src}: {glyph_label(cp)} clipped to the {height} row cell", file=sys.stderr)
+            first = max(0, -top)
+            last = min(len(rows), height - top)
+            rows = rows[first:last] if first < last else []
+            top += first
+            rows, cdx, cdy = crop(rows)
+            xoff += cdx
+            top += cdy
+
+        data = [b for row in rows for b in pack_row(row, bpp)]
+        bitmaps.append((cp, data))
+        w = len(rows[0]) if rows else 0
+        h = len(rows)
+        advance = (g.get("advance", width) + oversample // 2) // oversample
+        entries.append((cp, offset, w, h, xoff if rows else 0, top if rows else 0, advance))
+        offset += len(data)
+
+    # Runs of consecutive code points
+    ranges = []
+    for i, cp in enumerate(codes):
+        if ranges and ranges[-1][0] + ranges[-1][1] == cp:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([cp, 1, i])
+
+    missing_cp = props.get("DEFAULT_CHAR", 0x20)
+    missing = codes.index(missing_cp) if missing_cp in glyphs else 0
+
+    out = []
+    out.append(f"/* Generated by font_compiler.py from {src.split('/')[-1]} - do not edit */")
+    out.append("")
+    out.append('#include "lcd_font.h"')
+    out.append("")
+    out.append(f"static const uint8_t {symbol}_bitmaps[] = {{")
+    for cp, data in bitmaps:
+        if data:
+            out.append(f"    // {glyph_label(cp)}")
+            for i in range(0, len(data), 12):
+                out.append("    " + " ".join(f"0x{b:02X}," for b in data[i:i + 12]))
+    out.append("};")
+    out.append("")
+    out.append(f"static const lcd_font_glyph_t {symbol}_glyphs[] = {{")
+    for cp, offset, w, h, x, y, adv in entries:
+        out.append(f"    {{ {offset:5d}, {w:2d}, {h:2d}, {x:2d}, {y:2d}, {adv:2d} }},   // {glyph_label(cp)}")
+    out.append("};")
+    out.append("")
+    out.append(f"static const lcd_font_range_t {symbol}_ranges[] = {{")
+    for first, count, index in ranges:
+        out.append(f"    {{ 0x{first:04X}, {count}, {index} }},")
+    out.append("};")
+    out.append("")
+    out.append(f"const lcd_font_t {symbol} = {{")
+    # BDF has no kerning, so compiled fonts carry none
+    out.append(f"    {height}, {ascent}, {bpp}, {missing}, {len(ranges)}, 0,")
+    out.append(f"    {symbol}_ranges, {symbol}_glyphs, {symbol}_bitmaps, NULL")
+    out.append("};")
+
+    with open(dst, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+if __name__ == "__main__":
+    main()
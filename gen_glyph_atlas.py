@@ -0,0 +1,213 @@
+#!/usr/bin/env python3
+"""Generate the pre-scaled glyph atlas (lcd_glyph_atlas.c) from font5x7.c
+
+Usage: python3 gen_glyph_atlas.py [--sets a,b,...] font5x7.c font5x7_ext.txt lcd_glyph_atlas.c
+
+The atlas is proportional: every glyph is cropped to its inked columns
+and advances one blank column past them (SPACE_ADVANCE for blank glyphs).
+
+Besides the ASCII glyphs of font5x7.c it carries the sets of
+font5x7_ext.txt named by --sets (all of them by default; "" for none).
+Glyphs of a set marked fixed keep their drawn width as the advance.
+"""
+import re
+import sys
+
+SCALES = (1, 2, 3, 4)
+WIDTH = 5
+HEIGHT = 7
+SPACE_ADVANCE = 3
+COUNT = 96
+FIRST = 0x20
+
+def read_font(path):
+    """Column bytes of every ASCII glyph, in font order"""
+    src = open(path).read()
+    table = src[src.index('font5x7['):]
+    table = table[table.index('{') + 1:table.index('};')]
+    glyphs = []
+    for m in re.finditer(r'\{([^{}]*)\}', table):
+        cols = [int(v, 16) for v in re.findall(r'0x[0-9A-Fa-f]+', m.group(1))]
+        if len(cols) != WIDTH:
+            sys.exit(f"{path}: glyph {len(glyphs)} has {len(cols)} columns")
+        glyphs.append(cols)
+    if len(glyphs) != COUNT:
+        sys.exit(f"{path}: expected {COUNT} glyphs, found {len(glyphs)}")
+    return glyphs
+
+def read_sets(path):
+    """{set name: (fixed, {code point: column bytes})} from the art file"""
+    sets = {}
+    glyph = None
+    for n, line in enumerate(open(path, encoding="utf-8").read().splitlines(), 1):
+        line = line.strip()
+        if glyph is not None and len(glyph) < HEIGHT:
+            if not line or not set(line) <= set("#.") or len(line) > 8 or (glyph and len(line) != len(glyph[0])):
+                sys.exit(f"{path}:{n}: bad row")
+            glyph.append(line)
+        elif not line or line.startswith("#"):
+            continue
+        elif line.startswith("["):
+            words = line.split()
+            fixed = words[1:] == ["fixed"]
+            if not words[0].endswith("]") or (words[1:] and not fixed):
+                sys.exit(f"{path}:{n}: bad set header")
+            glyphs = {}
+            sets[words[0][1:-1]] = (fixed, glyphs)
+        elif line.startswith("U+"):
+            cp = int(line.split()[0][2:], 16)
+            glyph = []
+            glyphs[cp] = glyph
+        else:
+            sys.exit(f"{path}:{n}: unexpected line")
+    for fixed, glyphs in sets.values():
+        for cp, rows in glyphs.items():
+            if len(rows) != HEIGHT:
+                sys.exit(f"{path}: U+{cp:04X} has {len(rows)} rows")
+            glyphs[cp] = [sum(1 << y for y in range(HEIGHT) if rows[y][x] == "#")
+                          for x in range(len(rows[0]))]
+    return sets
+
+# Pairs that may close up by one column, kept only if the glyphs' facing
+# columns do not touch (not even diagonally) once they do
+KERN_CANDIDATES = [
+    "AT", "AV", "AW", "AY", "FA", "LT", "LV", "LW", "LY", "PA",
+    "TA", "VA", "WA", "YA", "T.", "T,", "V.", "V,", "Y.", "Y,",
+    "F.", "F,", "P.", "P,", "Ta", "Te", "To", "Ty", "Ya", "Ye", "Yo",
+]
+
+def ink(cols):
+    """First and last inked column, or None for a blank glyph"""
+    used = [x for x, c in enumerate(cols) if c]
+    return (used[0], used[-1]) if used else None
+
+def kerning(glyphs):
+    pairs = []
+    for pair in KERN_CANDIDATES:
+        left = glyphs[ord(pair[0])]
+        right = glyphs[ord(pair[1])]
+        a = left[ink(left)[1]]
+        b = right[ink(right)[0]]
+        if not (a | (a << 1) | (a >> 1)) & b:
+            pairs.append((ord(pair[0]), ord(pair[1]), -1))
+    return sorted(pairs)
+
+def scale_glyph(cols, scale):
+    """Row-major 1bpp bitmap of one glyph, MSB = leftmost pixel"""
+    width = len(cols) * scale
+    stride = (width + 7) // 8
+    rows = []
+    for y in range(HEIGHT * scale):
+        row = [0] * stride
+        for x in range(width):
+            if cols[x // scale] & (1 << (y // scale)):
+                row[x // 8] |= 0x80 >> (x % 8)
+        rows.append(row)
+    return rows
+
+def load_glyphs(font_path, ext_path, wanted=None):
+    """{code point: (column bytes, fixed width)} of the ASCII glyphs plus the
+    named sets (all of them if wanted is None)"""
+    glyphs = {FIRST + i: (cols, False) for i, cols in enumerate(read_font(font_path))}
+    sets = read_sets(ext_path)
+    for name in sets if wanted is None else wanted:
+        if name not in sets:
+            sys.exit(f"{ext_path}: no glyph set [{name}]")
+        fixed, extra = sets[name]
+        for cp, cols in extra.items():
+            if cp in glyphs:
+                sys.exit(f"{ext_path}: U+{cp:04X} is defined twice")
+            glyphs[cp] = (cols, fixed)
+    return glyphs
+
+def advance(cols, fixed):
+    """Pen movement of a glyph at 1x"""
+    used = ink(cols)
+    if used is None:
+        return SPACE_ADVANCE
+    return len(cols) if fixed else used[1] - used[0] + 2
+
+def glyph_name(cp):
+    c = chr(cp)
+    return f"U+{cp:04X} {c!r}" if c.isprintable() else f"U+{cp:04X}"
+
+def main():
+    args = sys.argv[1:]
+    wanted = None
+    if len(args) == 5 and args[0] == "--sets":
+        wanted = [name for name in args[1].split(",") if name]
+        args = args[2:]
+    if len(args) != 3:
+        print("Usage: python3 gen_glyph_atlas.py [--sets a,b,...] font5x7.c font5x7_ext.txt lcd_glyph_atlas.c")
+        sys.exit(1)
+
+    glyphs = load_glyphs(args[0], args[1], wanted)
+    codes = sorted(glyphs)
+    kerns = kerning({cp: cols for cp, (cols, _) in glyphs.items()})
+
+    # Runs of consecutive code points
+    ranges = []
+    for i, cp in enumerate(codes):
+        if ranges and ranges[-1][0] + ranges[-1][1] == cp:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([cp, 1, i])
+
+    out = []
+    out.append("/* Generated by gen_glyph_atlas.py from font5x7.c and font5x7_ext.txt - do not edit */")
+    out.append("")
+    out.append('#include "lcd_glyph_atlas.h"')
+
+    entries = []
+    for scale in SCALES:
+        height = HEIGHT * scale
+        name = f"lcd_glyph_atlas_{scale}x"
+        out.append("")
+        out.append(f"// {height} rows tall")
+        out.append(f"static const uint8_t {name}_bitmaps[] = {{")
+        metrics = []
+        offset = 0
+        for cp in codes:
+            cols, fixed = glyphs[cp]
+            used = ink(cols)
+            if used is None:
+                metrics.append((0, 0, 0, 0, advance(cols, fixed) * scale))
+                continue
+            cropped = cols[used[0]:used[1] + 1]
+            left = used[0] if fixed else 0
+            rows = scale_glyph(cropped, scale)
+            out.append(f"    // {glyph_name(cp)}")
+            for row in rows:
+                out.append("    " + " ".join(f"0x{b:02X}," for b in row))
+            width = len(cropped) * scale
+            metrics.append((offset, width, height, left * scale, advance(cols, fixed) * scale))
+            offset += len(rows) * len(rows[0])
+        out.append("};")
+        out.append("")
+        out.append(f"static const lcd_font_glyph_t {name}_glyphs[{len(codes)}] = {{")
+        for cp, (offset, width, h, left, adv) in zip(codes, metrics):
+            out.append(f"    {{ {offset:5d}, {width:2d}, {h:2d}, {left:2d}, 0, {adv:2d} }},   // {glyph_name(cp)}")
+        out.append("};")
+        out.append("")
+        out.append(f"static const lcd_font_range_t {name}_ranges[] = {{")
+        for first, count, index in ranges:
+            out.append(f"    {{ 0x{first:04X}, {count}, {index} }},")
+        out.append("};")
+        out.append("")
+        out.append(f"static const lcd_font_kern_t {name}_kerns[] = {{")
+        for left, right, adjust in kerns:
+            out.append(f"    {{ '{chr(left)}', '{chr(right)}', {adjust * scale} }},")
+        out.append("};")
+        entries.append(f"    {{ {height}, {height}, 1, 0, {len(ranges)}, {len(kerns)}, {name}_ranges, {name}_glyphs, "
+                       f"{name}_bitmaps, {name}_kerns }},")
+
+    out.append("")
+    out.append("const lcd_font_t lcd_glyph_atlas[LCD_GLYPH_ATLAS_SCALES] = {")
+    out.extend(entries)
+    out.append("};")
+
+    with open(args[2], "w", encoding="utf-8") as f:
+        f.write("\n".join(out) + "\n")
+
+if __name__ == "__main__":
+    main()
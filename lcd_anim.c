@@ -0,0 +1,86 @@
+/*
+ * Frame scheduler for animations
+ */
+
+#include "lcd_anim.h"
+#include "pico/stdlib.h"
+
+static repeating_timer_t lcd_anim_timer;
+static volatile uint32_t lcd_anim_ticks = 0;
+static lcd_anim_t* lcd_anim_list = NULL;
+
+static bool lcd_anim_tick(repeating_timer_t* rt) {
+    (void)rt;
+    lcd_anim_ticks++;
+    __sev();
+    return true;
+}
+
+void lcd_anim_init(void) {
+    add_repeating_timer_ms(LCD_ANIM_TICK_MS, lcd_anim_tick, NULL, &lcd_anim_timer);
+}
+
+void lcd_anim_start(lcd_anim_t* anim, lcd_anim_fn step, void* user_data, int period_ms) {
+    lcd_anim_stop(anim);
+    
+    int period = period_ms / LCD_ANIM_TICK_MS;
+    anim->step = step;
+    anim->user_data = user_data;
+    anim->period = period > 0 ? period : 1;
+    anim->due = lcd_anim_ticks + anim->period;
+    anim->next = lcd_anim_list;
+    lcd_anim_list = anim;
+}
+
+void lcd_anim_stop(lcd_anim_t* anim) {
+    for (lcd_anim_t** p = &lcd_anim_list; *p; p = &(*p)->next) {
+        if (*p == anim) {
+            *p = anim->next;
+            return;
+        }
+    }
+}
+
+bool lcd_anim_running(const lcd_anim_t* anim) {
+    for (const lcd_anim_t* a = lcd_anim_list; a; a = a->next) {
+        if (a == anim) return true;
+    }
+    return false;
+}
+
+static bool lcd_anim_is_due(const lcd_anim_t* anim, uint32_t now) {
+    return (int32_t)(now - anim->due) >= 0;
+}
+
+void lcd_anim_poll(void) {
+    uint32_t now = lcd_anim_ticks;
+    
+    // A step moves its animation's due tick past now, so starting over
+    // from the head after every step (which may have changed the list)
+    // still runs each animation once
+    lcd_anim_t* a = lcd_anim_list;
+    while (a) {
+        if (!lcd_anim_is_due(a, now)) {
+            a = a->next;
+            continue;
+        }
+    
+        int frames = 1 + (now - a->due) / a->period;
+        a->due += frames * a->period;
+        if (!a->step(a, frames)) lcd_anim_stop(a);
+        a = lcd_anim_list;
+    }
+}
+
+void lcd_anim_wait(int max_ms) {
+    uint32_t start = lcd_anim_ticks;
+    uint32_t limit = max_ms / LCD_ANIM_TICK_MS;
+    
+    while (lcd_anim_ticks - start < limit) {
+        uint32_t now = lcd_anim_ticks;
+        for (const lcd_anim_t* a = lcd_anim_list; a; a = a->next) {
+            if (lcd_anim_is_due(a, now)) return;
+        }
+        __wfe();
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * Frame scheduler for animations
+ *
+ * A repeating timer counts ticks of LCD_ANIM_TICK_MS and does nothing
+ * else: the panel's bus is not safe to use from its interrupt. The main
+ * loop calls lcd_anim_poll between reading keys, and that runs the step
+ * of every animation that has come due, so an animation only ever holds
+ * input up for one of its frames. A step that runs late is told how many
+ * frames have passed, which keeps an animation's pace tied to the clock
+ * rather than to how busy the loop was.
+ *
+ * Animations are owned by the caller, like the SDK's repeating timers,
+ * and any number can run at once.
+ */
+
+#ifndef LCD_ANIM_H
+#define LCD_ANIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LCD_ANIM_TICK_MS 10
+
+typedef struct lcd_anim lcd_anim_t;
+
+// One step of an animation, frames >= 1 periods after the last one.
+// Returns false when the animation is over.
+typedef bool (*lcd_anim_fn)(lcd_anim_t* anim, int frames);
+
+struct lcd_anim {
+    lcd_anim_fn step;
+    void* user_data;
+    uint32_t period;        // in ticks
+    uint32_t due;           // tick of the next step
+    lcd_anim_t* next;       // running animations
+};
+
+// Start the tick timer
+void lcd_anim_init(void);
+
+// Run step every period_ms (rounded to ticks), the first time period_ms
+// from now. Restarts anim if it is already running.
+void lcd_anim_start(lcd_anim_t* anim, lcd_anim_fn step, void* user_data, int period_ms);
+
+// Stop anim; nothing happens if it is not running
+void lcd_anim_stop(lcd_anim_t* anim);
+
+bool lcd_anim_running(const lcd_anim_t* anim);
+
+// Run the steps that are due. Steps may start and stop animations.
+void lcd_anim_poll(void);
+
+// Sleep until an animation is due or max_ms have passed
+void lcd_anim_wait(int max_ms);
+
+#endif // LCD_ANIM_H
@@ -0,0 +1,181 @@
+/*
+ * Band renderer for the ILI9488
+ *
+ * With LCD_USE_FRAMEBUFFER the scene runs once into the indexed
+ * framebuffer (clipped to the region) and the bands are only used to
+ * expand the region to RGB888 on its way out.
+ */
+
+#include "lcd_band.h"
+#include "lcd_dma.h"
+#include <stddef.h>
+
+#ifdef LCD_USE_FRAMEBUFFER
+#include "lcd_fb.h"
+#endif
+
+extern void lcd_set_window(int x0, int y0, int x1, int y1);
+extern void lcd_continue_window(void);
+
+// Two bands: one being flushed by DMA, one being filled
+static uint8_t lcd_band_bufs[2][LCD_BAND_PIXELS * 3];
+
+// The buffer after the one last handed to DMA. Kept across renders so a
+// new render never writes into the buffer that may still be in flight.
+static int lcd_band_next = 0;
+
+// Clip rectangle while a scene is drawing, in screen coordinates: the
+// current band, or the whole region when drawing into the framebuffer
+static bool lcd_band_drawing = false;
+static int lcd_band_x, lcd_band_y, lcd_band_w, lcd_band_h;
+
+bool lcd_band_active(void) {
+    return lcd_band_drawing;
+}
+
+bool lcd_band_rows_hidden(int y, int h) {
+    if (!lcd_band_drawing) return false;
+    return y + h <= lcd_band_y || y >= lcd_band_y + lcd_band_h;
+}
+
+bool lcd_band_rect_hidden(int x, int y, int w, int h) {
+    if (!lcd_band_drawing) return false;
+    return x + w <= lcd_band_x || x >= lcd_band_x + lcd_band_w ||
+           y + h <= lcd_band_y || y >= lcd_band_y + lcd_band_h;
+}
+
+void lcd_band_pixel(int x, int y, uint32_t color) {
+    if (x < lcd_band_x || x >= lcd_band_x + lcd_band_w) return;
+    if (y < lcd_band_y || y >= lcd_band_y + lcd_band_h) return;
+    
+#ifdef LCD_USE_FRAMEBUFFER
+    lcd_fb_pixel(x, y, color);
+#else
+    uint8_t* p = &lcd_band_bufs[lcd_band_next][((y - lcd_band_y) * lcd_band_w + x - lcd_band_x) * 3];
+    p[0] = (color >> 16) & 0xFF;
+    p[1] = (color >> 8) & 0xFF;
+    p[2] = color & 0xFF;
+#endif
+}
+
+void lcd_band_fill(int x, int y, int w, int h, uint32_t color) {
+    if (x < lcd_band_x) { w -= lcd_band_x - x; x = lcd_band_x; }
+    if (y < lcd_band_y) { h -= lcd_band_y - y; y = lcd_band_y; }
+    if (x + w > lcd_band_x + lcd_band_w) w = lcd_band_x + lcd_band_w - x;
+    if (y + h > lcd_band_y + lcd_band_h) h = lcd_band_y + lcd_band_h - y;
+    if (w <= 0 || h <= 0) return;
+    
+#ifdef LCD_USE_FRAMEBUFFER
+    lcd_fb_fill(x, y, w, h, color);
+#else
+    uint8_t r = (color >> 16) & 0xFF;
+    uint8_t g = (color >> 8) & 0xFF;
+    uint8_t b = color & 0xFF;
+    
+    for (int row = y - lcd_band_y; row < y - lcd_band_y + h; row++) {
+        uint8_t* p = &lcd_band_bufs[lcd_band_next][(row * lcd_band_w + x - lcd_band_x) * 3];
+        for (int i = 0; i < w; i++) {
+            *p++ = r;
+            *p++ = g;
+            *p++ = b;
+        }
+    }
+#endif
+}
+
+uint32_t lcd_band_get(int x, int y) {
+    if (x < lcd_band_x || x >= lcd_band_x + lcd_band_w) return 0;
+    if (y < lcd_band_y || y >= lcd_band_y + lcd_band_h) return 0;
+    
+#ifdef LCD_USE_FRAMEBUFFER
+    return lcd_fb_get(x, y);
+#else
+    const uint8_t* p = &lcd_band_bufs[lcd_band_next][((y - lcd_band_y) * lcd_band_w + x - lcd_band_x) * 3];
+    return ((uint32_t)p[0] << 16) | ((uint32_t)p[1] << 8) | p[2];
+#endif
+}
+
+// Hand the filled buffer, band by..by + bh of region x, y, w, h, to DMA.
+// The first band opens a window over the whole region and the rest carry
+// on in it (RAMWRC), which waits for the previous band to finish.
+static void lcd_band_flush(int x, int y, int w, int h, int by, int bh) {
+    if (by == y) {
+        lcd_set_window(x, y, x + w - 1, y + h - 1);
+    } else {
+        lcd_continue_window();
+    }
+    lcd_dma_write_start(lcd_band_bufs[lcd_band_next], (size_t)w * bh * 3);
+    lcd_band_next ^= 1;
+}
+
+// Clip a region to the screen; false if nothing is left
+static bool lcd_band_clip(int* x, int* y, int* w, int* h) {
+    if (*x < 0) { *w += *x; *x = 0; }
+    if (*y < 0) { *h += *y; *y = 0; }
+    if (*x + *w > 320) *w = 320 - *x;
+    if (*y + *h > 320) *h = 320 - *y;
+    return *w > 0 && *h > 0;
+}
+
+#ifdef LCD_USE_FRAMEBUFFER
+void lcd_band_draw_region(lcd_scene_fn scene, int x, int y, int w, int h) {
+    if (!lcd_band_clip(&x, &y, &w, &h)) return;
+    
+    // A full repaint may start the palette over
+    if (w == 320 && h == 320) {
+        lcd_fb_reset_palette();
+    }
+    
+    lcd_band_x = x;
+    lcd_band_y = y;
+    lcd_band_w = w;
+    lcd_band_h = h;
+    lcd_band_drawing = true;
+    scene();
+    lcd_band_drawing = false;
+}
+
+void lcd_band_flush_region(int x, int y, int w, int h) {
+    if (!lcd_band_clip(&x, &y, &w, &h)) return;
+    
+    int rows = LCD_BAND_PIXELS / w;
+    
+    for (int by = y; by < y + h; by += rows) {
+        int bh = (y + h - by) < rows ? (y + h - by) : rows;
+    
+        // Expand into the free buffer while the previous band is sent
+        lcd_fb_expand(x, by, w, bh, lcd_band_bufs[lcd_band_next]);
+        lcd_band_flush(x, y, w, h, by, bh);
+    }
+}
+
+void lcd_band_render_region(lcd_scene_fn scene, int x, int y, int w, int h) {
+    lcd_band_draw_region(scene, x, y, w, h);
+    lcd_band_flush_region(x, y, w, h);
+}
+#else
+void lcd_band_render_region(lcd_scene_fn scene, int x, int y, int w, int h) {
+    if (!lcd_band_clip(&x, &y, &w, &h)) return;
+    
+    int rows = LCD_BAND_PIXELS / w;
+    
+    for (int by = y; by < y + h; by += rows) {
+        int bh = (y + h - by) < rows ? (y + h - by) : rows;
+    
+        // Rasterize into the free buffer while the previous band is sent
+        lcd_band_x = x;
+        lcd_band_y = by;
+        lcd_band_w = w;
+        lcd_band_h = bh;
+        lcd_band_drawing = true;
+        scene();
+        lcd_band_drawing = false;
+    
+        lcd_band_flush(x, y, w, h, by, bh);
+    }
+}
+#endif
+
+void lcd_band_render(lcd_scene_fn scene) {
+    lcd_band_render_region(scene, 0, 0, 320, 320);
+}
@@ -0,0 +1,67 @@
+/*
+ * Band renderer for the ILI9488
+ *
+ * A full RGB888 frame (307 KB) does not fit in SRAM. Instead a screen is
+ * written as a scene function that is run once per 320x16 band: while it
+ * runs, lcd_pixel and lcd_fill_rect draw into the band buffer and clip
+ * away everything outside it. Each finished band goes out in one DMA
+ * transfer while the next band is rasterized into the second buffer, the
+ * first into a window opened over the whole region and the rest carrying
+ * on where it stopped (RAMWRC), so a full screen is exactly one pass of
+ * pixels over the bus.
+ *
+ * With LCD_USE_FRAMEBUFFER (see lcd_fb.h) the scene instead runs once
+ * into the indexed framebuffer and the band buffers only carry expanded
+ * RGB888 to the panel.
+ *
+ * A scene must paint every pixel of the screen (they all start with
+ * lcd_clear) and may only draw; anything that talks to the panel directly
+ * (commands, lcd_bus writes) must happen before or after the render.
+ */
+
+#ifndef LCD_BAND_H
+#define LCD_BAND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define LCD_BAND_ROWS   16
+#define LCD_BAND_PIXELS (320 * LCD_BAND_ROWS)
+
+typedef void (*lcd_scene_fn)(void);
+
+// Rasterize and flush the whole screen
+void lcd_band_render(lcd_scene_fn scene);
+
+// Rasterize and flush only a rectangle of the screen. Narrow regions get
+// taller bands, so a region always costs about one buffer per 15 KB.
+void lcd_band_render_region(lcd_scene_fn scene, int x, int y, int w, int h);
+
+#ifdef LCD_USE_FRAMEBUFFER
+// Run a scene into the indexed framebuffer, clipped to a region, without
+// touching the panel. Several regions can be drawn and flushed later.
+void lcd_band_draw_region(lcd_scene_fn scene, int x, int y, int w, int h);
+
+// Expand a framebuffer region to RGB888 band by band and send it
+void lcd_band_flush_region(int x, int y, int w, int h);
+#endif
+
+// True while a scene is being rasterized into a band
+bool lcd_band_active(void);
+
+// True if rows y..y+h-1 miss the band being rasterized, so the caller can
+// skip the work. Always false when drawing straight to the panel.
+bool lcd_band_rows_hidden(int y, int h);
+
+// Same for a whole rectangle
+bool lcd_band_rect_hidden(int x, int y, int w, int h);
+
+// Band drawing, clipped to the active band (screen coordinates)
+void lcd_band_pixel(int x, int y, uint32_t color);
+void lcd_band_fill(int x, int y, int w, int h, uint32_t color);
+
+// RGB888 color drawn so far at a pixel of the active band (0 outside it),
+// for blending against whatever is underneath
+uint32_t lcd_band_get(int x, int y);
+
+#endif // LCD_BAND_H
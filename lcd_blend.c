@@ -0,0 +1,65 @@
+/*
+ * Blend tables for anti-aliased drawing
+ */
+
+#include "lcd_blend.h"
+#include <stddef.h>
+
+_Static_assert(LCD_BLEND_STEPS == 16, "lcd_blend_channel divides by 15");
+
+typedef struct {
+    uint32_t fg, bg;
+    uint32_t colors[LCD_BLEND_STEPS];
+} lcd_blend_entry_t;
+
+static lcd_blend_entry_t lcd_blend_cache[LCD_BLEND_CACHE_SIZE];
+static int lcd_blend_used = 0;      // entries filled so far
+static int lcd_blend_next = 0;      // next entry to replace
+static int lcd_blend_last = 0;      // most recent hit; text repeats one pair a lot
+
+// (f * a + b * (15 - a) + 7) / 15, rounded. Dividing by 15 is a multiply
+// by 4370 and a shift, exact for every sum two channels can make.
+static uint32_t lcd_blend_channel(uint32_t fg, uint32_t bg, int shift, int a) {
+    int f = (fg >> shift) & 0xFF;
+    int b = (bg >> shift) & 0xFF;
+    int max = LCD_BLEND_STEPS - 1;
+    return (uint32_t)(((f * a + b * (max - a) + max / 2) * 4370) >> 16) << shift;
+}
+
+uint32_t lcd_blend_color(uint32_t fg, uint32_t bg, int alpha) {
+    return lcd_blend_channel(fg, bg, 16, alpha) |
+           lcd_blend_channel(fg, bg, 8, alpha) |
+           lcd_blend_channel(fg, bg, 0, alpha);
+}
+
+const uint32_t* lcd_blend_lut_cached(uint32_t fg, uint32_t bg) {
+    lcd_blend_entry_t* e = &lcd_blend_cache[lcd_blend_last];
+    if (lcd_blend_used > 0 && e->fg == fg && e->bg == bg) return e->colors;
+    
+    for (int i = 0; i < lcd_blend_used; i++) {
+        e = &lcd_blend_cache[i];
+        if (e->fg == fg && e->bg == bg) {
+            lcd_blend_last = i;
+            return e->colors;
+        }
+    }
+    return NULL;
+}
+
+const uint32_t* lcd_blend_lut(uint32_t fg, uint32_t bg) {
+    const uint32_t* colors = lcd_blend_lut_cached(fg, bg);
+    if (colors) return colors;
+    
+    // Replace entries in turn
+    lcd_blend_last = lcd_blend_next;
+    lcd_blend_entry_t* e = &lcd_blend_cache[lcd_blend_next];
+    lcd_blend_next = (lcd_blend_next + 1) % LCD_BLEND_CACHE_SIZE;
+    if (lcd_blend_used < LCD_BLEND_CACHE_SIZE) lcd_blend_used++;
+    
+    e->fg = fg;
+    e->bg = bg;
+    for (int a = 0; a < LCD_BLEND_STEPS; a++) {
+        e->colors[a] = lcd_blend_color(fg, bg, a);
+    }
+    return e->colors;
+}
@@ -0,0 +1,35 @@
+/*
+ * Blend tables for anti-aliased drawing
+ *
+ * Blending a color pair at 16 alpha steps is done once per pair: the
+ * table holds every step from bg to fg, so a pixel costs one lookup
+ * instead of three multiplies and a divide (there is no FPU, and the
+ * glyph edges would need them on every row). Tables are kept in a small
+ * cache, since a screen's text comes in only a few color pairs.
+ *
+ * Text over a gradient has a new background every pixel or row, which
+ * would build a table per pixel and push the text pairs out of the
+ * cache; those pixels are blended on their own with lcd_blend_color.
+ */
+
+#ifndef LCD_BLEND_H
+#define LCD_BLEND_H
+
+#include <stdint.h>
+
+#define LCD_BLEND_STEPS       16   // alpha 0 (bg) .. 15 (fg), see LCD_FONT_ALPHA_MAX
+#define LCD_BLEND_CACHE_SIZE  8
+
+// RGB888 colors from bg (index 0) to fg (index LCD_BLEND_STEPS - 1). The
+// pointer stays valid until LCD_BLEND_CACHE_SIZE other pairs have been
+// looked up.
+const uint32_t* lcd_blend_lut(uint32_t fg, uint32_t bg);
+
+// The same table if the pair is already cached, or NULL; never builds one
+const uint32_t* lcd_blend_lut_cached(uint32_t fg, uint32_t bg);
+
+// One step of the table worked out on its own, for a background that
+// changes from pixel to pixel (a gradient) and would only churn the cache
+uint32_t lcd_blend_color(uint32_t fg, uint32_t bg, int alpha);
+
+#endif // LCD_BLEND_H
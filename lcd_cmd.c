@@ -0,0 +1,96 @@
+/*
+ * Batched ILI9488 command lists
+ */
+
+#include "lcd_cmd.h"
+#include <string.h>
+
+void lcd_cmd_reset(lcd_cmd_list_t* list) {
+    list->len = 0;
+    list->num_cmds = 0;
+}
+
+bool lcd_cmd_add(lcd_cmd_list_t* list, uint8_t cmd, const uint8_t* params, size_t num_params) {
+    if (list->num_cmds >= LCD_CMD_MAX_CMDS) return false;
+    if (list->len + 1 + num_params > LCD_CMD_MAX_BYTES) return false;
+    
+    list->cmd_at[list->num_cmds++] = list->len;
+    list->bytes[list->len++] = cmd;
+    if (num_params > 0) {
+        memcpy(&list->bytes[list->len], params, num_params);
+        list->len += num_params;
+    }
+    return true;
+}
+
+bool lcd_cmd_window(lcd_cmd_list_t* list, int x0, int y0, int x1, int y1) {
+    uint8_t cols[4] = { x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF };
+    uint8_t rows[4] = { y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF };
+    
+    return lcd_cmd_add(list, LCD_CMD_CASET, cols, 4) &&
+           lcd_cmd_add(list, LCD_CMD_RASET, rows, 4) &&
+           lcd_cmd_add(list, LCD_CMD_RAMWR, NULL, 0);
+}
+
+bool lcd_cmd_continue(lcd_cmd_list_t* list) {
+    return lcd_cmd_add(list, LCD_CMD_RAMWRC, NULL, 0);
+}
+
+bool lcd_cmd_scroll_area(lcd_cmd_list_t* list, int top_fixed, int scroll_rows, int bottom_fixed) {
+    uint8_t p[6] = { top_fixed >> 8, top_fixed & 0xFF,
+                     scroll_rows >> 8, scroll_rows & 0xFF,
+                     bottom_fixed >> 8, bottom_fixed & 0xFF };
+    
+    return lcd_cmd_add(list, LCD_CMD_VSCRDEF, p, 6);
+}
+
+bool lcd_cmd_scroll_start(lcd_cmd_list_t* list, int row) {
+    uint8_t p[2] = { row >> 8, row & 0xFF };
+    
+    return lcd_cmd_add(list, LCD_CMD_VSCRSADD, p, 2);
+}
+
+void lcd_cmd_flush(const lcd_cmd_list_t* list, const lcd_bus_t* bus, bool keep_selected) {
+    bus->select(true);
+    
+    for (int i = 0; i < list->num_cmds; i++) {
+        int start = list->cmd_at[i];
+        int end = (i + 1 < list->num_cmds) ? list->cmd_at[i + 1] : list->len;
+        
+        bus->set_dc(false);
+        bus->write(&list->bytes[start], 1);
+        
+        if (end - start > 1) {
+            bus->set_dc(true);
+            bus->write(&list->bytes[start + 1], end - start - 1);
+        }
+    }
+    
+    if (keep_selected) {
+        bus->set_dc(true);
+    } else {
+        bus->select(false);
+    }
+}
+
+size_t lcd_cmd_encode_tagged(const lcd_cmd_list_t* list, uint16_t* out, size_t max_units,
+                             bool keep_selected) {
+    size_t needed = list->len + (keep_selected ? 0 : 1);
+    if (needed > max_units) return 0;
+    
+    size_t n = 0;
+    for (int i = 0; i < list->num_cmds; i++) {
+        int start = list->cmd_at[i];
+        int end = (i + 1 < list->num_cmds) ? list->cmd_at[i + 1] : list->len;
+        
+        out[n++] = LCD_TAG_CMD(list->bytes[start]);
+        for (int j = start + 1; j < end; j++) {
+            out[n++] = LCD_TAG_PARAM(list->bytes[j]);
+        }
+    }
+    
+    if (!keep_selected) {
+        out[n++] = LCD_TAG_END;
+    }
+    return n;
+}
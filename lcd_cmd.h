@@ -0,0 +1,82 @@
+/*
+ * Batched ILI9488 command lists
+ *
+ * A whole command sequence (e.g. CASET + RASET + RAMWR) is encoded into a
+ * buffer and sent in one CS assertion, switching DC only at command/data
+ * boundaries. The encoder has no hardware dependencies; the bus it is
+ * flushed over is supplied by the caller, so a host-side recording bus
+ * can check the emitted byte stream.
+ */
+
+#ifndef LCD_CMD_H
+#define LCD_CMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// ILI9488 commands
+#define LCD_CMD_CASET    0x2A  // Column address set
+#define LCD_CMD_RASET    0x2B  // Page (row) address set
+#define LCD_CMD_RAMWR    0x2C  // Memory write
+#define LCD_CMD_RAMWRC   0x3C  // Memory write continue
+#define LCD_CMD_VSCRDEF  0x33  // Vertical scrolling definition
+#define LCD_CMD_VSCRSADD 0x37  // Vertical scrolling start address
+
+#define LCD_CMD_MAX_BYTES 96
+#define LCD_CMD_MAX_CMDS  24
+
+typedef struct {
+    uint8_t bytes[LCD_CMD_MAX_BYTES];
+    uint8_t cmd_at[LCD_CMD_MAX_CMDS];   // Offset of each command byte in bytes[]
+    uint8_t len;
+    uint8_t num_cmds;
+} lcd_cmd_list_t;
+
+// Where a list goes. The firmware drives spi1; host code can record instead.
+typedef struct {
+    void (*select)(bool selected);              // CS (true = asserted)
+    void (*set_dc)(bool data);                  // DC (false = command)
+    void (*write)(const uint8_t* buf, size_t len);
+} lcd_bus_t;
+
+void lcd_cmd_reset(lcd_cmd_list_t* list);
+
+// Append a command and its parameters. Returns false if the list is full.
+bool lcd_cmd_add(lcd_cmd_list_t* list, uint8_t cmd, const uint8_t* params, size_t num_params);
+
+// Append CASET, RASET and RAMWR for an inclusive window
+bool lcd_cmd_window(lcd_cmd_list_t* list, int x0, int y0, int x1, int y1);
+
+// Append RAMWR-continue: resume writing where the last write stopped,
+// inside the window that is already set
+bool lcd_cmd_continue(lcd_cmd_list_t* list);
+
+// Append VSCRDEF: top fixed rows, scrolling rows, bottom fixed rows.
+// The three must add up to the controller's 480 frame-memory rows.
+bool lcd_cmd_scroll_area(lcd_cmd_list_t* list, int top_fixed, int scroll_rows, int bottom_fixed);
+
+// Append VSCRSADD: frame-memory row shown at the top of the scrolling area
+bool lcd_cmd_scroll_start(lcd_cmd_list_t* list, int row);
+
+// Send the list in one CS assertion. With keep_selected the bus is left
+// asserted in data mode so pixel bytes can follow directly.
+void lcd_cmd_flush(const lcd_cmd_list_t* list, const lcd_bus_t* bus, bool keep_selected);
+
+// Tagged stream for the PIO transport: one 16-bit unit per bus byte,
+// read MSB first by the state machine.
+//   bit 15     END  - release CS; no byte is clocked out
+//   bit 14     DC   - 1 = data, 0 = command
+//   bits 13..6 the byte itself
+#define LCD_TAG_END       0x8000
+#define LCD_TAG_DATA      0x4000
+#define LCD_TAG_BYTE(b)   ((uint16_t)((uint8_t)(b)) << 6)
+#define LCD_TAG_CMD(b)    LCD_TAG_BYTE(b)
+#define LCD_TAG_PARAM(b)  (LCD_TAG_DATA | LCD_TAG_BYTE(b))
+
+// Encode a list as tagged units; same framing as lcd_cmd_flush.
+// Returns the number of units written, or 0 if out is too small.
+size_t lcd_cmd_encode_tagged(const lcd_cmd_list_t* list, uint16_t* out, size_t max_units,
+                             bool keep_selected);
+
+#endif // LCD_CMD_H
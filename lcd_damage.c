@@ -0,0 +1,104 @@
+/*
+ * Dirty-rectangle tracking for partial redraws
+ */
+
+#include "lcd_damage.h"
+
+static lcd_rect_t lcd_damage[LCD_DAMAGE_MAX_RECTS];
+static int lcd_damage_num = 0;
+
+static int lcd_rect_area(const lcd_rect_t* r) {
+    return r->w * r->h;
+}
+
+static lcd_rect_t lcd_rect_union(const lcd_rect_t* a, const lcd_rect_t* b) {
+    int x0 = a->x < b->x ? a->x : b->x;
+    int y0 = a->y < b->y ? a->y : b->y;
+    int x1 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+    int y1 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+    lcd_rect_t u = { x0, y0, x1 - x0, y1 - y0 };
+    return u;
+}
+
+static bool lcd_rect_overlaps(const lcd_rect_t* a, const lcd_rect_t* b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w &&
+           a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+// Overlapping rectangles always merge; separate ones only if the union
+// wastes little
+static bool lcd_rect_should_merge(const lcd_rect_t* a, const lcd_rect_t* b) {
+    if (lcd_rect_overlaps(a, b)) return true;
+    
+    lcd_rect_t u = lcd_rect_union(a, b);
+    return lcd_rect_area(&u) <= lcd_rect_area(a) + lcd_rect_area(b) + LCD_DAMAGE_MERGE_SLACK;
+}
+
+static void lcd_damage_remove(int i) {
+    lcd_damage[i] = lcd_damage[--lcd_damage_num];
+}
+
+void lcd_damage_add(int x, int y, int w, int h) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > 320) w = 320 - x;
+    if (y + h > 320) h = 320 - y;
+    if (w <= 0 || h <= 0) return;
+    
+    lcd_rect_t r = { x, y, w, h };
+    
+    // Absorb every rectangle worth merging; the union can reach
+    // rectangles the original did not, so rescan after each merge
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < lcd_damage_num; i++) {
+            if (lcd_rect_should_merge(&r, &lcd_damage[i])) {
+                r = lcd_rect_union(&r, &lcd_damage[i]);
+                lcd_damage_remove(i);
+                merged = true;
+                break;
+            }
+        }
+    }
+    
+    // Out of slots: fold into whichever rectangle grows the least
+    if (lcd_damage_num == LCD_DAMAGE_MAX_RECTS) {
+        int best = 0;
+        int best_growth = 0x7FFFFFFF;
+        for (int i = 0; i < lcd_damage_num; i++) {
+            lcd_rect_t u = lcd_rect_union(&r, &lcd_damage[i]);
+            int growth = lcd_rect_area(&u) - lcd_rect_area(&lcd_damage[i]) - lcd_rect_area(&r);
+            if (growth < best_growth) {
+                best_growth = growth;
+                best = i;
+            }
+        }
+        lcd_rect_t u = lcd_rect_union(&r, &lcd_damage[best]);
+        lcd_damage_remove(best);
+        lcd_damage_add(u.x, u.y, u.w, u.h);
+        return;
+    }
+    
+    lcd_damage[lcd_damage_num++] = r;
+}
+
+void lcd_damage_reset(void) {
+    lcd_damage_num = 0;
+}
+
+int lcd_damage_count(void) {
+    return lcd_damage_num;
+}
+
+const lcd_rect_t* lcd_damage_rects(void) {
+    return lcd_damage;
+}
+
+void lcd_damage_flush(lcd_scene_fn scene) {
+    for (int i = 0; i < lcd_damage_num; i++) {
+        lcd_rect_t* r = &lcd_damage[i];
+        lcd_band_render_region(scene, r->x, r->y, r->w, r->h);
+    }
+    lcd_damage_reset();
+}
@@ -0,0 +1,40 @@
+/*
+ * Dirty-rectangle tracking for partial redraws
+ *
+ * Rectangles whose content is about to change are marked (normally by
+ * diffing a screen's display lists, see lcd_dl.h) and merged as they come
+ * in. A flush then renders the screen's scene through the band renderer
+ * into each dirty rectangle only, so moving a selection repaints two list
+ * rows and a scroll thumb instead of the whole panel.
+ */
+
+#ifndef LCD_DAMAGE_H
+#define LCD_DAMAGE_H
+
+#include <stdbool.h>
+#include "lcd_band.h"
+
+#define LCD_DAMAGE_MAX_RECTS 8
+
+// Two rectangles are merged when their union covers at most this many
+// pixels beyond the two of them: about what one extra window costs
+#define LCD_DAMAGE_MERGE_SLACK 256
+
+typedef struct {
+    int x, y, w, h;
+} lcd_rect_t;
+
+// Mark a rectangle (screen coordinates) as needing a redraw
+void lcd_damage_add(int x, int y, int w, int h);
+
+// Forget all dirty rectangles
+void lcd_damage_reset(void);
+
+// Number of dirty rectangles and access to them (after merging)
+int lcd_damage_count(void);
+const lcd_rect_t* lcd_damage_rects(void);
+
+// Redraw every dirty rectangle from the scene, then reset
+void lcd_damage_flush(lcd_scene_fn scene);
+
+#endif // LCD_DAMAGE_H
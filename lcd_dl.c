@@ -0,0 +1,285 @@
+/*
+ * Retained display lists
+ */
+
+#include "lcd_dl.h"
+#include "lcd_font.h"
+#include "lcd_glyph.h"
+#include "lcd_metrics.h"
+#include <string.h>
+
+void lcd_dl_reset(lcd_dl_t* dl) {
+    dl->num_prims = 0;
+    dl->text_len = 0;
+}
+
+static uint16_t lcd_dl_intern(lcd_dl_t* dl, const char* str, bool* ok) {
+    if (str == NULL) return LCD_DL_NO_TEXT;
+    
+    size_t len = strlen(str) + 1;
+    if (dl->text_len + len > LCD_DL_TEXT_POOL) {
+        *ok = false;
+        return LCD_DL_NO_TEXT;
+    }
+    
+    uint16_t offset = dl->text_len;
+    memcpy(&dl->text[offset], str, len);
+    dl->text_len += len;
+    return offset;
+}
+
+static lcd_prim_t* lcd_dl_add(lcd_dl_t* dl, lcd_dl_kind_t kind, int x, int y, int w, int h) {
+    if (dl->num_prims >= LCD_DL_MAX_PRIMS) return NULL;
+    
+    lcd_prim_t* p = &dl->prims[dl->num_prims];
+    memset(p, 0, sizeof(*p));
+    p->kind = kind;
+    p->x = x;
+    p->y = y;
+    p->w = w;
+    p->h = h;
+    p->ox = x;
+    p->oy = y;
+    p->text = LCD_DL_NO_TEXT;
+    p->text2 = LCD_DL_NO_TEXT;
+    return p;
+}
+
+// Commit a primitive whose strings were interned successfully
+static bool lcd_dl_commit(lcd_dl_t* dl, int text_len_before, bool ok) {
+    if (!ok) {
+        dl->text_len = text_len_before;
+        return false;
+    }
+    dl->num_prims++;
+    return true;
+}
+
+bool lcd_dl_fill(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color) {
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_FILL, x, y, w, h);
+    if (!p) return false;
+    
+    p->color = color;
+    dl->num_prims++;
+    return true;
+}
+
+bool lcd_dl_frame(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color) {
+    // lcd_rect draws both edges inclusive
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_FRAME, x, y, w + 1, h + 1);
+    if (!p) return false;
+    
+    p->a = w;
+    p->b = h;
+    p->color = color;
+    dl->num_prims++;
+    return true;
+}
+
+bool lcd_dl_rounded(lcd_dl_t* dl, int x, int y, int w, int h, int radius, uint32_t color) {
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_ROUNDED, x, y, w, h);
+    if (!p) return false;
+    
+    p->a = radius;
+    p->color = color;
+    dl->num_prims++;
+    return true;
+}
+
+bool lcd_dl_gradient(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color1, uint32_t color2, bool horizontal) {
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_GRADIENT, x, y, w, h);
+    if (!p) return false;
+    
+    p->a = horizontal;
+    p->color = color1;
+    p->color2 = color2;
+    dl->num_prims++;
+    return true;
+}
+
+// Grow a box (x0,y0)-(x1,y1) exclusive by the ink of a glyph run, placed
+// the way lcd_glyph_run places it
+static void lcd_dl_extend_run(int* x0, int* y0, int* x1, int* y1, int x, int y,
+                              const char* str, int len, int scale, int flags) {
+    int repeat;
+    const lcd_font_t* font = lcd_font_for_scale(scale, &repeat);
+    
+    const char* end = str + len;
+    uint32_t prev = 0;
+    int pen = 0;
+    while (str < end) {
+        uint32_t cp = lcd_glyph_decode(&str, end, flags);
+        if (prev) pen += lcd_font_kerning(font, prev, cp);
+        prev = cp;
+    
+        const lcd_font_glyph_t* g = lcd_font_glyph(font, cp);
+        if (g->width > 0) {
+            int gx = x + (pen + g->x_offset) * repeat;
+            int gy = y + g->y_offset * repeat;
+            if (gx < *x0) *x0 = gx;
+            if (gy < *y0) *y0 = gy;
+            if (gx + g->width * repeat > *x1) *x1 = gx + g->width * repeat;
+            if (gy + g->height * repeat > *y1) *y1 = gy + g->height * repeat;
+        }
+        pen += g->advance;
+    }
+}
+
+bool lcd_dl_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t color) {
+    // Same lines as lcd_text: wrapped at the right edge, 10 px apart
+    int x0 = x, y0 = y, x1 = x, y1 = y;
+    int len = strlen(str);
+    int cy = y;
+    const char* s = str;
+    while (len > 0) {
+        int next;
+        int n = lcd_metrics_wrap(s, len, 1, 0, 320 - x, &next);
+        lcd_dl_extend_run(&x0, &y0, &x1, &y1, x, cy, s, n, 1, 0);
+        s += next;
+        len -= next;
+        cy += 10;
+    }
+    
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_TEXT, x0, y0, x1 - x0, y1 - y0);
+    if (!p) return false;
+    
+    int before = dl->text_len;
+    bool ok = true;
+    p->ox = x;
+    p->oy = y;
+    p->color = color;
+    p->text = lcd_dl_intern(dl, str, &ok);
+    return lcd_dl_commit(dl, before, ok);
+}
+
+// Bounding box of draw_large_text: uppercase runs, 16*scale lines, no wrap
+static void lcd_dl_large_box(int x, int y, const char* str, int scale,
+                             int* x0, int* y0, int* x1, int* y1) {
+    *x0 = x; *y0 = y; *x1 = x; *y1 = y;
+    int cy = y;
+    while (true) {
+        const char* end = strchr(str, '\n');
+        int len = end ? end - str : (int)strlen(str);
+        lcd_dl_extend_run(x0, y0, x1, y1, x, cy, str, len, scale, LCD_GLYPH_UPPER);
+        if (!end) break;
+        str = end + 1;
+        cy += 16 * scale;
+    }
+}
+
+bool lcd_dl_large_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t color, int scale) {
+    int x0, y0, x1, y1;
+    lcd_dl_large_box(x, y, str, scale, &x0, &y0, &x1, &y1);
+    
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_LARGE_TEXT, x0, y0, x1 - x0, y1 - y0);
+    if (!p) return false;
+    
+    int before = dl->text_len;
+    bool ok = true;
+    p->ox = x;
+    p->oy = y;
+    p->a = scale;
+    p->color = color;
+    p->text = lcd_dl_intern(dl, str, &ok);
+    return lcd_dl_commit(dl, before, ok);
+}
+
+bool lcd_dl_outlined_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t fg_color, uint32_t outline_color, int scale) {
+    int x0, y0, x1, y1;
+    lcd_dl_large_box(x, y, str, scale, &x0, &y0, &x1, &y1);
+    
+    // The outline is the text shifted by one pixel in every direction
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_OUTLINED_TEXT, x0 - 1, y0 - 1, x1 - x0 + 2, y1 - y0 + 2);
+    if (!p) return false;
+    
+    int before = dl->text_len;
+    bool ok = true;
+    p->ox = x;
+    p->oy = y;
+    p->a = scale;
+    p->color = fg_color;
+    p->color2 = outline_color;
+    p->text = lcd_dl_intern(dl, str, &ok);
+    return lcd_dl_commit(dl, before, ok);
+}
+
+bool lcd_dl_widget(lcd_dl_t* dl, int id, int x, int y, int w, int h,
+                   int arg1, int arg2, int arg3, const char* str1, const char* str2) {
+    lcd_prim_t* p = lcd_dl_add(dl, LCD_DL_WIDGET, x, y, w, h);
+    if (!p) return false;
+    
+    int before = dl->text_len;
+    bool ok = true;
+    p->a = id;
+    p->b = arg1;
+    p->c = arg2;
+    p->d = arg3;
+    p->text = lcd_dl_intern(dl, str1, &ok);
+    p->text2 = lcd_dl_intern(dl, str2, &ok);
+    return lcd_dl_commit(dl, before, ok);
+}
+
+const char* lcd_dl_str(const lcd_dl_t* dl, uint16_t offset) {
+    return offset == LCD_DL_NO_TEXT ? "" : &dl->text[offset];
+}
+
+static bool lcd_dl_same_str(const lcd_dl_t* a, uint16_t ta, const lcd_dl_t* b, uint16_t tb) {
+    if (ta == LCD_DL_NO_TEXT || tb == LCD_DL_NO_TEXT) return ta == tb;
+    return strcmp(&a->text[ta], &b->text[tb]) == 0;
+}
+
+static bool lcd_dl_same(const lcd_dl_t* a, const lcd_prim_t* pa, const lcd_dl_t* b, const lcd_prim_t* pb) {
+    return pa->kind == pb->kind &&
+           pa->x == pb->x && pa->y == pb->y && pa->w == pb->w && pa->h == pb->h &&
+           pa->ox == pb->ox && pa->oy == pb->oy &&
+           pa->a == pb->a && pa->b == pb->b && pa->c == pb->c && pa->d == pb->d &&
+           pa->color == pb->color && pa->color2 == pb->color2 &&
+           lcd_dl_same_str(a, pa->text, b, pb->text) &&
+           lcd_dl_same_str(a, pa->text2, b, pb->text2);
+}
+
+void lcd_dl_diff(const lcd_dl_t* old_dl, const lcd_dl_t* new_dl,
+                 void (*mark)(int x, int y, int w, int h)) {
+    bool old_matched[LCD_DL_MAX_PRIMS] = { false };
+    
+    for (int i = 0; i < new_dl->num_prims; i++) {
+        const lcd_prim_t* p = &new_dl->prims[i];
+        bool found = false;
+    
+        for (int j = 0; j < old_dl->num_prims; j++) {
+            if (!old_matched[j] && lcd_dl_same(new_dl, p, old_dl, &old_dl->prims[j])) {
+                old_matched[j] = true;
+                found = true;
+                break;
+            }
+        }
+    
+        if (!found) {
+            mark(p->x, p->y, p->w, p->h);
+        }
+    }
+    
+    // Whatever disappeared has to be painted over
+    for (int j = 0; j < old_dl->num_prims; j++) {
+        if (!old_matched[j]) {
+            const lcd_prim_t* p = &old_dl->prims[j];
+            mark(p->x, p->y, p->w, p->h);
+        }
+    }
+}
+
+static const char* const lcd_dl_kind_names[] = {
+    "fill", "frame", "rounded", "gradient", "text", "large_text", "outlined_text", "widget"
+};
+
+void lcd_dl_dump(const lcd_dl_t* dl, FILE* out) {
+    for (int i = 0; i < dl->num_prims; i++) {
+        const lcd_prim_t* p = &dl->prims[i];
+        fprintf(out, "%-13s box=%d,%d,%dx%d at=%d,%d args=%d,%d,%d,%d color=#%06lx,#%06lx",
+                lcd_dl_kind_names[p->kind], p->x, p->y, p->w, p->h, p->ox, p->oy,
+                p->a, p->b, p->c, p->d, (unsigned long)p->color, (unsigned long)p->color2);
+        if (p->text != LCD_DL_NO_TEXT) fprintf(out, " \"%s\"", lcd_dl_str(dl, p->text));
+        if (p->text2 != LCD_DL_NO_TEXT) fprintf(out, " \"%s\"", lcd_dl_str(dl, p->text2));
+        fprintf(out, "\n");
+    }
+}
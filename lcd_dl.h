@@ -0,0 +1,83 @@
+/*
+ * Retained display lists
+ *
+ * A screen is described as a short list of primitives (fills, frames,
+ * gradients, text runs and references to composite widgets such as the
+ * article header or a diagram). Every primitive carries its bounding box
+ * and owns copies of its strings, so two lists can be compared after the
+ * state they were built from has changed. Diffing the list a screen had
+ * on the panel against a freshly built one yields exactly the areas that
+ * need re-rasterizing.
+ *
+ * No hardware dependencies: lists can be built, dumped and diffed on the
+ * host. Rasterizing a list is left to the firmware.
+ */
+
+#ifndef LCD_DL_H
+#define LCD_DL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define LCD_DL_MAX_PRIMS 64
+#define LCD_DL_TEXT_POOL 1024
+#define LCD_DL_NO_TEXT   0xFFFF
+
+typedef enum {
+    LCD_DL_FILL,            // lcd_fill_rect
+    LCD_DL_FRAME,           // lcd_rect
+    LCD_DL_ROUNDED,         // draw_rounded_rect; a = radius
+    LCD_DL_GRADIENT,        // draw_gradient_rect; a = horizontal
+    LCD_DL_TEXT,            // lcd_text
+    LCD_DL_LARGE_TEXT,      // draw_large_text; a = scale
+    LCD_DL_OUTLINED_TEXT,   // draw_outlined_text; a = scale, color2 = outline
+    LCD_DL_WIDGET,          // composite drawn by the firmware; a = widget id, b..d = arguments
+} lcd_dl_kind_t;
+
+typedef struct {
+    uint8_t kind;
+    int16_t x, y, w, h;     // bounding box of everything the primitive draws
+    int16_t ox, oy;         // origin passed to the draw call
+    int a, b, c, d;         // kind-specific arguments (an article line can pass 32767)
+    uint32_t color, color2;
+    uint16_t text, text2;   // offsets into the list's text pool
+} lcd_prim_t;
+
+typedef struct {
+    lcd_prim_t prims[LCD_DL_MAX_PRIMS];
+    char text[LCD_DL_TEXT_POOL];
+    int num_prims;
+    int text_len;
+} lcd_dl_t;
+
+void lcd_dl_reset(lcd_dl_t* dl);
+
+// Primitives. Each returns false (and adds nothing) if the list is full.
+bool lcd_dl_fill(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color);
+bool lcd_dl_frame(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color);
+bool lcd_dl_rounded(lcd_dl_t* dl, int x, int y, int w, int h, int radius, uint32_t color);
+bool lcd_dl_gradient(lcd_dl_t* dl, int x, int y, int w, int h, uint32_t color1, uint32_t color2, bool horizontal);
+bool lcd_dl_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t color);
+bool lcd_dl_large_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t color, int scale);
+bool lcd_dl_outlined_text(lcd_dl_t* dl, int x, int y, const char* str, uint32_t fg_color, uint32_t outline_color, int scale);
+
+// A composite the caller knows how to draw. The bounding box must cover
+// everything it draws; the arguments and strings (either may be NULL)
+// are what the diff compares.
+bool lcd_dl_widget(lcd_dl_t* dl, int id, int x, int y, int w, int h,
+                   int arg1, int arg2, int arg3, const char* str1, const char* str2);
+
+// String of a primitive, or "" if it has none
+const char* lcd_dl_str(const lcd_dl_t* dl, uint16_t offset);
+
+// Report the bounding box of every primitive that appears in one list but
+// not the other. Primitives are matched by content, not position, so a
+// primitive that is still present somewhere in the new list is left alone.
+void lcd_dl_diff(const lcd_dl_t* old_dl, const lcd_dl_t* new_dl,
+                 void (*mark)(int x, int y, int w, int h));
+
+// One line per primitive, for comparing lists on the host
+void lcd_dl_dump(const lcd_dl_t* dl, FILE* out);
+
+#endif // LCD_DL_H
@@ -0,0 +1,185 @@
+/*
+ * DMA constant-color fills and buffer writes for the ILI9488
+ *
+ * spi1: the panel takes 3 bytes per pixel (18-bit mode). A 24-bit pixel is
+ * sent as two 12-bit SPI frames, so the DMA channel only has to replay a
+ * fixed pair of halfwords: it reads the 4-byte pattern through a read ring
+ * and never advances past it.
+ *
+ * PIO (LCD_USE_PIO): every byte is a tagged unit and three units per pixel
+ * cannot be ring-wrapped, so a buffer of pre-tagged pixels is replayed from
+ * the channel IRQ until the rectangle is covered.
+ *
+ * Buffer writes (the band renderer's flush) reuse the same channel with a
+ * plain byte-wide configuration on spi1. On PIO the bytes have to be
+ * tagged first, which lcd_pio_bus already does while its own DMA drains.
+ *
+ * Either way the CPU sleeps in WFE until the channel's IRQ.
+ */
+
+#include "lcd_dma.h"
+#include "lcd_cmd.h"
+#include "lcd_pins.h"
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+
+#ifdef LCD_USE_PIO
+#include "lcd_pio.h"
+#endif
+
+extern void lcd_set_window(int x0, int y0, int x1, int y1);
+
+static int lcd_dma_chan = -1;
+static volatile bool lcd_dma_pending = false;
+
+#ifdef LCD_USE_PIO
+// Pixels per replayed chunk of tagged units
+#define LCD_DMA_PIO_PIXELS 170
+
+static uint16_t lcd_dma_units[LCD_DMA_PIO_PIXELS * 3];
+static volatile uint32_t lcd_dma_remaining = 0;  // pixels not yet queued
+
+static void lcd_dma_next_chunk(void) {
+    uint32_t n = lcd_dma_remaining < LCD_DMA_PIO_PIXELS ? lcd_dma_remaining : LCD_DMA_PIO_PIXELS;
+    lcd_dma_remaining -= n;
+    dma_channel_transfer_from_buffer_now(lcd_dma_chan, lcd_dma_units, n * 3);
+}
+#else
+static dma_channel_config lcd_dma_fill_config;
+static dma_channel_config lcd_dma_write_config;
+
+// Two 12-bit SPI frames = one RGB888 pixel; must stay 4-byte aligned for the ring
+static uint16_t lcd_dma_pattern[2] __attribute__((aligned(4)));
+#endif
+
+static void lcd_dma_irq_handler(void) {
+    if (dma_channel_get_irq0_status(lcd_dma_chan)) {
+        dma_channel_acknowledge_irq0(lcd_dma_chan);
+#ifdef LCD_USE_PIO
+        if (lcd_dma_remaining > 0) {
+            lcd_dma_next_chunk();
+            return;
+        }
+#endif
+        __sev();
+    }
+}
+
+void lcd_dma_init(void) {
+    lcd_dma_chan = dma_claim_unused_channel(true);
+    
+    dma_channel_config c = dma_channel_get_default_config(lcd_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    
+#ifdef LCD_USE_PIO
+    // Halfword writes into TXF are replicated across the word, so each
+    // unit reaches the top half the state machine reads (see lcd_pio_init)
+    channel_config_set_dreq(&c, lcd_pio_dreq());
+    dma_channel_configure(lcd_dma_chan, &c, lcd_pio_txf(), lcd_dma_units, 0, false);
+#else
+    channel_config_set_dreq(&c, spi_get_dreq(spi1, true));
+    
+    lcd_dma_write_config = c;
+    channel_config_set_transfer_data_size(&lcd_dma_write_config, DMA_SIZE_8);
+    
+    channel_config_set_ring(&c, false, 2);  // wrap reads every 4 bytes
+    dma_channel_configure(lcd_dma_chan, &c, &spi_get_hw(spi1)->dr,
+                          lcd_dma_pattern, 0, false);
+    lcd_dma_fill_config = c;
+#endif
+    
+    dma_channel_set_irq0_enabled(lcd_dma_chan, true);
+    irq_add_shared_handler(DMA_IRQ_0, lcd_dma_irq_handler,
+                           PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+void lcd_dma_fill_start(int x, int y, int w, int h, uint32_t color) {
+    // Leaves CS asserted in data mode
+    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    
+#ifdef LCD_USE_PIO
+    for (int i = 0; i < LCD_DMA_PIO_PIXELS; i++) {
+        lcd_dma_units[i * 3]     = LCD_TAG_PARAM(color >> 16);
+        lcd_dma_units[i * 3 + 1] = LCD_TAG_PARAM(color >> 8);
+        lcd_dma_units[i * 3 + 2] = LCD_TAG_PARAM(color);
+    }
+    
+    // The window command is still going into the FIFO on the transport's
+    // own channel; starting this one alongside would interleave the two
+    lcd_pio_wait_dma();
+    
+    lcd_dma_pending = true;
+    lcd_dma_remaining = (uint32_t)w * h;
+    lcd_dma_next_chunk();
+#else
+    lcd_dma_pattern[0] = (color >> 12) & 0xFFF;  // R and high nibble of G
+    lcd_dma_pattern[1] = color & 0xFFF;          // low nibble of G and B
+    
+    spi_set_format(spi1, 12, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    
+    lcd_dma_pending = true;
+    dma_channel_set_config(lcd_dma_chan, &lcd_dma_fill_config, false);
+    dma_channel_set_read_addr(lcd_dma_chan, lcd_dma_pattern, false);
+    dma_channel_set_trans_count(lcd_dma_chan, (uint32_t)w * h * 2, true);
+#endif
+}
+
+void lcd_dma_write_start(const uint8_t* buf, size_t len) {
+#ifdef LCD_USE_PIO
+    lcd_pio_bus.write(buf, len);
+    lcd_pio_bus.select(false);
+#else
+    lcd_dma_pending = true;
+    dma_channel_set_config(lcd_dma_chan, &lcd_dma_write_config, false);
+    dma_channel_transfer_from_buffer_now(lcd_dma_chan, buf, len);
+#endif
+}
+
+bool lcd_dma_busy(void) {
+    if (!lcd_dma_pending) return false;
+#ifdef LCD_USE_PIO
+    return lcd_dma_remaining > 0 || dma_channel_is_busy(lcd_dma_chan);
+#else
+    return dma_channel_is_busy(lcd_dma_chan) || spi_is_busy(spi1);
+#endif
+}
+
+void lcd_dma_wait(void) {
+    if (!lcd_dma_pending) return;
+    
+    // The IRQ handler raises an event, so a completion between the
+    // check and the WFE cannot be missed
+#ifdef LCD_USE_PIO
+    while (lcd_dma_remaining > 0 || dma_channel_is_busy(lcd_dma_chan)) {
+        __wfe();
+    }
+    
+    lcd_dma_pending = false;
+    lcd_pio_bus.select(false);
+#else
+    while (dma_channel_is_busy(lcd_dma_chan)) {
+        __wfe();
+    }
+    
+    // DMA is done once the FIFO is loaded; wait for the last frames to shift out
+    while (spi_is_busy(spi1)) {
+        tight_loop_contents();
+    }
+    
+    // Throw away what was clocked in during the fill and clear the overrun
+    while (spi_is_readable(spi1)) {
+        (void)spi_get_hw(spi1)->dr;
+    }
+    spi_get_hw(spi1)->icr = SPI_SSPICR_RORIC_BITS;
+    
+    gpio_put(LCD_CS, 1);
+    spi_set_format(spi1, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+    
+    lcd_dma_pending = false;
+#endif
+}
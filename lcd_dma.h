@@ -0,0 +1,34 @@
+/*
+ * DMA constant-color fills and buffer writes for the ILI9488
+ */
+
+#ifndef LCD_DMA_H
+#define LCD_DMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Rectangles at least this many pixels go through DMA instead of the CPU
+#define LCD_DMA_MIN_PIXELS 1024
+
+// Claim a DMA channel and hook its completion interrupt
+void lcd_dma_init(void);
+
+// Start filling a rectangle (already clipped) and return immediately.
+// CS stays asserted until the fill has been waited for.
+void lcd_dma_fill_start(int x, int y, int w, int h, uint32_t color);
+
+// Start streaming len bytes of RGB888 pixels into the window that
+// lcd_set_window (or lcd_continue_window) left open. buf must stay
+// untouched until the write is waited for.
+void lcd_dma_write_start(const uint8_t* buf, size_t len);
+
+// True while a started fill or write is still being shifted out
+bool lcd_dma_busy(void);
+
+// Sleep until the current fill or write is done and release the bus.
+// Safe to call when nothing is pending.
+void lcd_dma_wait(void);
+
+#endif // LCD_DMA_H
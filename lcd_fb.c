@@ -0,0 +1,214 @@
+/*
+ * 8-bit indexed framebuffer for the ILI9488
+ */
+
+#include "lcd_fb.h"
+#include "hardware/interp.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Rows stay word aligned, so the expander can read 4 indices at a time
+static uint8_t lcd_fb[LCD_FB_HEIGHT][LCD_FB_WIDTH] __attribute__((aligned(4)));
+
+static uint32_t lcd_fb_palette[LCD_FB_COLORS];
+static int lcd_fb_num_colors = 0;
+
+// Open-addressed color -> index+1 map (0 = empty slot)
+#define LCD_FB_HASH_SLOTS 512
+static uint16_t lcd_fb_hash[LCD_FB_HASH_SLOTS];
+
+// The last color looked up; fills and glyph runs repeat it a lot
+static uint32_t lcd_fb_last_color = 0xFFFFFFFF;
+static uint8_t lcd_fb_last_index = 0;
+
+// Entries given back by lcd_fb_reclaim_palette, handed out before new ones
+static uint8_t lcd_fb_free[LCD_FB_COLORS];
+static int lcd_fb_num_free = 0;
+
+// Pixels drawn since a reclaim that found nothing; the next one waits for
+// a screenful, so a screen that really shows 256 colors is not rescanned
+// for every new one
+#define LCD_FB_RECLAIM_AFTER (LCD_FB_WIDTH * LCD_FB_HEIGHT)
+static uint32_t lcd_fb_drawn = LCD_FB_RECLAIM_AFTER;
+
+void lcd_fb_init(void) {
+    // Each lane turns one byte of the word in its accumulator into the
+    // address of that palette entry: base + (byte << 2)
+    static const uint shifts[2][2] = { { 0, 6 }, { 14, 22 } };
+    interp_hw_t* interps[2] = { interp0, interp1 };
+    
+    for (int i = 0; i < 2; i++) {
+        for (uint lane = 0; lane < 2; lane++) {
+            interp_config c = interp_default_config();
+            interp_config_set_shift(&c, shifts[i][lane]);
+            interp_config_set_mask(&c, 2, 9);
+            interp_set_config(interps[i], lane, &c);
+            interp_set_base(interps[i], lane, (uintptr_t)lcd_fb_palette);
+        }
+    }
+    
+    lcd_fb_reset_palette();
+}
+
+void lcd_fb_reset_palette(void) {
+    memset(lcd_fb_hash, 0, sizeof(lcd_fb_hash));
+    lcd_fb_num_colors = 0;
+    lcd_fb_num_free = 0;
+    lcd_fb_drawn = LCD_FB_RECLAIM_AFTER;
+    lcd_fb_last_color = 0xFFFFFFFF;
+}
+
+static void lcd_fb_hash_insert(uint8_t index) {
+    uint32_t slot = (lcd_fb_palette[index] * 2654435761u) >> 23;  // 9-bit hash
+    
+    while (lcd_fb_hash[slot] != 0) {
+        slot = (slot + 1) & (LCD_FB_HASH_SLOTS - 1);
+    }
+    lcd_fb_hash[slot] = index + 1;
+}
+
+int lcd_fb_reclaim_palette(void) {
+    bool used[LCD_FB_COLORS] = { false };
+    
+    for (int y = 0; y < LCD_FB_HEIGHT; y++) {
+        for (int x = 0; x < LCD_FB_WIDTH; x++) {
+            used[lcd_fb[y][x]] = true;
+        }
+    }
+    
+    // Rebuild the map from the entries still on screen
+    memset(lcd_fb_hash, 0, sizeof(lcd_fb_hash));
+    lcd_fb_num_free = 0;
+    for (int i = 0; i < lcd_fb_num_colors; i++) {
+        if (used[i]) {
+            lcd_fb_hash_insert(i);
+        } else {
+            lcd_fb_free[lcd_fb_num_free++] = i;
+        }
+    }
+    
+    lcd_fb_last_color = 0xFFFFFFFF;
+    if (lcd_fb_num_free == 0) lcd_fb_drawn = 0;
+    return lcd_fb_num_free;
+}
+
+static uint8_t lcd_fb_nearest(uint32_t color) {
+    int r = (color >> 16) & 0xFF, g = (color >> 8) & 0xFF, b = color & 0xFF;
+    int best = 0;
+    int best_dist = 0x7FFFFFFF;
+    
+    for (int i = 0; i < lcd_fb_num_colors; i++) {
+        int dr = r - (int)((lcd_fb_palette[i] >> 16) & 0xFF);
+        int dg = g - (int)((lcd_fb_palette[i] >> 8) & 0xFF);
+        int db = b - (int)(lcd_fb_palette[i] & 0xFF);
+        int dist = dr * dr + dg * dg + db * db;
+        if (dist < best_dist) {
+            best_dist = dist;
+            best = i;
+        }
+    }
+    return best;
+}
+
+uint8_t lcd_fb_color_index(uint32_t color) {
+    color &= 0xFFFFFF;
+    if (color == lcd_fb_last_color) return lcd_fb_last_index;
+    
+    uint32_t slot = (color * 2654435761u) >> 23;  // 9-bit hash
+    uint8_t index;
+    
+    while (1) {
+        uint16_t entry = lcd_fb_hash[slot];
+        if (entry == 0) break;
+        if (lcd_fb_palette[entry - 1] == color) {
+            index = entry - 1;
+            lcd_fb_last_color = color;
+            lcd_fb_last_index = index;
+            return index;
+        }
+        slot = (slot + 1) & (LCD_FB_HASH_SLOTS - 1);
+    }
+    
+    // A new color: an entry given back, a fresh one, or whatever is no
+    // longer on screen
+    if (lcd_fb_num_free == 0 && lcd_fb_num_colors == LCD_FB_COLORS &&
+        lcd_fb_drawn >= LCD_FB_RECLAIM_AFTER) {
+        lcd_fb_reclaim_palette();
+    }
+    
+    if (lcd_fb_num_free > 0) {
+        index = lcd_fb_free[--lcd_fb_num_free];
+    } else if (lcd_fb_num_colors < LCD_FB_COLORS) {
+        index = lcd_fb_num_colors++;
+    } else {
+        // Palette full: not remembered, so the search repeats
+        index = lcd_fb_nearest(color);
+        lcd_fb_last_color = color;
+        lcd_fb_last_index = index;
+        return index;
+    }
+    
+    lcd_fb_palette[index] = color;
+    lcd_fb_hash_insert(index);
+    
+    lcd_fb_last_color = color;
+    lcd_fb_last_index = index;
+    return index;
+}
+
+void lcd_fb_pixel(int x, int y, uint32_t color) {
+    lcd_fb[y][x] = lcd_fb_color_index(color);
+    lcd_fb_drawn++;
+}
+
+uint32_t lcd_fb_get(int x, int y) {
+    return lcd_fb_palette[lcd_fb[y][x]];
+}
+
+void lcd_fb_fill(int x, int y, int w, int h, uint32_t color) {
+    uint8_t index = lcd_fb_color_index(color);
+    
+    for (int row = y; row < y + h; row++) {
+        memset(&lcd_fb[row][x], index, w);
+    }
+    lcd_fb_drawn += (uint32_t)w * h;
+}
+
+static inline uint8_t* lcd_fb_put(uint8_t* out, uint32_t rgb) {
+    out[0] = (rgb >> 16) & 0xFF;
+    out[1] = (rgb >> 8) & 0xFF;
+    out[2] = rgb & 0xFF;
+    return out + 3;
+}
+
+void lcd_fb_expand(int x, int y, int w, int h, uint8_t* out) {
+    for (int row = y; row < y + h; row++) {
+        const uint8_t* src = &lcd_fb[row][x];
+        int n = w;
+    
+        // Single indices up to a word boundary
+        while (n > 0 && ((uintptr_t)src & 3)) {
+            out = lcd_fb_put(out, lcd_fb_palette[*src++]);
+            n--;
+        }
+    
+        // Four indices per word, one interpolator lane each
+        const uint32_t* words = (const uint32_t*)src;
+        for (; n >= 4; n -= 4) {
+            uint32_t word = *words++;
+            interp_set_accumulator(interp0, 0, word << 2);
+            interp_set_accumulator(interp0, 1, word);
+            interp_set_accumulator(interp1, 0, word);
+            interp_set_accumulator(interp1, 1, word);
+            out = lcd_fb_put(out, *(const uint32_t*)interp_peek_lane_result(interp0, 0));
+            out = lcd_fb_put(out, *(const uint32_t*)interp_peek_lane_result(interp0, 1));
+            out = lcd_fb_put(out, *(const uint32_t*)interp_peek_lane_result(interp1, 0));
+            out = lcd_fb_put(out, *(const uint32_t*)interp_peek_lane_result(interp1, 1));
+        }
+    
+        src = (const uint8_t*)words;
+        while (n-- > 0) {
+            out = lcd_fb_put(out, lcd_fb_palette[*src++]);
+        }
+    }
+}
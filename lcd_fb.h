@@ -0,0 +1,48 @@
+/*
+ * 8-bit indexed framebuffer for the ILI9488 (build with LCD_USE_FRAMEBUFFER)
+ *
+ * The whole 320x320 screen is kept in SRAM as palette indices (100 KB)
+ * with a 256-entry RGB888 palette that fills up as colors are drawn.
+ * Drawing is plain byte stores; pixels only reach the panel when a
+ * region is expanded to RGB888 at flush time. The expansion runs four
+ * indices per word through both SIO interpolators.
+ *
+ * The UI uses a few dozen colors plus gradient steps, but redrawing
+ * regions over and over leaves entries behind that nothing shows any
+ * more. When the palette fills up, one pass over the framebuffer finds
+ * the entries still in use and the rest are handed out again. Only if the
+ * screen really shows 256 colors does a new one map to the nearest entry.
+ */
+
+#ifndef LCD_FB_H
+#define LCD_FB_H
+
+#include <stdint.h>
+
+#define LCD_FB_WIDTH   320
+#define LCD_FB_HEIGHT  320
+#define LCD_FB_COLORS  256
+
+// Configure the interpolators for palette lookups
+void lcd_fb_init(void);
+
+// Forget all palette entries. Only safe before repainting the whole screen.
+void lcd_fb_reset_palette(void);
+
+// Give back the palette entries no pixel uses. Returns how many.
+int lcd_fb_reclaim_palette(void);
+
+// Palette index for an RGB888 color, allocating one if needed
+uint8_t lcd_fb_color_index(uint32_t color);
+
+// Drawing (already clipped to the screen)
+void lcd_fb_pixel(int x, int y, uint32_t color);
+void lcd_fb_fill(int x, int y, int w, int h, uint32_t color);
+
+// RGB888 color of a pixel
+uint32_t lcd_fb_get(int x, int y);
+
+// Expand rows y..y+h-1, columns x..x+w-1 to packed RGB888 in out
+void lcd_fb_expand(int x, int y, int w, int h, uint8_t* out);
+
+#endif // LCD_FB_H
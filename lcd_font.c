@@ -0,0 +1,98 @@
+/*
+ * Bitmap fonts
+ */
+
+#include "lcd_font.h"
+#include "lcd_glyph_atlas.h"
+
+uint32_t lcd_font_utf8(const char** s, const char* end) {
+    const uint8_t* p = (const uint8_t*)*s;
+    uint32_t c = p[0];
+    uint32_t min;
+    int n;
+    if (c >= 0xC2 && c <= 0xDF) { n = 1; c &= 0x1F; min = 0x80; }
+    else if (c >= 0xE0 && c <= 0xEF) { n = 2; c &= 0x0F; min = 0x800; }
+    else if (c >= 0xF0 && c <= 0xF4) { n = 3; c &= 0x07; min = 0x10000; }
+    else n = 0;
+    
+    if (n == 0 || end - *s <= n) {
+        (*s)++;
+        return LCD_FONT_REPLACEMENT;
+    }
+    for (int i = 1; i <= n; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            (*s)++;
+            return LCD_FONT_REPLACEMENT;
+        }
+        c = (c << 6) | (p[i] & 0x3F);
+    }
+    if (c < min || (c >= 0xD800 && c <= 0xDFFF) || c > 0x10FFFF) {
+        (*s)++;
+        return LCD_FONT_REPLACEMENT;
+    }
+    *s += n + 1;
+    return c;
+}
+
+const lcd_font_glyph_t* lcd_font_glyph(const lcd_font_t* font, uint32_t cp) {
+    // Every font starts with its ASCII run, which is nearly all text: one
+    // compare finds those, and the search covers the rest
+    const lcd_font_range_t* ascii = &font->ranges[0];
+    if (cp - ascii->first < ascii->count) {
+        return &font->glyphs[ascii->glyph + (cp - ascii->first)];
+    }
+    
+    int lo = 1, hi = font->num_ranges - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const lcd_font_range_t* r = &font->ranges[mid];
+        if (cp < r->first) {
+            hi = mid - 1;
+        } else if (cp >= r->first + r->count) {
+            lo = mid + 1;
+        } else {
+            return &font->glyphs[r->glyph + (cp - r->first)];
+        }
+    }
+    return &font->glyphs[font->missing];
+}
+
+int lcd_font_kerning(const lcd_font_t* font, uint32_t left, uint32_t right) {
+    if (font->num_kerns == 0 || left > 0xFFFF || right > 0xFFFF) return 0;
+    
+    uint32_t key = (left << 16) | right;
+    int lo = 0, hi = font->num_kerns - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        const lcd_font_kern_t* k = &font->kerns[mid];
+        uint32_t kkey = ((uint32_t)k->left << 16) | k->right;
+        if (key < kkey) {
+            hi = mid - 1;
+        } else if (key > kkey) {
+            lo = mid + 1;
+        } else {
+            return k->adjust;
+        }
+    }
+    return 0;
+}
+
+static const lcd_font_t* const lcd_font_registry[LCD_FONT_COUNT] = {
+    [LCD_FONT_5X7] = &lcd_glyph_atlas[0],
+    [LCD_FONT_8X8] = &lcd_font_8x8,
+    [LCD_FONT_12X16] = &lcd_font_12x16,
+};
+
+const lcd_font_t* lcd_font_get(lcd_font_id_t id) {
+    return lcd_font_registry[id];
+}
+
+// 2x has a real (anti-aliased) 12x16 font; the other scales use the 5x7 atlas, and
+// scales past the atlas repeat the 1x pixels
+const lcd_font_t* lcd_font_for_scale(int scale, int* repeat) {
+    *repeat = 1;
+    if (scale == 2) return lcd_font_get(LCD_FONT_12X16);
+    if (scale <= LCD_GLYPH_ATLAS_SCALES) return &lcd_glyph_atlas[scale - 1];
+    *repeat = scale;
+    return lcd_font_get(LCD_FONT_5X7);
+}
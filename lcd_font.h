@@ -0,0 +1,121 @@
+/*
+ * Bitmap fonts
+ *
+ * Fonts are generated C tables: font_compiler.py builds them from BDF
+ * sources and gen_glyph_atlas.py from font5x7. lcd_font_get names the
+ * ones built in; the text-run blitter (lcd_glyph.h) draws all of them. A glyph is a row-major
+ * bitmap (leftmost pixel in the top bits, rows padded to whole bytes)
+ * placed relative to the pen: the pen sits at the top left of a cell
+ * `height` rows tall and moves right by the glyph's advance. Bitmaps are
+ * stored back to back in code-point order.
+ *
+ * Glyphs are proportional: each has its own advance, and a font may list
+ * kerning pairs that move the pen between two particular glyphs.
+ *
+ * Glyphs are found by Unicode code point (text is UTF-8) through a sorted
+ * table of runs of consecutive code points, so a font can carry ASCII and
+ * a scattering of other characters without a slot for every code point
+ * in between.
+ *
+ * A pixel is `bpp` bits of alpha: 1bpp fonts are plain on/off, 2bpp and
+ * 4bpp ones carry anti-aliased edges. Readers see every font's alpha on
+ * the same 0..LCD_FONT_ALPHA_MAX scale.
+ *
+ * No hardware dependencies, so layout code on the host can measure text
+ * with the same tables the firmware draws it with.
+ */
+
+#ifndef LCD_FONT_H
+#define LCD_FONT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define LCD_FONT_ALPHA_MAX 15
+
+typedef struct {
+    uint32_t offset;        // first byte in lcd_font_t.bitmaps
+    uint8_t width;          // bitmap size; 0x0 for blank glyphs
+    uint8_t height;
+    int8_t x_offset;        // left edge, right of the pen
+    int8_t y_offset;        // top edge, below the top of the cell
+    uint8_t advance;
+} lcd_font_glyph_t;
+
+// Code points first..first+count-1 are glyphs glyph..glyph+count-1
+typedef struct {
+    uint32_t first;
+    uint16_t count;
+    uint16_t glyph;
+} lcd_font_range_t;
+
+// Pen adjustment between two code points
+typedef struct {
+    uint16_t left;
+    uint16_t right;
+    int8_t adjust;
+} lcd_font_kern_t;
+
+typedef struct {
+    uint8_t height;         // cell height; every glyph lies inside it
+    uint8_t ascent;         // baseline, in rows below the top of the cell
+    uint8_t bpp;            // bits per pixel: 1, 2 or 4
+    uint16_t missing;       // glyph drawn for code points the font lacks
+    uint16_t num_ranges;
+    uint16_t num_kerns;
+    const lcd_font_range_t* ranges;     // sorted by first
+    const lcd_font_glyph_t* glyphs;
+    const uint8_t* bitmaps;
+    const lcd_font_kern_t* kerns;       // sorted by left, then right; may be NULL
+} lcd_font_t;
+
+// The fonts the firmware carries; every text call draws with one of them
+typedef enum {
+    LCD_FONT_5X7,           // proportional 5x7, the UI font
+    LCD_FONT_8X8,           // monospace 8x8 terminal font
+    LCD_FONT_12X16,         // anti-aliased 12x16 for large text
+    LCD_FONT_COUNT
+} lcd_font_id_t;
+
+extern const lcd_font_t lcd_font_8x8;
+extern const lcd_font_t lcd_font_12x16;
+
+const lcd_font_t* lcd_font_get(lcd_font_id_t id);
+
+#define LCD_FONT_REPLACEMENT 0xFFFD    // decoded from malformed UTF-8
+
+// Code point of the multibyte UTF-8 sequence at *s, moving *s past it and
+// never reading at or past end. A malformed or truncated sequence (stray
+// continuation byte, overlong form, surrogate) decodes as
+// LCD_FONT_REPLACEMENT and skips one byte, so the next character still
+// comes out right.
+uint32_t lcd_font_utf8(const char** s, const char* end);
+
+// Glyph for a code point, or the font's missing glyph
+const lcd_font_glyph_t* lcd_font_glyph(const lcd_font_t* font, uint32_t cp);
+
+// Extra pen movement (usually negative) between left and right
+int lcd_font_kerning(const lcd_font_t* font, uint32_t left, uint32_t right);
+
+static inline const uint8_t* lcd_font_bitmap(const lcd_font_t* font, const lcd_font_glyph_t* glyph) {
+    return font->bitmaps + glyph->offset;
+}
+
+static inline int lcd_font_stride(const lcd_font_t* font, const lcd_font_glyph_t* glyph) {
+    return (glyph->width * font->bpp + 7) / 8;
+}
+
+// Alpha of pixel x of a bitmap row, 0..LCD_FONT_ALPHA_MAX
+static inline int lcd_font_alpha(const lcd_font_t* font, const uint8_t* row, int x) {
+    static const uint8_t steps[5] = { 0, 15, 5, 0, 1 };    // MAX / ((1 << bpp) - 1)
+    int bpp = font->bpp;
+    int bit = x * bpp;
+    int v = (row[bit >> 3] >> (8 - bpp - (bit & 7))) & ((1 << bpp) - 1);
+    return v * steps[bpp];
+}
+
+// Font the scaled text calls (draw_large_text, lcd_glyph_run) draw with at
+// `scale`, and how often each of its pixels is repeated
+const lcd_font_t* lcd_font_for_scale(int scale, int* repeat);
+
+#endif // LCD_FONT_H
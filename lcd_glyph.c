@@ -0,0 +1,353 @@
+/*
+ * Text-run blitter
+ *
+ * A run's glyphs are looked up once into lcd_glyph_cache along with their
+ * pen positions; every row of the run then reads the cached metrics.
+ *
+ * Glyph pixels are handled as alpha 0..LCD_FONT_ALPHA_MAX throughout, so
+ * 1bpp fonts (always 0 or the maximum) and anti-aliased ones share one
+ * path. Edge pixels of anti-aliased fonts are blended only where the
+ * color underneath is known: an opaque run's background, an outlined
+ * run's outline, or a band pixel. Elsewhere (transparent text sent
+ * straight to the panel) they are rounded to on or off, so the run costs
+ * the same fills as 1bpp text.
+ */
+
+#include "lcd_glyph.h"
+#include "lcd_font.h"
+#include "lcd_cmd.h"
+#include "lcd_band.h"
+#include "lcd_blend.h"
+#include <string.h>
+
+#define LCD_WIDTH  320
+#define LCD_HEIGHT 320
+
+// Glyphs resolved per run. More than fit across the screen in any font;
+// anything past them is off the right edge.
+#define LCD_GLYPH_MAX_RUN 128
+
+extern const lcd_bus_t* lcd_bus;
+extern void lcd_set_window(int x0, int y0, int x1, int y1);
+extern void lcd_fill_rect(int x, int y, int w, int h, uint32_t color);
+
+// One row of an opaque run, RGB888
+static uint8_t lcd_glyph_line[LCD_WIDTH * 3];
+
+// The run being drawn
+static const lcd_font_t* lcd_glyph_font;
+static int lcd_glyph_repeat;        // screen pixels per font pixel
+static int lcd_glyph_count;
+static const lcd_font_glyph_t* lcd_glyph_cache[LCD_GLYPH_MAX_RUN];
+static int lcd_glyph_pen[LCD_GLYPH_MAX_RUN];   // font pixels right of the run's x
+static bool lcd_glyph_smooth;       // partial alpha can be blended
+
+// Look up the run's glyphs; returns its width in screen pixels
+static int lcd_glyph_resolve(const lcd_font_t* font, int repeat, const char* str, int len, int flags) {
+    lcd_glyph_font = font;
+    lcd_glyph_repeat = repeat;
+    lcd_glyph_count = 0;
+    
+    const char* end = str + len;
+    uint32_t prev = 0;
+    int pen = 0;
+    while (str < end) {
+        uint32_t cp = lcd_glyph_decode(&str, end, flags);
+        if (prev) pen += lcd_font_kerning(lcd_glyph_font, prev, cp);
+        prev = cp;
+    
+        const lcd_font_glyph_t* glyph = lcd_font_glyph(lcd_glyph_font, cp);
+        if (lcd_glyph_count < LCD_GLYPH_MAX_RUN) {
+            lcd_glyph_cache[lcd_glyph_count] = glyph;
+            lcd_glyph_pen[lcd_glyph_count] = pen;
+            lcd_glyph_count++;
+        }
+        pen += glyph->advance;
+    }
+    return pen * lcd_glyph_repeat;
+}
+
+// Alpha of pixel x of a glyph row as it will be drawn
+static inline int lcd_glyph_alpha(const uint8_t* row, int x) {
+    int alpha = lcd_font_alpha(lcd_glyph_font, row, x);
+    if (lcd_glyph_smooth) return alpha;
+    return alpha > LCD_FONT_ALPHA_MAX / 2 ? LCD_FONT_ALPHA_MAX : 0;
+}
+
+// Blend a span of edge pixels into the band, each against what is there.
+// Over one background the span takes one color from that pair's table:
+// one already cached, or a new one if the span is big enough to pay for
+// building it. Over anything else (a gradient) each pixel is blended on
+// its own and the cache is left alone.
+static void lcd_glyph_blend(int x, int y, int w, int h, uint32_t fg, int alpha) {
+    uint32_t bg = 0;
+    bool seen = false;
+    bool flat = true;
+    for (int py = y; py < y + h && flat; py++) {
+        if (lcd_band_rows_hidden(py, 1)) continue;
+        if (!seen) bg = lcd_band_get(x, py);
+        seen = true;
+        for (int px = x; px < x + w && flat; px++) flat = lcd_band_get(px, py) == bg;
+    }
+    if (!seen) return;
+    
+    const uint32_t* lut = NULL;
+    if (flat) {
+        lut = lcd_blend_lut_cached(fg, bg);
+        if (!lut && w * h >= LCD_BLEND_STEPS) lut = lcd_blend_lut(fg, bg);
+    }
+    
+    for (int py = y; py < y + h; py++) {
+        if (lcd_band_rows_hidden(py, 1)) continue;
+        for (int px = x; px < x + w; px++) {
+            uint32_t c = lut ? lut[alpha] : lcd_blend_color(fg, lcd_band_get(px, py), alpha);
+            lcd_band_pixel(px, py, c);
+        }
+    }
+}
+
+// Lit pixels only: one fill per horizontal span of equal alpha, stretched
+// over all the identical rows below it (a 2x glyph row is two equal atlas
+// rows)
+static void lcd_glyph_spans(int x, int y, uint32_t fg) {
+    int repeat = lcd_glyph_repeat;
+    
+    for (int i = 0; i < lcd_glyph_count; i++) {
+        const lcd_font_glyph_t* glyph = lcd_glyph_cache[i];
+        int gx = x + (lcd_glyph_pen[i] + glyph->x_offset) * repeat;
+        int gy = y + glyph->y_offset * repeat;
+        if (glyph->width == 0) continue;
+        if (lcd_band_rect_hidden(gx, gy, glyph->width * repeat, glyph->height * repeat)) continue;
+    
+        const uint8_t* bitmap = lcd_font_bitmap(lcd_glyph_font, glyph);
+        int stride = lcd_font_stride(lcd_glyph_font, glyph);
+    
+        int row = 0;
+        while (row < glyph->height) {
+            const uint8_t* bits = bitmap + row * stride;
+            int rows = 1;
+            while (row + rows < glyph->height &&
+                   memcmp(bits, bits + rows * stride, stride) == 0) {
+                rows++;
+            }
+    
+            int col = 0;
+            while (col < glyph->width) {
+                int alpha = lcd_glyph_alpha(bits, col);
+                if (alpha == 0) {
+                    col++;
+                    continue;
+                }
+                int start = col;
+                while (col < glyph->width && lcd_glyph_alpha(bits, col) == alpha) col++;
+    
+                int sx = gx + start * repeat;
+                int sy = gy + row * repeat;
+                int sw = (col - start) * repeat;
+                if (alpha == LCD_FONT_ALPHA_MAX) lcd_fill_rect(sx, sy, sw, rows * repeat, fg);
+                else lcd_glyph_blend(sx, sy, sw, rows * repeat, fg, alpha);
+            }
+            row += rows;
+        }
+    }
+}
+
+// Alpha of font row `row` of the run, one byte per screen column x0..x1-1
+static void lcd_glyph_mask(int x, int x0, int x1, int row, uint8_t* out) {
+    int repeat = lcd_glyph_repeat;
+    memset(out, 0, x1 - x0);
+    
+    for (int i = 0; i < lcd_glyph_count; i++) {
+        const lcd_font_glyph_t* glyph = lcd_glyph_cache[i];
+        int gx = x + (lcd_glyph_pen[i] + glyph->x_offset) * repeat;
+        int r = row - glyph->y_offset;
+        if (r < 0 || r >= glyph->height) continue;
+        if (gx >= x1) continue;
+        if (gx + glyph->width * repeat <= x0) continue;
+    
+        const uint8_t* bits = lcd_font_bitmap(lcd_glyph_font, glyph) + r * lcd_font_stride(lcd_glyph_font, glyph);
+        for (int col = 0; col < glyph->width; col++) {
+            int alpha = lcd_glyph_alpha(bits, col);
+            if (alpha == 0) continue;
+            int px = gx + col * repeat;
+            for (int k = 0; k < repeat; k++, px++) {
+                if (px >= x0 && px < x1) out[px - x0] = alpha;
+            }
+        }
+    }
+}
+
+// Expand font row `row` of the run into lcd_glyph_line for columns x0..x1-1
+static void lcd_glyph_expand(int x, int x0, int x1, int row, uint32_t fg, uint32_t bg) {
+    const uint32_t* lut = lcd_blend_lut(fg, bg);
+    
+    // The mask goes in the back third of the line, which the RGB output
+    // only reaches once each mask byte has been read
+    uint8_t* mask = lcd_glyph_line + (x1 - x0) * 2;
+    lcd_glyph_mask(x, x0, x1, row, mask);
+    
+    uint8_t* p = lcd_glyph_line;
+    for (int i = 0; i < x1 - x0; i++) {
+        uint32_t c = lut[mask[i]];
+        p[0] = c >> 16;
+        p[1] = c >> 8;
+        p[2] = c;
+        p += 3;
+    }
+}
+
+static void lcd_glyph_draw(const lcd_font_t* font, int repeat, int x, int y,
+                           const char* str, int len, uint32_t fg, uint32_t bg, int flags) {
+    if (len <= 0) return;
+    
+    int w = lcd_glyph_resolve(font, repeat, str, len, flags);
+    int h = lcd_glyph_font->height * lcd_glyph_repeat;
+    
+    // An opaque run blends against its own background
+    lcd_glyph_smooth = bg != LCD_GLYPH_NO_BG || lcd_band_active();
+    
+    // Bands are plain memory: fill the cells, then set the lit spans
+    if (bg == LCD_GLYPH_NO_BG || lcd_band_active()) {
+        if (bg != LCD_GLYPH_NO_BG) {
+            // Every edge pixel is over bg: have its table ready
+            lcd_fill_rect(x, y, w, h, bg);
+            lcd_blend_lut(fg, bg);
+        }
+        lcd_glyph_spans(x, y, fg);
+        return;
+    }
+    
+    int x0 = x < 0 ? 0 : x;
+    int y0 = y < 0 ? 0 : y;
+    int x1 = x + w > LCD_WIDTH ? LCD_WIDTH : x + w;
+    int y1 = y + h > LCD_HEIGHT ? LCD_HEIGHT : y + h;
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    lcd_set_window(x0, y0, x1 - 1, y1 - 1);
+    
+    // Each font row is expanded once and sent `repeat` times
+    for (int py = y0; py < y1; py++) {
+        if (py == y0 || (py - y) % lcd_glyph_repeat == 0) {
+            lcd_glyph_expand(x, x0, x1, (py - y) / lcd_glyph_repeat, fg, bg);
+        }
+        lcd_bus->write(lcd_glyph_line, (x1 - x0) * 3);
+    }
+    
+    lcd_bus->select(false);
+}
+
+void lcd_glyph_run(int x, int y, const char* str, int len, int scale,
+                   uint32_t fg, uint32_t bg, int flags) {
+    if (scale <= 0) return;
+    
+    int repeat;
+    const lcd_font_t* font = lcd_font_for_scale(scale, &repeat);
+    lcd_glyph_draw(font, repeat, x, y, str, len, fg, bg, flags);
+}
+
+void lcd_glyph_run_font(const lcd_font_t* font, int x, int y, const char* str, int len,
+                        uint32_t fg, uint32_t bg, int flags) {
+    lcd_glyph_draw(font, 1, x, y, str, len, fg, bg, flags);
+}
+
+// Pixel classes of an outlined run. A lit pixel's class is
+// LCD_GLYPH_OUTLINE plus its alpha, since its edge blends into the
+// outline.
+enum {
+    LCD_GLYPH_CLEAR,        // untouched
+    LCD_GLYPH_OUTLINE,      // next to a lit pixel
+};
+
+// Alpha masks of three consecutive rows, each with a spare column on both
+// sides, and the classes of the row being emitted and the one before it
+static uint8_t lcd_glyph_masks[3][LCD_WIDTH + 2];
+static uint8_t lcd_glyph_classes[2][LCD_WIDTH];
+
+static void lcd_glyph_emit(const uint8_t* classes, int n, int x0, int y, int rows,
+                           uint32_t fg, uint32_t outline) {
+    const uint32_t* lut = lcd_blend_lut(fg, outline);
+    int i = 0;
+    while (i < n) {
+        uint8_t c = classes[i];
+        int start = i;
+        while (i < n && classes[i] == c) i++;
+        if (c != LCD_GLYPH_CLEAR) {
+            lcd_fill_rect(x0 + start, y, i - start, rows, lut[c - LCD_GLYPH_OUTLINE]);
+        }
+    }
+}
+
+// Mask of screen row py of a run h rows tall, for columns x0..x1-1
+static void lcd_glyph_mask_row(int x, int y, int h, int x0, int x1, int py, uint8_t* out) {
+    if (py < y || py >= y + h) memset(out, 0, x1 - x0);
+    else lcd_glyph_mask(x, x0, x1, (py - y) / lcd_glyph_repeat, out);
+}
+
+void lcd_glyph_run_outlined(int x, int y, const char* str, int len, int scale,
+                            uint32_t fg, uint32_t outline, int flags) {
+    if (len <= 0 || scale <= 0) return;
+    
+    int repeat;
+    const lcd_font_t* font = lcd_font_for_scale(scale, &repeat);
+    int w = lcd_glyph_resolve(font, repeat, str, len, flags);
+    int h = lcd_glyph_font->height * lcd_glyph_repeat;
+    
+    // Blended edges split the fills into more windows, except in a band
+    lcd_glyph_smooth = lcd_band_active();
+    
+    // The outline reaches one pixel past the glyphs on every side
+    int x0 = x - 1 < 0 ? 0 : x - 1;
+    int y0 = y - 1 < 0 ? 0 : y - 1;
+    int x1 = x + w + 1 > LCD_WIDTH ? LCD_WIDTH : x + w + 1;
+    int y1 = y + h + 1 > LCD_HEIGHT ? LCD_HEIGHT : y + h + 1;
+    while (y0 < y1 && lcd_band_rows_hidden(y0, 1)) y0++;
+    while (y1 > y0 && lcd_band_rows_hidden(y1 - 1, 1)) y1--;
+    if (x0 >= x1 || y0 >= y1) return;
+    
+    int n = x1 - x0;
+    
+    // Masks cover columns x0-1..x1, so a glyph clipped off the screen
+    // still outlines the edge column
+    uint8_t* above = lcd_glyph_masks[0];
+    uint8_t* cur = lcd_glyph_masks[1];
+    uint8_t* below = lcd_glyph_masks[2];
+    lcd_glyph_mask_row(x, y, h, x0 - 1, x1 + 1, y0 - 1, above);
+    lcd_glyph_mask_row(x, y, h, x0 - 1, x1 + 1, y0, cur);
+    
+    int prev = 0;
+    int span_y = y0;
+    int span_rows = 0;
+    
+    for (int py = y0; py < y1; py++) {
+        lcd_glyph_mask_row(x, y, h, x0 - 1, x1 + 1, py + 1, below);
+    
+        uint8_t* classes = lcd_glyph_classes[prev ^ 1];
+        for (int i = 0; i < n; i++) {
+            if (cur[i + 1]) {
+                classes[i] = LCD_GLYPH_OUTLINE + cur[i + 1];
+            } else {
+                bool near = above[i] | above[i + 1] | above[i + 2] |
+                            cur[i] | cur[i + 2] |
+                            below[i] | below[i + 1] | below[i + 2];
+                classes[i] = near ? LCD_GLYPH_OUTLINE : LCD_GLYPH_CLEAR;
+            }
+        }
+    
+        // Identical rows go out as one taller span
+        if (span_rows > 0 && memcmp(classes, lcd_glyph_classes[prev], n) == 0) {
+            span_rows++;
+        } else {
+            if (span_rows > 0) lcd_glyph_emit(lcd_glyph_classes[prev], n, x0, span_y, span_rows, fg, outline);
+            prev ^= 1;
+            span_y = py;
+            span_rows = 1;
+        }
+    
+        uint8_t* t = above;
+        above = cur;
+        cur = below;
+        below = t;
+    }
+    
+    lcd_glyph_emit(lcd_glyph_classes[prev], n, x0, span_y, span_rows, fg, outline);
+}
@@ -0,0 +1,68 @@
+/*
+ * Text-run blitter
+ *
+ * A run is a UTF-8 string of glyphs on one line, drawn in the font
+ * lcd_font_for_scale picks for the scale: the 5x7 atlas, or the 12x16
+ * font at 2x. The run's box is the sum of the advances wide and the
+ * font's cell height tall. Glyphs are placed by their advances and the
+ * font's kerning pairs, exactly as lcd_metrics.h measures them.
+ *
+ * With a background color the whole box is opaque: each row is expanded
+ * into a line buffer, foreground and background together, and the box
+ * goes out in a single window and RAMWR burst. Without one only the lit
+ * pixels may be touched, so every horizontal span of a glyph row becomes
+ * one fill instead of one window per pixel. Inside a band render both
+ * cases draw into the band.
+ *
+ * The 12x16 font is anti-aliased. Its edge pixels are blended (through
+ * the cached tables of lcd_blend.h) into the background of an opaque run,
+ * the outline of an outlined one, and whatever is already in the band;
+ * transparent text drawn straight to the panel rounds them to on or off.
+ * Either way a run sends no more than the same text in a 1bpp font.
+ */
+
+#ifndef LCD_GLYPH_H
+#define LCD_GLYPH_H
+
+#include "lcd_font.h"
+#include <stdint.h>
+
+#define LCD_GLYPH_NO_BG   0xFFFFFFFF   // transparent: leave unlit pixels alone
+
+// Run flags
+#define LCD_GLYPH_UPPER   0x01         // fold a-z and Latin-1 letters to upper case
+
+// Code point drawn for the UTF-8 character at *s, moving *s past it and
+// never reading at or past end (see lcd_font_utf8)
+static inline uint32_t lcd_glyph_decode(const char** s, const char* end, int flags) {
+    uint32_t c = (uint8_t)**s;
+    if (c < 0x80) (*s)++;
+    else c = lcd_font_utf8(s, end);
+    
+    if (flags & LCD_GLYPH_UPPER) {
+        if (c >= 'a' && c <= 'z') c -= 32;
+        else if (c >= 0xE0 && c <= 0xFE && c != 0xF7) c -= 32;
+    }
+    return c;
+}
+
+// Draw the first len bytes of str with the top left of the run at
+// (x, y). Characters the font does not have get its missing glyph (a
+// blank cell); '\n' is not interpreted.
+void lcd_glyph_run(int x, int y, const char* str, int len, int scale,
+                   uint32_t fg, uint32_t bg, int flags);
+
+// Same run in a font of the registry (lcd_font_get) at its own size,
+// rather than the one lcd_font_for_scale picks
+void lcd_glyph_run_font(const lcd_font_t* font, int x, int y, const char* str, int len,
+                        uint32_t fg, uint32_t bg, int flags);
+
+// Same run with a one pixel outline: every unlit pixel next to a lit one
+// (including diagonally) is set to the outline color, and only lit and
+// outline pixels are touched. Both are drawn in a single pass, one fill
+// per span, with the same result as drawing the text in the outline color
+// at the eight surrounding offsets and then in fg on top.
+void lcd_glyph_run_outlined(int x, int y, const char* str, int len, int scale,
+                            uint32_t fg, uint32_t outline, int flags);
+
+#endif // LCD_GLYPH_H
@@ -0,0 +1,21 @@
+/*
+ * Pre-scaled 5x7 glyph atlas
+ *
+ * font5x7 expanded at build time (gen_glyph_atlas.py) to every scale the
+ * UI draws text at, so the blitter never scales a glyph at run time. Each
+ * scale is a proportional lcd_font_t covering FONT5X7_FIRST onwards: a
+ * glyph is its inked columns times the scale, full height, and advances
+ * one more column; kerning pairs close up a few pairs such as "LT".
+ */
+
+#ifndef LCD_GLYPH_ATLAS_H
+#define LCD_GLYPH_ATLAS_H
+
+#include "lcd_font.h"
+#include "font5x7.h"
+
+#define LCD_GLYPH_ATLAS_SCALES 4   // 1x..4x; index is scale - 1
+
+extern const lcd_font_t lcd_glyph_atlas[LCD_GLYPH_ATLAS_SCALES];
+
+#endif // LCD_GLYPH_ATLAS_H
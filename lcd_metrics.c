@@ -0,0 +1,103 @@
+/*
+ * Text metrics and line breaking
+ */
+
+#include "lcd_metrics.h"
+#include "lcd_font.h"
+#include "lcd_glyph.h"
+#include <string.h>
+
+typedef struct {
+    char text[LCD_METRICS_CACHE_TEXT];
+    uint8_t scale;
+    uint8_t flags;
+    int16_t width;
+} lcd_metrics_entry_t;
+
+// Direct-mapped by a hash of the string
+static lcd_metrics_entry_t lcd_metrics_cache[LCD_METRICS_CACHE_SIZE];
+
+int lcd_metrics_font_width(const lcd_font_t* font, const char* str, int len, int flags) {
+    const char* end = str + len;
+    uint32_t prev = 0;
+    int pen = 0;
+    while (str < end) {
+        uint32_t cp = lcd_glyph_decode(&str, end, flags);
+        if (prev) pen += lcd_font_kerning(font, prev, cp);
+        prev = cp;
+        pen += lcd_font_glyph(font, cp)->advance;
+    }
+    return pen;
+}
+
+int lcd_metrics_width(const char* str, int len, int scale, int flags) {
+    int repeat;
+    const lcd_font_t* font = lcd_font_for_scale(scale, &repeat);
+    return lcd_metrics_font_width(font, str, len, flags) * repeat;
+}
+
+int lcd_metrics_width_cached(const char* str, int scale, int flags) {
+    // Hashing costs one multiply a byte; measuring looks up every glyph
+    // and kerning pair
+    uint32_t hash = 2166136261u;
+    int len = 0;
+    for (; str[len]; len++) {
+        hash = (hash ^ (uint8_t)str[len]) * 16777619u;
+    }
+    if (len >= LCD_METRICS_CACHE_TEXT) return lcd_metrics_width(str, len, scale, flags);
+    
+    lcd_metrics_entry_t* e = &lcd_metrics_cache[(hash ^ scale) % LCD_METRICS_CACHE_SIZE];
+    if (e->scale == scale && e->flags == flags && memcmp(e->text, str, len + 1) == 0) {
+        return e->width;
+    }
+    
+    memcpy(e->text, str, len + 1);
+    e->scale = scale;
+    e->flags = flags;
+    e->width = lcd_metrics_width(str, len, scale, flags);
+    return e->width;
+}
+
+// Length of str[0..len) without its trailing spaces
+static int lcd_metrics_trim(const char* str, int len) {
+    while (len > 0 && str[len - 1] == ' ') len--;
+    return len;
+}
+
+int lcd_metrics_wrap(const char* str, int len, int scale, int flags, int max_width, int* next) {
+    int repeat;
+    const lcd_font_t* font = lcd_font_for_scale(scale, &repeat);
+    
+    const char* s = str;
+    const char* end = str + len;
+    const char* space = NULL;       // last space that fit
+    uint32_t prev = 0;
+    int pen = 0;
+    
+    while (s < end) {
+        if (*s == '\n') {
+            *next = s + 1 - str;
+            return lcd_metrics_trim(str, s - str);
+        }
+    
+        const char* start = s;
+        uint32_t cp = lcd_glyph_decode(&s, end, flags);
+        int width = pen + (prev ? lcd_font_kerning(font, prev, cp) : 0) + lcd_font_glyph(font, cp)->advance;
+    
+        if (width * repeat > max_width && start > str) {
+            // Break at this space, the last one that fit, or mid-word
+            const char* cut = cp == ' ' ? start : (space ? space : start);
+            const char* resume = cut;
+            while (resume < end && *resume == ' ') resume++;
+            *next = resume - str;
+            return lcd_metrics_trim(str, cut - str);
+        }
+    
+        if (cp == ' ') space = start;
+        pen = width;
+        prev = cp;
+    }
+    
+    *next = len;
+    return len;
+}
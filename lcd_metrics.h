@@ -0,0 +1,41 @@
+/*
+ * Text metrics and line breaking
+ *
+ * Widths come from the per-glyph advances and kerning pairs of the font
+ * lcd_font_for_scale picks, the same numbers the text-run blitter places
+ * glyphs with, so a measured run is exactly as wide as the drawn one. A
+ * run's width is where the pen ends up after its last glyph, that glyph's
+ * advance included. Strings and flags are the ones lcd_glyph_run takes.
+ *
+ * No hardware dependencies, so layout can be checked on the host.
+ */
+
+#ifndef LCD_METRICS_H
+#define LCD_METRICS_H
+
+#include "lcd_font.h"
+#include <stdint.h>
+
+#define LCD_METRICS_CACHE_SIZE  16
+#define LCD_METRICS_CACHE_TEXT  32     // longest cached string, NUL included
+
+// Width in screen pixels of the first len bytes of str
+int lcd_metrics_width(const char* str, int len, int scale, int flags);
+
+// Width of the first len bytes of str in a font of the registry, drawn at
+// its own size (lcd_glyph_run_font)
+int lcd_metrics_font_width(const lcd_font_t* font, const char* str, int len, int flags);
+
+// Width of a whole string, remembered for strings that come back on
+// every repaint (titles, categories). The cache is keyed by content, so
+// any buffer may be passed; longer strings are simply measured.
+int lcd_metrics_width_cached(const char* str, int scale, int flags);
+
+// Break str[0..len) into lines max_width pixels wide. Returns how many
+// bytes of it go on the first line and sets *next to where the second
+// starts. Lines end at '\n' or after the last space that fits; a word
+// wider than a whole line is split, and every line takes at least one
+// character. Spaces at a wrap are dropped from both lines.
+int lcd_metrics_wrap(const char* str, int len, int scale, int flags, int max_width, int* next);
+
+#endif // LCD_METRICS_H
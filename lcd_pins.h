@@ -0,0 +1,19 @@
+/*
+ * PicoCalc LCD wiring
+ *
+ * The Pico pins the ILI9488 is on, for every file that drives them
+ * (spi1 or the PIO transport, and the DMA fills that raise CS).
+ */
+
+#ifndef LCD_PINS_H
+#define LCD_PINS_H
+
+#define LCD_CS     13
+#define LCD_SCK    10
+#define LCD_MOSI   11
+#define LCD_MISO   12
+#define LCD_DC     14
+#define LCD_RST    15
+#define LCD_BL     5
+
+#endif // LCD_PINS_H
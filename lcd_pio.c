@@ -0,0 +1,110 @@
+/*
+ * PIO transport for the ILI9488 (build with LCD_USE_PIO)
+ *
+ * Bytes written through lcd_pio_bus are tagged with the current DC level
+ * into a staging buffer, and a DMA channel moves each buffer into the
+ * state machine while the CPU tags the next one.
+ */
+
+#include "lcd_pio.h"
+#include "lcd_dma.h"
+#include "lcd_pins.h"
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+#include "hardware/dma.h"
+#include "lcd_pio.pio.h"
+
+#define LCD_PIO_STAGE_UNITS 512
+
+static PIO lcd_pio = pio0;
+static uint lcd_pio_sm;
+static uint lcd_pio_offset;
+static int lcd_pio_dma_chan;
+
+static uint16_t lcd_pio_stage[2][LCD_PIO_STAGE_UNITS];
+static int lcd_pio_stage_idx = 0;
+static bool lcd_pio_dc = true;
+
+void lcd_pio_init(void) {
+    lcd_pio_sm = pio_claim_unused_sm(lcd_pio, true);
+    lcd_pio_offset = pio_add_program(lcd_pio, &lcd_tagged_program);
+    lcd_tagged_program_init(lcd_pio, lcd_pio_sm, lcd_pio_offset,
+                            LCD_SCK, LCD_MOSI, LCD_CS, LCD_PIO_SPEED);
+    
+    // 16-bit writes into the 32-bit TXF: the RP2040 bus replicates a
+    // narrow write across the whole word, so the unit lands in the top
+    // half the state machine reads (lcd_pio_put has to shift it there)
+    lcd_pio_dma_chan = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config(lcd_pio_dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, lcd_pio_dreq());
+    dma_channel_configure(lcd_pio_dma_chan, &c, lcd_pio_txf(), NULL, 0, false);
+}
+
+volatile void* lcd_pio_txf(void) {
+    return &lcd_pio->txf[lcd_pio_sm];
+}
+
+unsigned lcd_pio_dreq(void) {
+    return pio_get_dreq(lcd_pio, lcd_pio_sm, true);
+}
+
+void lcd_pio_put(uint16_t unit) {
+    // The state machine reads the top half of the word
+    pio_sm_put_blocking(lcd_pio, lcd_pio_sm, (uint32_t)unit << 16);
+}
+
+void lcd_pio_wait_dma(void) {
+    dma_channel_wait_for_finish_blocking(lcd_pio_dma_chan);
+}
+
+void lcd_pio_wait_idle(void) {
+    lcd_pio_wait_dma();
+    while (!pio_sm_is_tx_fifo_empty(lcd_pio, lcd_pio_sm)) {
+        tight_loop_contents();
+    }
+    // Empty FIFO and parked on the pull: the last byte is out
+    while (pio_sm_get_pc(lcd_pio, lcd_pio_sm) != lcd_pio_offset + lcd_tagged_offset_start) {
+        tight_loop_contents();
+    }
+}
+
+static void lcd_pio_bus_select(bool selected) {
+    if (selected) {
+        // CS drops with the first byte; just let a pending fill finish
+        lcd_dma_wait();
+    } else {
+        dma_channel_wait_for_finish_blocking(lcd_pio_dma_chan);
+        lcd_pio_put(LCD_TAG_END);
+        lcd_pio_wait_idle();
+    }
+}
+
+static void lcd_pio_bus_set_dc(bool data) {
+    lcd_pio_dc = data;
+}
+
+static void lcd_pio_bus_write(const uint8_t* buf, size_t len) {
+    uint16_t tag = lcd_pio_dc ? LCD_TAG_DATA : 0;
+    
+    while (len > 0) {
+        size_t n = len < LCD_PIO_STAGE_UNITS ? len : LCD_PIO_STAGE_UNITS;
+        uint16_t* stage = lcd_pio_stage[lcd_pio_stage_idx];
+        
+        // Tag into the free buffer while DMA drains the other one
+        for (size_t i = 0; i < n; i++) {
+            stage[i] = tag | LCD_TAG_BYTE(buf[i]);
+        }
+        
+        dma_channel_wait_for_finish_blocking(lcd_pio_dma_chan);
+        dma_channel_transfer_from_buffer_now(lcd_pio_dma_chan, stage, n);
+        
+        lcd_pio_stage_idx ^= 1;
+        buf += n;
+        len -= n;
+    }
+}
+
+const lcd_bus_t lcd_pio_bus = { lcd_pio_bus_select, lcd_pio_bus_set_dc, lcd_pio_bus_write };
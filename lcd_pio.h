@@ -0,0 +1,38 @@
+/*
+ * PIO transport for the ILI9488 (build with LCD_USE_PIO)
+ *
+ * Replaces spi1 + GPIO DC/CS with a state machine that takes the tagged
+ * unit stream from lcd_cmd.h, so DC and CS switching costs no CPU time
+ * and DMA can feed the panel end to end.
+ */
+
+#ifndef LCD_PIO_H
+#define LCD_PIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "lcd_cmd.h"
+
+// SCK rate; the spi1 path is limited to LCD_SPI_SPEED
+#define LCD_PIO_SPEED 40000000
+
+// Bus callbacks for lcd_cmd_flush and pixel streaming
+extern const lcd_bus_t lcd_pio_bus;
+
+void lcd_pio_init(void);
+
+// TX FIFO address and DREQ for DMA channels feeding tagged units
+volatile void* lcd_pio_txf(void);
+unsigned lcd_pio_dreq(void);
+
+// Push one tagged unit from the CPU
+void lcd_pio_put(uint16_t unit);
+
+// Wait until the transport's DMA has handed its last unit to the FIFO,
+// before another channel starts feeding the same FIFO
+void lcd_pio_wait_dma(void);
+
+// Wait until every queued unit has been clocked out
+void lcd_pio_wait_idle(void);
+
+#endif // LCD_PIO_H
@@ -17,19 +17,32 @@
 
 #include "dont_panic_image.h"
 #include "enhanced_display.h"
-
-
-// Display pins - CORRECTED for PicoCalc
+#include "lcd_pins.h"
+#include "lcd_dma.h"
+#include "lcd_cmd.h"
+#include "lcd_band.h"
+#include "lcd_damage.h"
+#include "lcd_dl.h"
+#include "lcd_glyph.h"
+#include "lcd_metrics.h"
+#include "article_reader.h"
+#include "lcd_anim.h"
+#include "articles.h"
+#include "article_pack.h"
+
+#ifdef LCD_USE_PIO
+#include "lcd_pio.h"
+#endif
+#ifdef LCD_USE_FRAMEBUFFER
+#include "lcd_fb.h"
+#endif
+
+
+// Display - pins CORRECTED for PicoCalc in lcd_pins.h
 #define LCD_WIDTH  320
 #define LCD_HEIGHT 320
-#define LCD_CS     13
-#define LCD_SCK    10
-#define LCD_MOSI   11
-#define LCD_MISO   12
-#define LCD_DC     14
-#define LCD_RST    15
-#define LCD_BL     5
 #define LCD_SPI_SPEED 25000000
+#define LCD_MEM_ROWS  480   // ILI9488 frame memory; rows past LCD_HEIGHT are off-panel
 
 // Keyboard I2C - CORRECTED from i2ckbd.h
 #define KBD_I2C    i2c1       // i2c1, not i2c0!
@@ -53,201 +66,8 @@
 #define COLOR_LILAC    0xB05BC0
 
 
-// Simple font (5x7)
-const uint8_t font5x7[96][5] = {
-    {0x00, 0x00, 0x00, 0x00, 0x00}, // Space
-    {0x00, 0x00, 0x5F, 0x00, 0x00}, // !
-    {0x00, 0x07, 0x00, 0x07, 0x00}, // "
-    {0x14, 0x7F, 0x14, 0x7F, 0x14}, // #
-    {0x24, 0x2A, 0x7F, 0x2A, 0x12}, // $
-    {0x23, 0x13, 0x08, 0x64, 0x62}, // %
-    {0x36, 0x49, 0x55, 0x22, 0x50}, // &
-    {0x00, 0x05, 0x03, 0x00, 0x00}, // '
-    {0x00, 0x1C, 0x22, 0x41, 0x00}, // (
-    {0x00, 0x41, 0x22, 0x1C, 0x00}, // )
-    {0x08, 0x2A, 0x1C, 0x2A, 0x08}, // *
-    {0x08, 0x08, 0x3E, 0x08, 0x08}, // +
-    {0x00, 0x50, 0x30, 0x00, 0x00}, // ,
-    {0x08, 0x08, 0x08, 0x08, 0x08}, // -
-    {0x00, 0x60, 0x60, 0x00, 0x00}, // .
-    {0x20, 0x10, 0x08, 0x04, 0x02}, // /
-    {0x3E, 0x51, 0x49, 0x45, 0x3E}, // 0
-    {0x00, 0x42, 0x7F, 0x40, 0x00}, // 1
-    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2
-    {0x21, 0x41, 0x45, 0x4B, 0x31}, // 3
-    {0x18, 0x14, 0x12, 0x7F, 0x10}, // 4
-    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5
-    {0x3C, 0x4A, 0x49, 0x49, 0x30}, // 6
-    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7
-    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8
-    {0x06, 0x49, 0x49, 0x29, 0x1E}, // 9
-    {0x00, 0x36, 0x36, 0x00, 0x00}, // :
-    {0x00, 0x56, 0x36, 0x00, 0x00}, // ;
-    {0x00, 0x08, 0x14, 0x22, 0x41}, // <
-    {0x14, 0x14, 0x14, 0x14, 0x14}, // =
-    {0x41, 0x22, 0x14, 0x08, 0x00}, // >
-    {0x02, 0x01, 0x51, 0x09, 0x06}, // ?
-    {0x32, 0x49, 0x79, 0x41, 0x3E}, // @
-    {0x7E, 0x11, 0x11, 0x11, 0x7E}, // A
-    {0x7F, 0x49, 0x49, 0x49, 0x36}, // B
-    {0x3E, 0x41, 0x41, 0x41, 0x22}, // C
-    {0x7F, 0x41, 0x41, 0x22, 0x1C}, // D
-    {0x7F, 0x49, 0x49, 0x49, 0x41}, // E
-    {0x7F, 0x09, 0x09, 0x01, 0x01}, // F
-    {0x3E, 0x41, 0x41, 0x51, 0x32}, // G
-    {0x7F, 0x08, 0x08, 0x08, 0x7F}, // H
-    {0x00, 0x41, 0x7F, 0x41, 0x00}, // I
-    {0x20, 0x40, 0x41, 0x3F, 0x01}, // J
-    {0x7F, 0x08, 0x14, 0x22, 0x41}, // K
-    {0x7F, 0x40, 0x40, 0x40, 0x40}, // L
-    {0x7F, 0x02, 0x04, 0x02, 0x7F}, // M
-    {0x7F, 0x04, 0x08, 0x10, 0x7F}, // N
-    {0x3E, 0x41, 0x41, 0x41, 0x3E}, // O
-    {0x7F, 0x09, 0x09, 0x09, 0x06}, // P
-    {0x3E, 0x41, 0x51, 0x21, 0x5E}, // Q
-    {0x7F, 0x09, 0x19, 0x29, 0x46}, // R
-    {0x46, 0x49, 0x49, 0x49, 0x31}, // S
-    {0x01, 0x01, 0x7F, 0x01, 0x01}, // T
-    {0x3F, 0x40, 0x40, 0x40, 0x3F}, // U
-    {0x1F, 0x20, 0x40, 0x20, 0x1F}, // V
-    {0x7F, 0x20, 0x18, 0x20, 0x7F}, // W
-    {0x63, 0x14, 0x08, 0x14, 0x63}, // X
-    {0x03, 0x04, 0x78, 0x04, 0x03}, // Y
-    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z
-    {0x00, 0x00, 0x7F, 0x41, 0x41}, // [
-    {0x02, 0x04, 0x08, 0x10, 0x20}, // backslash
-    {0x41, 0x41, 0x7F, 0x00, 0x00}, // ]
-    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^
-    {0x40, 0x40, 0x40, 0x40, 0x40}, // _
-    {0x00, 0x01, 0x02, 0x04, 0x00}, // `
-    {0x20, 0x54, 0x54, 0x54, 0x78}, // a
-    {0x7F, 0x48, 0x44, 0x44, 0x38}, // b
-    {0x38, 0x44, 0x44, 0x44, 0x20}, // c
-    {0x38, 0x44, 0x44, 0x48, 0x7F}, // d
-    {0x38, 0x54, 0x54, 0x54, 0x18}, // e
-    {0x08, 0x7E, 0x09, 0x01, 0x02}, // f
-    {0x08, 0x14, 0x54, 0x54, 0x3C}, // g
-    {0x7F, 0x08, 0x04, 0x04, 0x78}, // h
-    {0x00, 0x44, 0x7D, 0x40, 0x00}, // i
-    {0x20, 0x40, 0x44, 0x3D, 0x00}, // j
-    {0x00, 0x7F, 0x10, 0x28, 0x44}, // k
-    {0x00, 0x41, 0x7F, 0x40, 0x00}, // l
-    {0x7C, 0x04, 0x18, 0x04, 0x78}, // m
-    {0x7C, 0x08, 0x04, 0x04, 0x78}, // n
-    {0x38, 0x44, 0x44, 0x44, 0x38}, // o
-    {0x7C, 0x14, 0x14, 0x14, 0x08}, // p
-    {0x08, 0x14, 0x14, 0x18, 0x7C}, // q
-    {0x7C, 0x08, 0x04, 0x04, 0x08}, // r
-    {0x48, 0x54, 0x54, 0x54, 0x20}, // s
-    {0x04, 0x3F, 0x44, 0x40, 0x20}, // t
-    {0x3C, 0x40, 0x40, 0x20, 0x7C}, // u
-    {0x1C, 0x20, 0x40, 0x20, 0x1C}, // v
-    {0x3C, 0x40, 0x30, 0x40, 0x3C}, // w
-    {0x44, 0x28, 0x10, 0x28, 0x44}, // x
-    {0x0C, 0x50, 0x50, 0x50, 0x3C}, // y
-    {0x44, 0x64, 0x54, 0x4C, 0x44}, // z
-    {0x00, 0x08, 0x36, 0x41, 0x00}, // {
-    {0x00, 0x00, 0x7F, 0x00, 0x00}, // |
-    {0x00, 0x41, 0x36, 0x08, 0x00}, // }
-    {0x08, 0x04, 0x08, 0x10, 0x08}, // ~
-    {0x00, 0x00, 0x00, 0x00, 0x00}  // DEL
-};
-
-// Article structure
-typedef struct {
-    const char* title;
-    const char* content;
-    const char* category;
-} Article;
-
-// Built-in articles
-const Article articles[] = {
-    { "Earth",
-      "Mostly Harmless.\n\nEarth was a planet in the unfashionable end of the Western Spiral arm.\n\nDemolished for a hyperspace bypass.\n\nTrue purpose: organic computer to calculate the Ultimate Question.\n\nSTATUS: Demolished",
-      "Planets"
-    },
-    { "Towel",
-      "The most massively useful thing an interstellar hitchhiker can have.\n\nWrap it for warmth, lie on it on beaches, sleep under it, use in combat, ward off fumes, wave in emergencies, and dry yourself.\n\nMost importantly: psychological value. A hitchhiker with a towel is assumed to have everything else.\n\nSTATUS: Essential",
-      "Essential Items"
-    },
-    { "42",
-      "The Answer to the Ultimate Question of Life, the Universe, and Everything.\n\nAfter 7.5 million years, Deep Thought determined the Answer was 42.\n\nThe answer seemed meaningless because the beings never knew the Question.\n\nDeep Thought designed Earth to calculate the Ultimate Question.\n\nSIGNIFICANCE: Ultimate",
-      "Philosophy"
-    },
-    { "Babel Fish",
-      "Small, yellow, leech-like. Probably the oddest thing in the Universe.\n\nStick it in your ear to instantly understand any language.\n\nFeeds on brainwave energy and excretes a telepathic matrix into your mind.\n\nIts existence proves the non-existence of God.\n\nTYPE: Universal translator\n\nMETHOD: Insert in ear",
-      "Technology"
-    },
-    { "Vogons",
-      "One of the most unpleasant races in the Galaxy.\n\nNot evil, but bad-tempered, bureaucratic, officious and callous.\n\nWon't lift a finger without orders signed in triplicate, sent in, sent back, queried, lost, found, buried in peat and recycled.\n\nNEVER let a Vogon read poetry at you.\n\nPOETRY: Third worst\n\nTEMPERAMENT: Unpleasant",
-      "Species"
-    },
-    { "Don't Panic",
-      "Large, friendly letters on the cover of the Guide.\n\nThe most important advice for any interstellar traveler.\n\nNo matter how dire, how impossible, or how improbable...\n\nDON'T PANIC.\n\nAlways know where your towel is, keep your Guide handy, and above all:\n\nDON'T PANIC!",
-      "Philosophy"
-    },
-    { "Heart of Gold",
-      "Spaceship powered by the Infinite Improbability Drive.\n\nCan pass through every point in the Universe simultaneously.\n\nPowered by Bambleweeny 57 Sub-Meson Brain connected to atomic vector plotter.\n\nStolen at launch by Zaphod Beeblebrox.\n\nMakes highly improbable things occur in its vicinity.\n\nDRIVE: Infinite Improbability",
-      "Spacecraft"
-    },
-    { "Pan Galactic Gargle Blaster",
-      "The best drink in existence.\n\nLike having your brains smashed out by a slice of lemon wrapped round a large gold brick.\n\nInvented by Zaphod Beeblebrox.\n\nINGREDIENTS:\n- Ol' Janx Spirit\n- Santraginus V water\n- Arcturan Mega-gin\n- Fallian marsh gas\n- Algolian Suntiger tooth\n- Zamphour\n- Olive\n\nDANGER LEVEL: Extreme",
-      "Beverages"
-    },
-    { "Zaphod Beeblebrox",
-      "Two-headed, three-armed ex-President of the Galaxy.\n\nPart-time adventurer, full-time galactic hoopy frood.\n\nNotable achievements:\n- Survived the Total Perspective Vortex\n- Stole the Heart of Gold\n- Invented the Pan Galactic Gargle Blaster\n\nHis brain care-edit reveals he stole the ship on orders from himself.\n\nPERSONALITY: Cool\n\nHEADS: Two",
-      "Personalities"
-    },
-    { "Marvin",
-      "The Paranoid Android.\n\nPrototype GPP (Genuine People Personality) with a brain the size of a planet.\n\nPerpetually depressed due to massive intellect and menial tasks.\n\nNotable quotes:\n'Life? Don't talk to me about life.'\n\n'I think you ought to know I'm feeling very depressed.'\n\nHas terrible pain in all the diodes down his left side.\n\nDISPOSITION: Gloomy",
-      "Personalities"
-    },
-    { "Ford Prefect",
-      "Researcher for the Hitchhiker's Guide.\n\nFrom a small planet near Betelgeuse, not Guildford as he claimed.\n\nSpent 15 years on Earth researching before it was demolished. Contribution to the Guide: 'Mostly Harmless'.\n\nExpert at: Seeing the Universe for free, getting drunk, and not panicking.\n\nSKILLS: Hitchhiking\n\nORIGIN: Betelgeuse",
-      "Personalities"
-    },
-    { "Arthur Dent",
-      "Last surviving human from Earth (along with Trillian).\n\nRescued by Ford Prefect moments before Earth's demolition.\n\nPerpetually confused and looking for a proper cup of tea.\n\nNever quite grasped being shot into space. Kept expecting things to make sense.\n\nLast words on Earth:\n'This must be Thursday. I never could get the hang of Thursdays.'\n\nSTATUS: Bewildered",
-      "Personalities"
-    },
-    { "Magrathea",
-      "Ancient planet of legendary hyperspatial engineers.\n\nBuilt luxury planets for the wealthiest in the Universe during the Golden Age of prosperity.\n\nWent into hibernation when the economy collapsed.\n\nNotable creation: Earth (commissioned by mice as a supercomputer).\n\nSlartibartfast won an award for designing Norway's fjords.\n\nSTATUS: Dormant\n\nSPECIALTY: Planets",
-      "Planets"
-    },
-    { "Slartibartfast",
-      "Magrathean planet designer.\n\nSpecializes in coastlines and fjords. Won award for designing Norway.\n\nSomewhat embarrassed by his name, which sounds rather rude.\n\nHelped Arthur Dent understand Earth's true purpose as a computer.\n\nKnown for saying: 'I'd far rather be happy than right any day.'\n\nPROFESSION: Planet builder\n\nSPECIALTY: Fjords",
-      "Personalities"
-    },
-    { "Deep Thought",
-      "Second greatest computer in the Universe.\n\nBuilt to calculate the Ultimate Answer.\n\nAfter 7.5 million years, determined the Answer was 42.\n\nExplained the Answer seemed meaningless because no one knew the Question.\n\nDesigned Earth to calculate the Ultimate Question.\n\nNotable statement: 'I checked it very thoroughly and that quite definitely is the answer.'\n\nRANK: Second best",
-      "Technology"
-    },
-    { "Trillian",
-      "Astrophysicist, only other surviving human from Earth.\n\nReal name: Tricia McMillan.\n\nMet Arthur Dent at a party in Islington but left with Zaphod Beeblebrox instead.\n\nOne of the few beings to regularly make sense of the Universe.\n\nTraveled with Zaphod on the Heart of Gold.\n\nNoted for intelligence and patience with fools.\n\nOCCUPATION: Astrophysicist\n\nDISPOSITION: Sensible",
-      "Personalities"
-    },
-    { "Infinite Improbability Drive",
-      "Revolutionary starship propulsion breakthrough.\n\nPasses through every point in the Universe simultaneously.\n\nBased on principle: Given infinite improbability, any event is possible.\n\nSide effect: Creates highly improbable events around the ship.\n\nDiscovered by students at University of Maximegalon during a hot party.\n\nPowers the Heart of Gold.\n\nPROBABILITY: Infinite\n\nSIDE EFFECTS: Weird",
-      "Technology"
-    },
-    { "Vogon Poetry",
-      "Third worst poetry in the Universe.\n\nSecond worst: Azgoths of Kria. During recitation by Poet Master Grunthos the Flatulent, four died of internal hemorrhaging.\n\nWorst: Paula Nancy Millstone Jennings of Sussex (destroyed with Earth).\n\nVogon poetry used as torture method. Typical verse involves gruntbuggly and micturations.\n\nRECOMMENDATION: Avoid at all costs\n\nQUALITY: Dreadful",
-      "Culture"
-    },
-    { "Milliways",
-      "The Restaurant at the End of the Universe.\n\nBuilt on ruins of Frogstar World B, enclosed in time bubble at end of Universe.\n\nDiners watch the Universe end while enjoying meal.\n\nUniverse ends, time bubble resets, ready for next sitting.\n\nMax Quordlepleen provides commentary during the End of Everything.\n\nReservations essential.\n\nLOCATION: End of time\n\nSPECIALTY: The Big Crunch",
-      "Locations"
-    },
-    { "Mice",
-      "Hyper-intelligent pan-dimensional beings.\n\nCommissioned Earth as supercomputer to find the Ultimate Question.\n\nHumans were merely part of the computer's operating matrix.\n\nRan lab experiments on humans, who mistakenly believed they were the intelligent ones.\n\nFinal words before Earth's demolition: 'So long, and thanks for all the fish.'\n\nACTUAL ROLE: Programmers\n\nINTELLIGENCE: Hyper",
-      "Species"
-    }
-};
-
-const int num_articles = sizeof(articles) / sizeof(Article);
-
 // State
-int current_screen = 0; // 0=boot, 1=menu, 2=browse, 3=article, 4=search
+int current_screen = 0; // 0=boot, 1=menu, 2=browse, 3=article, 4=search, 5=about
 int selected_article = 0;
 int scroll_offset = 0;
 uint8_t last_key = 0;
@@ -267,6 +87,14 @@ void spi_write_data(uint8_t data);
 void reset_controller(void);
 void pico_lcd_init(void);
 void lcd_clear(uint32_t color);
+void lcd_set_window(int x0, int y0, int x1, int y1);
+void lcd_continue_window(void);
+void lcd_scroll_define(int top_fixed, int scroll_rows);
+void lcd_scroll_to(int row);
+void lcd_scroll_reset(void);
+void lcd_fill_rect(int x, int y, int w, int h, uint32_t color);
+void lcd_hline(int x0, int x1, int y, uint32_t color);
+void lcd_vline(int x, int y0, int y1, uint32_t color);
 void lcd_pixel(int x, int y, uint32_t color);
 void lcd_char(int x, int y, char c, uint32_t color);
 void lcd_text(int x, int y, const char* str, uint32_t color);
@@ -274,23 +102,62 @@ void draw_boot_screen(void);
 void draw_menu(void);
 void draw_browse(void);
 void draw_article(void);
+void open_article(void);
+void scroll_article(int delta);
 void draw_search(void);
 void perform_search(void);
 uint8_t read_keyboard(void);
 void handle_input(uint8_t key);
 int strcasestr_simple(const char* haystack, const char* needle);
 
+#ifdef ARTICLE_BENCH
+// Decode every block of the built-in articles over and over for a second,
+// and print how fast that went and how well they compressed
+static void article_bench(void) {
+    static uint8_t text[ARTICLE_PACK_BLOCK];
+    
+    uint64_t bytes = 0;
+    uint64_t start = time_us_64();
+    uint64_t us;
+    do {
+        for (int i = 0; i < article_pack_count(); i++) {
+            int len;
+            for (int block = 0; (len = article_pack_block(i, block, text)) > 0; block++) {
+                bytes += len;
+            }
+        }
+        us = time_us_64() - start;
+    } while (us < 1000000);
+    
+    uint32_t size, packed;
+    article_pack_sizes(&size, &packed);
+    printf("Articles: %lu bytes of text in %lu (%.1f%%), decoded at %.2f MB/s\n",
+           (unsigned long)size, (unsigned long)packed, 100.0 * packed / (size ? size : 1),
+           (double)bytes / us);
+}
+#endif
+
 int main() {
     sleep_ms(200);
     
     init_display();
     init_keyboard();
+    lcd_anim_init();
     
-    draw_boot_screen();
-    sleep_ms(5000);
+    // A pack that does not check out leaves the guide without articles;
+    // say so rather than show an empty list
+    if (!article_pack_open(guide_pack)) {
+        lcd_clear(COLOR_BLACK);
+        lcd_text(10, 150, "ARTICLE PACK DAMAGED - NO ARTICLES", COLOR_LIGHTRED);
+        sleep_ms(3000);
+    }
+#ifdef ARTICLE_BENCH
+    stdio_init_all();
+    article_bench();
+#endif
     
-    current_screen = 1;
-    draw_menu();
+    // The boot animation moves on to the menu by itself
+    draw_boot_screen();
     
     while (1) {
         uint8_t key = read_keyboard();
@@ -300,33 +167,69 @@ int main() {
         } else if (key == 0) {
             last_key = 0;
         }
-        sleep_ms(50);
+    
+        // Animations run between key reads, never holding one up for more
+        // than a frame
+        lcd_anim_poll();
+        lcd_anim_wait(50);
     }
     
     return 0;
 }
 
+// spi1 transport for batched command lists
+static void lcd_bus_select(bool selected) {
+    if (selected) lcd_dma_wait();
+    gpio_put(LCD_CS, !selected);
+}
+
+static void lcd_bus_set_dc(bool data) {
+    gpio_put(LCD_DC, data);
+}
+
+static void lcd_bus_write(const uint8_t* buf, size_t len) {
+    spi_write_blocking(spi1, buf, len);
+}
+
+const lcd_bus_t lcd_spi_bus = { lcd_bus_select, lcd_bus_set_dc, lcd_bus_write };
+
+// Transport picked at build time (LCD_USE_PIO); set up by init_display
+const lcd_bus_t* lcd_bus = &lcd_spi_bus;
+
 void init_display(void) {
-    gpio_init(LCD_CS);
-    gpio_init(LCD_DC);
     gpio_init(LCD_RST);
     gpio_init(LCD_BL);
     
-    gpio_set_dir(LCD_CS, GPIO_OUT);
-    gpio_set_dir(LCD_DC, GPIO_OUT);
     gpio_set_dir(LCD_RST, GPIO_OUT);
     gpio_set_dir(LCD_BL, GPIO_OUT);
     
+#ifdef LCD_USE_PIO
+    // PIO owns SCK, MOSI, CS and DC
+    lcd_pio_init();
+    lcd_bus = &lcd_pio_bus;
+#else
+    gpio_init(LCD_CS);
+    gpio_init(LCD_DC);
+    gpio_set_dir(LCD_CS, GPIO_OUT);
+    gpio_set_dir(LCD_DC, GPIO_OUT);
+    
     spi_init(spi1, LCD_SPI_SPEED);
     gpio_set_function(LCD_SCK, GPIO_FUNC_SPI);
     gpio_set_function(LCD_MOSI, GPIO_FUNC_SPI);
     gpio_set_function(LCD_MISO, GPIO_FUNC_SPI);
     
     gpio_put(LCD_CS, 1);
+    lcd_bus = &lcd_spi_bus;
+#endif
+    
     gpio_put(LCD_RST, 1);
     gpio_put(LCD_BL, 1);
     
     pico_lcd_init();
+    lcd_dma_init();
+#ifdef LCD_USE_FRAMEBUFFER
+    lcd_fb_init();
+#endif
 }
 
 void init_keyboard(void) {
@@ -338,17 +241,17 @@ void init_keyboard(void) {
 }
 
 void spi_write_command(uint8_t cmd) {
-    gpio_put(LCD_DC, 0);
-    gpio_put(LCD_CS, 0);
-    spi_write_blocking(spi1, &cmd, 1);
-    gpio_put(LCD_CS, 1);
+    lcd_bus->select(true);
+    lcd_bus->set_dc(false);
+    lcd_bus->write(&cmd, 1);
+    lcd_bus->select(false);
 }
 
 void spi_write_data(uint8_t data) {
-    gpio_put(LCD_DC, 1);
-    gpio_put(LCD_CS, 0);
-    spi_write_blocking(spi1, &data, 1);
-    gpio_put(LCD_CS, 1);
+    lcd_bus->select(true);
+    lcd_bus->set_dc(true);
+    lcd_bus->write(&data, 1);
+    lcd_bus->select(false);
 }
 
 void reset_controller(void) {
@@ -361,123 +264,129 @@ void reset_controller(void) {
 }
 
 void pico_lcd_init(void) {
+    static const uint8_t pos_gamma[] = {
+        0x00, 0x03, 0x09, 0x08, 0x16, 0x0A, 0x3F, 0x78,
+        0x4C, 0x09, 0x0A, 0x08, 0x16, 0x1A, 0x0F
+    };
+    static const uint8_t neg_gamma[] = {
+        0x00, 0x16, 0x19, 0x03, 0x0F, 0x05, 0x32, 0x45,
+        0x46, 0x04, 0x0E, 0x0D, 0x35, 0x37, 0x0F
+    };
+    static const uint8_t power1[] = { 0x17, 0x15 };
+    static const uint8_t power2[] = { 0x41 };
+    static const uint8_t vcom[] = { 0x00, 0x12, 0x80 };
+    static const uint8_t madctl[] = { 0x48 };
+    static const uint8_t pixfmt[] = { 0x66 };
+    static const uint8_t ifmode[] = { 0x00 };
+    static const uint8_t frmctr[] = { 0xA0 };
+    static const uint8_t invctr[] = { 0x02 };
+    static const uint8_t dfunctr[] = { 0x02, 0x02, 0x3B };
+    static const uint8_t etmod[] = { 0xC6 };
+    static const uint8_t e9[] = { 0x00 };
+    static const uint8_t adjctl3[] = { 0xA9, 0x51, 0x2C, 0x82 };
+    
     reset_controller();
-
-    spi_write_command(0xE0);
-    spi_write_data(0x00); spi_write_data(0x03); spi_write_data(0x09);
-    spi_write_data(0x08); spi_write_data(0x16); spi_write_data(0x0A);
-    spi_write_data(0x3F); spi_write_data(0x78); spi_write_data(0x4C);
-    spi_write_data(0x09); spi_write_data(0x0A); spi_write_data(0x08);
-    spi_write_data(0x16); spi_write_data(0x1A); spi_write_data(0x0F);
-
-    spi_write_command(0XE1);
-    spi_write_data(0x00); spi_write_data(0x16); spi_write_data(0x19);
-    spi_write_data(0x03); spi_write_data(0x0F); spi_write_data(0x05);
-    spi_write_data(0x32); spi_write_data(0x45); spi_write_data(0x46);
-    spi_write_data(0x04); spi_write_data(0x0E); spi_write_data(0x0D);
-    spi_write_data(0x35); spi_write_data(0x37); spi_write_data(0x0F);
-
-    spi_write_command(0xC0);
-    spi_write_data(0x17); spi_write_data(0x15);
-
-    spi_write_command(0xC1);
-    spi_write_data(0x41);
-
-    spi_write_command(0xC5);
-    spi_write_data(0x00); spi_write_data(0x12); spi_write_data(0x80);
-
-    spi_write_command(0x36);
-    spi_write_data(0x48);
-
-    spi_write_command(0x3A);
-    spi_write_data(0x66);
-
-    spi_write_command(0xB0);
-    spi_write_data(0x00);
-
-    spi_write_command(0xB1);
-    spi_write_data(0xA0);
-
-    spi_write_command(0x21);
-
-    spi_write_command(0xB4);
-    spi_write_data(0x02);
-
-    spi_write_command(0xB6);
-    spi_write_data(0x02); spi_write_data(0x02); spi_write_data(0x3B);
-
-    spi_write_command(0xB7);
-    spi_write_data(0xC6);
     
-    spi_write_command(0xE9);
-    spi_write_data(0x00);
-
-    spi_write_command(0xF7);
-    spi_write_data(0xA9); spi_write_data(0x51);
-    spi_write_data(0x2C); spi_write_data(0x82);
-
+    // Whole register setup goes out in one CS assertion
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    bool fits = lcd_cmd_add(&list, 0xE0, pos_gamma, sizeof(pos_gamma)) &&
+                lcd_cmd_add(&list, 0xE1, neg_gamma, sizeof(neg_gamma)) &&
+                lcd_cmd_add(&list, 0xC0, power1, sizeof(power1)) &&
+                lcd_cmd_add(&list, 0xC1, power2, sizeof(power2)) &&
+                lcd_cmd_add(&list, 0xC5, vcom, sizeof(vcom)) &&
+                lcd_cmd_add(&list, 0x36, madctl, sizeof(madctl)) &&
+                lcd_cmd_add(&list, 0x3A, pixfmt, sizeof(pixfmt)) &&
+                lcd_cmd_add(&list, 0xB0, ifmode, sizeof(ifmode)) &&
+                lcd_cmd_add(&list, 0xB1, frmctr, sizeof(frmctr)) &&
+                lcd_cmd_add(&list, 0x21, NULL, 0) &&
+                lcd_cmd_add(&list, 0xB4, invctr, sizeof(invctr)) &&
+                lcd_cmd_add(&list, 0xB6, dfunctr, sizeof(dfunctr)) &&
+                lcd_cmd_add(&list, 0xB7, etmod, sizeof(etmod)) &&
+                lcd_cmd_add(&list, 0xE9, e9, sizeof(e9)) &&
+                lcd_cmd_add(&list, 0xF7, adjctl3, sizeof(adjctl3));
+    if (!fits) panic("LCD init sequence overflows lcd_cmd_list_t");
+    lcd_cmd_flush(&list, lcd_bus, false);
+    
     spi_write_command(0x11);
     sleep_ms(120);
-
+    
     spi_write_command(0x29);
     sleep_ms(120);
 }
 
+// Runs on DMA and returns at once; the next bus access waits for it
 void lcd_clear(uint32_t color) {
-    spi_write_command(0x2A);
-    spi_write_data(0); spi_write_data(0);
-    spi_write_data(0x01); spi_write_data(0x3F);
-    
-    spi_write_command(0x2B);
-    spi_write_data(0); spi_write_data(0);
-    spi_write_data(0x01); spi_write_data(0x3F);
-    
-    spi_write_command(0x2C);
-    
-    uint8_t rgb[3];
-    rgb[0] = (color >> 16) & 0xFF;
-    rgb[1] = (color >> 8) & 0xFF;
-    rgb[2] = color & 0xFF;
-    
-    gpio_put(LCD_DC, 1);
-    gpio_put(LCD_CS, 0);
-    
-    for (uint32_t i = 0; i < 320 * 320; i++) {
-        spi_write_blocking(spi1, rgb, 3);
-    }
-    
-    gpio_put(LCD_CS, 1);
+    lcd_fill_rect(0, 0, LCD_WIDTH, LCD_HEIGHT, color);
+}
+
+// Set the panel address window and start a RAMWR in one CS assertion.
+// The bus is left selected in data mode; stream pixels, then raise CS.
+void lcd_set_window(int x0, int y0, int x1, int y1) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_window(&list, x0, y0, x1, y1);
+    lcd_cmd_flush(&list, lcd_bus, true);
+}
+
+// Resume the previous RAMWR inside the current window without resending it
+void lcd_continue_window(void) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_continue(&list);
+    lcd_cmd_flush(&list, lcd_bus, true);
+}
+
+// Split the panel into a fixed top, a scrolling band and a fixed bottom.
+// Drawing still addresses frame-memory rows; only the displayed mapping changes.
+void lcd_scroll_define(int top_fixed, int scroll_rows) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_scroll_area(&list, top_fixed, scroll_rows, LCD_MEM_ROWS - top_fixed - scroll_rows);
+    lcd_cmd_flush(&list, lcd_bus, false);
+}
+
+// Show frame-memory row `row` at the top of the scrolling band
+void lcd_scroll_to(int row) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_scroll_start(&list, row);
+    lcd_cmd_flush(&list, lcd_bus, false);
+}
+
+// Whole frame memory scrolls, starting at row 0: display rows map 1:1 again
+void lcd_scroll_reset(void) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_scroll_area(&list, 0, LCD_MEM_ROWS, 0);
+    lcd_cmd_scroll_start(&list, 0);
+    lcd_cmd_flush(&list, lcd_bus, false);
 }
 
 void lcd_pixel(int x, int y, uint32_t color) {
     if (x < 0 || x >= 320 || y < 0 || y >= 320) return;
     
-    spi_write_command(0x2A);
-    spi_write_data(x >> 8); spi_write_data(x & 0xFF);
-    spi_write_data(x >> 8); spi_write_data(x & 0xFF);
-    
-    spi_write_command(0x2B);
-    spi_write_data(y >> 8); spi_write_data(y & 0xFF);
-    spi_write_data(y >> 8); spi_write_data(y & 0xFF);
+    if (lcd_band_active()) {
+        lcd_band_pixel(x, y, color);
+        return;
+    }
     
-    spi_write_command(0x2C);
+    lcd_set_window(x, y, x, y);
     
     uint8_t rgb[3];
     rgb[0] = (color >> 16) & 0xFF;
     rgb[1] = (color >> 8) & 0xFF;
     rgb[2] = color & 0xFF;
     
-    gpio_put(LCD_DC, 1);
-    gpio_put(LCD_CS, 0);
-    spi_write_blocking(spi1, rgb, 3);
-    gpio_put(LCD_CS, 1);
+    lcd_bus->write(rgb, 3);
+    lcd_bus->select(false);
 }
 
 void lcd_line(int x0, int y0, int x1, int y1, uint32_t color) {
     int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
     int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
     int err = dx + dy, e2;
-
+    
     while (1) {
         lcd_pixel(x0, y0, color);
         if (x0 == x1 && y0 == y1) break;
@@ -488,10 +397,10 @@ void lcd_line(int x0, int y0, int x1, int y1, uint32_t color) {
 }
 
 void lcd_rect(int x, int y, int w, int h, uint32_t color) {
-    lcd_line(x, y, x + w, y, color);
-    lcd_line(x + w, y, x + w, y + h, color);
-    lcd_line(x + w, y + h, x, y + h, color);
-    lcd_line(x, y + h, x, y, color);
+    lcd_hline(x, x + w, y, color);
+    lcd_hline(x, x + w, y + h, color);
+    lcd_vline(x, y, y + h, color);
+    lcd_vline(x + w, y, y + h, color);
 }
 
 void lcd_circle(int xc, int yc, int r, uint32_t color) {
@@ -516,6 +425,10 @@ void lcd_circle(int xc, int yc, int r, uint32_t color) {
     }
 }
 
+// One row of pre-expanded RGB888 pixels, reused by every burst fill
+static uint8_t lcd_fill_buf[LCD_WIDTH * 3];
+
+// Fill a rectangle: one window setup, then w*h pixels in a single CS assertion
 void lcd_fill_rect(int x, int y, int w, int h, uint32_t color) {
     if (x < 0) { w += x; x = 0; }
     if (y < 0) { h += y; y = 0; }
@@ -523,69 +436,97 @@ void lcd_fill_rect(int x, int y, int w, int h, uint32_t color) {
     if (y + h > LCD_HEIGHT) h = LCD_HEIGHT - y;
     if (w <= 0 || h <= 0) return;
     
-    for (int cy = y; cy < y + h; cy++) {
-        for (int cx = x; cx < x + w; cx++) {
-            lcd_pixel(cx, cy, color);
-        }
+    if (lcd_band_active()) {
+        lcd_band_fill(x, y, w, h, color);
+        return;
+    }
+    
+    uint32_t remaining = (uint32_t)w * h;
+    
+    // Large fills are handed to DMA; the CPU only sets the window
+    if (remaining >= LCD_DMA_MIN_PIXELS) {
+        lcd_dma_fill_start(x, y, w, h, color);
+        return;
     }
+    uint32_t chunk = remaining < LCD_WIDTH ? remaining : LCD_WIDTH;
+    
+    for (uint32_t i = 0; i < chunk; i++) {
+        lcd_fill_buf[i * 3]     = (color >> 16) & 0xFF;
+        lcd_fill_buf[i * 3 + 1] = (color >> 8) & 0xFF;
+        lcd_fill_buf[i * 3 + 2] = color & 0xFF;
+    }
+    
+    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    
+    while (remaining > 0) {
+        uint32_t n = remaining < chunk ? remaining : chunk;
+        lcd_bus->write(lcd_fill_buf, n * 3);
+        remaining -= n;
+    }
+    
+    lcd_bus->select(false);
 }
 
+// Filled circle drawn as one horizontal span per row
 void lcd_fill_circle(int xc, int yc, int r, uint32_t color) {
     for (int y = -r; y <= r; y++) {
-        for (int x = -r; x <= r; x++) {
-            if (x * x + y * y <= r * r) {
-                lcd_pixel(xc + x, yc + y, color);
-            }
-        }
+        int x = r;
+        while (x * x + y * y > r * r) x--;
+        lcd_fill_rect(xc - x, yc + y, 2 * x + 1, 1, color);
     }
 }
 
 void lcd_hline(int x0, int x1, int y, uint32_t color) {
     if (x0 > x1) { int tmp = x0; x0 = x1; x1 = tmp; }
-    for (int x = x0; x <= x1; x++) {
-        lcd_pixel(x, y, color);
-    }
+    lcd_fill_rect(x0, y, x1 - x0 + 1, 1, color);
 }
 
 void lcd_vline(int x, int y0, int y1, uint32_t color) {
     if (y0 > y1) { int tmp = y0; y0 = y1; y1 = tmp; }
-    for (int y = y0; y <= y1; y++) {
-        lcd_pixel(x, y, color);
-    }
+    lcd_fill_rect(x, y0, 1, y1 - y0 + 1, color);
 }
 
 void lcd_char(int x, int y, char c, uint32_t color) {
-    if (c < 32 || c > 126) return;
-    
-    for (int col = 0; col < 5; col++) {
-        uint8_t line = font5x7[c - 32][col];
-        for (int row = 0; row < 7; row++) {
-            if (line & (1 << row)) {
-                lcd_pixel(x + col, y + row, color);
-            }
-        }
-    }
+    lcd_glyph_run(x, y, &c, 1, 1, color, LCD_GLYPH_NO_BG, 0);
 }
 
+// Each line is one glyph run: a line ends at '\n' or wraps at the right
+// edge of the screen (see lcd_metrics_wrap)
 void lcd_text(int x, int y, const char* str, uint32_t color) {
-    int cx = x;
+    int len = strlen(str);
     int cy = y;
-    while (*str) {
-        if (*str == '\n') {
-            cx = x;
-            cy += 10;
-        } else {
-            lcd_char(cx, cy, *str, color);
-            cx += 6;
-            if (cx > 314) {
-                cx = x;
-                cy += 10;
-            }
-        }
-        str++;
+    while (len > 0) {
+        int next;
+        int n = lcd_metrics_wrap(str, len, 1, 0, LCD_WIDTH - x, &next);
+        lcd_glyph_run(x, cy, str, n, 1, color, LCD_GLYPH_NO_BG, 0);
+        str += next;
+        len -= next;
+        cy += 10;
     }
 }
 
+// Boot screen: the loading spinner turns for BOOT_SPIN_FRAMES frames,
+// then the screen stays until BOOT_FRAMES (or a key) and the menu comes up
+#define BOOT_FRAME_MS       100
+#define BOOT_SPIN_FRAMES    20
+#define BOOT_FRAMES         70
+
+static lcd_anim_t boot_anim;
+static int boot_frame;
+
+static bool boot_step(lcd_anim_t* anim, int frames) {
+    (void)anim;
+    boot_frame += frames;
+    if (boot_frame < BOOT_SPIN_FRAMES) {
+        draw_loading_animation(270, 290, boot_frame);
+    }
+    if (boot_frame < BOOT_FRAMES) return true;
+    
+    current_screen = 1;
+    draw_menu();
+    return false;
+}
+
 void draw_boot_screen(void) {
     // Enhanced boot screen
     lcd_clear(COLOR_BLACK);
@@ -598,121 +539,283 @@ void draw_boot_screen(void) {
     draw_outlined_text(20, 290, "v2.1 Enhanced - Paul Wyman - 2025", COLOR_HGTTG_BRIGHT, COLOR_BLACK, 1);
     
     // Add loading animation
-    for (int frame = 0; frame < 20; frame++) {
-        draw_loading_animation(270, 290, frame);
-        sleep_ms(100);
+    current_screen = 0;
+    boot_frame = 0;
+    draw_loading_animation(270, 290, boot_frame);
+    lcd_anim_start(&boot_anim, boot_step, NULL, BOOT_FRAME_MS);
+}
+
+// Composite widgets in the screen display lists (lcd_dl.h)
+enum {
+    WIDGET_HEADER,          // draw_article_header(str1, str2)
+    WIDGET_MENU_ITEM,       // draw_menu_item(str1, arg1 = number, arg2 = selected)
+    WIDGET_SCROLL,          // draw_scroll_indicator(arg1 = total, arg2 = visible, arg3 = pos)
+    WIDGET_DIAGRAM,         // article diagram, arg1 = article index
+    WIDGET_ARTICLE_LINE,    // teleprinter line arg2 of article arg1, arg3 bytes of it shown
+};
+
+static void draw_article_diagram(const Article* art);
+static void draw_article_body_line(int article, int line, int row, int shown);
+
+// Article i of the built-in pack; an entry that does not check out reads
+// as an empty article
+static Article guide_article(int i) {
+    Article art;
+    if (!article_pack_get(i, &art)) {
+        art = (Article){ .title = "?", .category = "", .read = article_read_memory, .source = "" };
     }
+    return art;
 }
 
-void draw_menu(void) {
-    lcd_clear(COLOR_BLACK);
+static void dl_menu_item(lcd_dl_t* dl, int x, int y, const char* text, int number, bool selected) {
+    lcd_dl_widget(dl, WIDGET_MENU_ITEM, x, y, 200, 25, number, selected, 0, text, NULL);
+}
+
+static void dl_scroll_indicator(lcd_dl_t* dl, int x, int y, int total, int visible, int pos) {
+    lcd_dl_widget(dl, WIDGET_SCROLL, x, y, 9, scroll_indicator_height(total, visible, pos),
+                  total, visible, pos, NULL, NULL);
+}
+
+// Screen display lists: the one on the panel and the one being built.
+// screen_valid is false until the panel shows a list (e.g. after the boot
+// screen, which is drawn directly).
+static lcd_dl_t screen_lists[2];
+static int screen_shown = 0;
+static bool screen_valid = false;
+
+static void draw_widget(const lcd_dl_t* dl, const lcd_prim_t* p) {
+    switch (p->a) {
+    case WIDGET_HEADER:
+        draw_article_header(lcd_dl_str(dl, p->text), lcd_dl_str(dl, p->text2));
+        break;
+    case WIDGET_MENU_ITEM:
+        draw_menu_item(p->x, p->y, lcd_dl_str(dl, p->text), p->b, p->c);
+        break;
+    case WIDGET_SCROLL:
+        draw_scroll_indicator(p->x, p->y, p->b, p->c, p->d);
+        break;
+    case WIDGET_DIAGRAM: {
+        Article art = guide_article(p->b);
+        draw_article_diagram(&art);
+        break;
+    }
+    case WIDGET_ARTICLE_LINE:
+        draw_article_body_line(p->b, p->c, p->y, p->d);
+        break;
+    }
+}
+
+// Band-renderer scene for the list on the panel: every primitive that
+// reaches into the band being rasterized
+static void screen_scene(void) {
+    const lcd_dl_t* dl = &screen_lists[screen_shown];
+    
+    for (int i = 0; i < dl->num_prims; i++) {
+        const lcd_prim_t* p = &dl->prims[i];
+        if (lcd_band_rect_hidden(p->x, p->y, p->w, p->h)) continue;
+    
+        const char* str = lcd_dl_str(dl, p->text);
+        switch (p->kind) {
+        case LCD_DL_FILL:
+            lcd_fill_rect(p->x, p->y, p->w, p->h, p->color);
+            break;
+        case LCD_DL_FRAME:
+            lcd_rect(p->x, p->y, p->a, p->b, p->color);
+            break;
+        case LCD_DL_ROUNDED:
+            draw_rounded_rect(p->x, p->y, p->w, p->h, p->a, p->color);
+            break;
+        case LCD_DL_GRADIENT:
+            draw_gradient_rect(p->x, p->y, p->w, p->h, p->color, p->color2, p->a);
+            break;
+        case LCD_DL_TEXT:
+            lcd_text(p->ox, p->oy, str, p->color);
+            break;
+        case LCD_DL_LARGE_TEXT:
+            draw_large_text(p->ox, p->oy, str, p->color, p->a);
+            break;
+        case LCD_DL_OUTLINED_TEXT:
+            draw_outlined_text(p->ox, p->oy, str, p->color, p->color2, p->a);
+            break;
+        case LCD_DL_WIDGET:
+            draw_widget(dl, p);
+            break;
+        }
+    }
+}
+
+// Build the next list for the current state, diff it against the list on
+// the panel and re-rasterize only what changed
+static void screen_show(void (*build)(lcd_dl_t* dl)) {
+    lcd_dl_t* old_dl = &screen_lists[screen_shown];
+    lcd_dl_t* new_dl = &screen_lists[screen_shown ^ 1];
+    
+    lcd_dl_reset(new_dl);
+    build(new_dl);
+    
+    if (screen_valid) {
+        lcd_dl_diff(old_dl, new_dl, lcd_damage_add);
+    } else {
+        lcd_damage_add(0, 0, LCD_WIDTH, LCD_HEIGHT);
+    }
+    
+    screen_shown ^= 1;
+    screen_valid = true;
+    lcd_damage_flush(screen_scene);
+}
+
+// Like screen_show, for a change to the list on the panel whose damage
+// the caller has already marked (lcd_damage_add), tighter than the list
+// diff would find it
+static void screen_show_marked(void (*build)(lcd_dl_t* dl)) {
+    lcd_dl_t* new_dl = &screen_lists[screen_shown ^ 1];
+    
+    lcd_dl_reset(new_dl);
+    build(new_dl);
+    
+    screen_shown ^= 1;
+    lcd_damage_flush(screen_scene);
+}
+
+static void build_menu(lcd_dl_t* dl) {
+    lcd_dl_fill(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_BLACK);
     
     // Enhanced header with gradient
-    draw_gradient_rect(0, 0, 320, 60, COLOR_HGTTG_DARK, COLOR_HGTTG_MEDIUM, true);
-    draw_outlined_text(10, 10, "THE HITCHHIKER'S GUIDE", COLOR_HGTTG_BRIGHT, COLOR_BLACK, 2);
-    draw_outlined_text(10, 35, "TO THE GALAXY", COLOR_AMBER_BRIGHT, COLOR_BLACK, 1);
+    lcd_dl_gradient(dl, 0, 0, 320, 60, COLOR_HGTTG_DARK, COLOR_HGTTG_MEDIUM, true);
+    lcd_dl_outlined_text(dl, 10, 10, "THE HITCHHIKER'S GUIDE", COLOR_HGTTG_BRIGHT, COLOR_BLACK, 2);
+    lcd_dl_outlined_text(dl, 10, 35, "TO THE GALAXY", COLOR_AMBER_BRIGHT, COLOR_BLACK, 1);
     
     // Enhanced menu items
-    draw_menu_item(20, 80, "Browse Articles", 1, false);
-    draw_menu_item(20, 110, "Search Articles", 2, false);
-    draw_menu_item(20, 140, "Random Article", 3, false);
-    draw_menu_item(20, 170, "About", 4, false);
+    dl_menu_item(dl, 20, 80, "Browse Articles", 1, false);
+    dl_menu_item(dl, 20, 110, "Search Articles", 2, false);
+    dl_menu_item(dl, 20, 140, "Random Article", 3, false);
+    dl_menu_item(dl, 20, 170, "About", 4, false);
     
     // Footer with better styling
-    draw_rounded_rect(10, 280, 200, 25, 5, COLOR_AMBER_DARK);
-    lcd_text(15, 288, "Press number key to select", COLOR_YELLOW_BRIGHT);
+    lcd_dl_rounded(dl, 10, 280, 200, 25, 5, COLOR_AMBER_DARK);
+    lcd_dl_text(dl, 15, 288, "Press number key to select", COLOR_YELLOW_BRIGHT);
     
     // DON'T PANIC reminder
-    draw_outlined_text(230, 250, "DON'T", COLOR_HGTTG_BRIGHT, COLOR_HGTTG_DARK, 2);
-    draw_outlined_text(230, 275, "PANIC", COLOR_HGTTG_BRIGHT, COLOR_HGTTG_DARK, 2);
+    lcd_dl_outlined_text(dl, 230, 250, "DON'T", COLOR_HGTTG_BRIGHT, COLOR_HGTTG_DARK, 2);
+    lcd_dl_outlined_text(dl, 230, 275, "PANIC", COLOR_HGTTG_BRIGHT, COLOR_HGTTG_DARK, 2);
 }
 
-void draw_browse(void) {
-    lcd_clear(COLOR_BLACK);
+void draw_menu(void) {
+    screen_show(build_menu);
+}
+
+// List rows on the browse and search screens
+#define LIST_ROW_PITCH  25
+#define BROWSE_TOP      60
+#define BROWSE_ROWS     9
+#define SEARCH_TOP      115
+#define SEARCH_ROWS     7
+
+// One list row: highlight, "> title" and category
+static void dl_list_row(lcd_dl_t* dl, int y, int article_idx, bool is_selected) {
+    Article art = guide_article(article_idx);
+    uint32_t fg_color = is_selected ? COLOR_BLACK : COLOR_HGTTG_BRIGHT;
+    
+    if (is_selected) {
+        lcd_dl_rounded(dl, 10, y - 2, 280, 22, 5, COLOR_HGTTG_MEDIUM);
+    }
+    
+    char line[50];
+    snprintf(line, sizeof(line), "%c %s", 
+             is_selected ? '>' : ' ',
+             art.title);
+    
+    lcd_dl_large_text(dl, 15, y + 2, line, fg_color, 1);
+    
+    // Show category
+    lcd_dl_text(dl, 200, y + 5, art.category, COLOR_AMBER_MEDIUM);
+}
+
+static void build_browse(lcd_dl_t* dl) {
+    lcd_dl_fill(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_BLACK);
     
     // Enhanced header
-    draw_article_header("ARTICLE BROWSER", "Library");
-    
-    int y = 60;
-    for (int i = 0; i < num_articles && i < 9; i++) {
-        bool is_selected = (i == selected_article);
-        uint32_t bg_color = is_selected ? COLOR_HGTTG_MEDIUM : COLOR_BLACK;
-        uint32_t fg_color = is_selected ? COLOR_BLACK : COLOR_HGTTG_BRIGHT;
-        
-        if (is_selected) {
-            draw_rounded_rect(10, y - 2, 280, 22, 5, bg_color);
-        }
-        
-        char line[50];
-        snprintf(line, sizeof(line), "%c %s", 
-                 is_selected ? '>' : ' ',
-                 articles[i].title);
-        
-        draw_large_text(15, y + 2, line, fg_color, 1);
-        
-        // Show category
-        lcd_text(200, y + 5, articles[i].category, COLOR_AMBER_MEDIUM);
-        
-        y += 25;
+    lcd_dl_widget(dl, WIDGET_HEADER, 0, 0, 320, 50, 0, 0, 0, "ARTICLE BROWSER", "Library");
+    
+    int y = BROWSE_TOP;
+    for (int i = 0; i < article_pack_count() && i < BROWSE_ROWS; i++) {
+        dl_list_row(dl, y, i, i == selected_article);
+        y += LIST_ROW_PITCH;
     }
     
     // Enhanced footer
-    draw_rounded_rect(10, 280, 200, 25, 5, COLOR_AMBER_DARK);
-    lcd_text(15, 288, "↑↓ Navigate  ENTER Select  ESC Back", COLOR_YELLOW_BRIGHT);
+    lcd_dl_rounded(dl, 10, 280, 200, 25, 5, COLOR_AMBER_DARK);
+    lcd_dl_text(dl, 15, 288, "↑↓ Navigate  ENTER Select  ESC Back", COLOR_YELLOW_BRIGHT);
     
     // Scroll indicator
-    draw_scroll_indicator(300, 60, num_articles, 9, selected_article);
+    dl_scroll_indicator(dl, 300, BROWSE_TOP, article_pack_count(), BROWSE_ROWS, selected_article);
 }
 
-// Draw text character by character like a teleprinter
-int lcd_text_teleprinter_scroll(int x, int y, const char* str, uint32_t color, int delay_ms, int scroll_offset, int max_visible_lines) {
-    int cx = x;
-    int cy = y;
-    int usable_width = 320 - x - 5;
-    int max_cx = x + usable_width;
-
-    int line_num = 0;     // current line number
-    int total_lines = 0;  // total number of lines rendered
-
-    while (*str) {
-        char c = *str;
-        if (c >= 'a' && c <= 'z') c -= 32; // uppercase
+void draw_browse(void) {
+    screen_show(build_browse);
+}
 
-        if (c == '\n') {
-            line_num++;
-            cy += 12;
-            cx = x;
-        } else {
-            if (line_num >= scroll_offset && line_num < scroll_offset + max_visible_lines) {
-                lcd_char(cx, cy - (scroll_offset * 12), c, color);
-            }
-            cx += 7;
-            if (cx + 5 >= max_cx) {
-                line_num++;
-                cy += 12;
-                cx = x;
-            }
-        }
-        str++;
+// Article body layout. The body is a hardware scrolling band of exactly
+// ARTICLE_LINES text lines between the diagram frame and the footer; line n
+// always lives in the same 12-row slot of frame memory (n % ARTICLE_LINES),
+// so scrolling by one line rewrites one slot and moves the scroll start.
+#define ARTICLE_BODY_TOP    156   // first row below the diagram frame
+#define ARTICLE_LINE_HEIGHT 12
+#define ARTICLE_LINES       12
+
+// Teleprinter lines: the 5x7 font at 1x, the screen width less a 10 px
+// margin on the left and 5 px on the right. Packed bodies are already in
+// upper case, so no flags.
+#define ARTICLE_SCALE   1
+#define ARTICLE_FLAGS   0
+#define ARTICLE_WIDTH   (LCD_WIDTH - 15)
+
+// Lines of the open article's body, through the streaming reader, which
+// reads only the text around the lines looked at: packed bodies, which
+// are compressed in flash, by their tables, others wrapped as it goes.
+static int article_opened = -1;
+static article_reader_t article_stream;
+static int article_flags;
+
+// Get the body of article i ready unless it is the one already open.
+// Line tables are used when they were wrapped the same way.
+static void article_open(int i) {
+    if (article_opened == i) return;
+    article_opened = i;
+    
+    Article a = guide_article(i);
+    const Article* art = &a;
+    
+    bool tables = art->line_starts && art->layout.scale == ARTICLE_SCALE &&
+                  art->layout.flags == ARTICLE_FLAGS && art->layout.width == ARTICLE_WIDTH;
+    
+    // Bodies read from elsewhere come as they were written, unless they
+    // were packed (in upper case, with line tables)
+    article_flags = art->line_starts ? ARTICLE_FLAGS : LCD_GLYPH_UPPER;
+    article_reader_open(&article_stream, art->read, art->source, art->size, ARTICLE_SCALE,
+                        article_flags, ARTICLE_WIDTH);
+    if (tables) {
+        article_reader_use_lines(&article_stream, art->line_starts, art->line_lengths, art->num_lines);
     }
-
-    // Return total number of lines (for scroll bounds)
-    return line_num + 1;
 }
 
-void draw_article(void) {
-    lcd_clear(COLOR_BLACK);
+// Line `line` of the open body (see article_reader_line); the text is
+// only good until the next line is asked for
+static const char* article_line(int line, int* len) {
+    return article_reader_line(&article_stream, line, len);
+}
 
-    const Article* art = &articles[selected_article];
+static bool article_has_line(int line) {
+    int len;
+    return article_line(line, &len) != NULL;
+}
 
-    // Enhanced article header
-    draw_article_header(art->title, art->category);
+static int article_slot_row(int line) {
+    return ARTICLE_BODY_TOP + (line % ARTICLE_LINES) * ARTICLE_LINE_HEIGHT;
+}
 
-    // === Enhanced Diagram area ===
-    draw_rounded_rect(10, 55, 300, 100, 8, COLOR_BLACK);
-    lcd_rect(10, 55, 300, 100, COLOR_CYAN_MEDIUM);
-    
-    // Draw appropriate diagram based on article
+// Draw appropriate diagram based on article
+static void draw_article_diagram(const Article* art) {
     if (strcmp(art->title, "Babel Fish") == 0) {
         draw_babel_fish_diagram(15, 60);
     } else if (strcmp(art->title, "Earth") == 0) {
@@ -740,30 +843,171 @@ void draw_article(void) {
         lcd_text(80, 110, "No specific diagram available", COLOR_CYAN_BRIGHT);
         lcd_text(90, 125, "Content follows below", COLOR_CYAN_MEDIUM);
     }
+}
 
-    // === Teleprinter article content ===
-    // Starts below diagram (y ≈ 145)
-    int max_visible_lines = 12; // ~12 lines fit below diagram (~150px to ~300px)
-int total_lines = lcd_text_teleprinter_scroll(10, 150, art->content, COLOR_BLUE, 0, scroll_offset, max_visible_lines);
+// The first shown bytes of a teleprinter line of an article, in the
+// 12-row slot starting at row
+static void draw_article_body_line(int article, int line, int row, int shown) {
+    article_open(article);
+    
+    int len;
+    const char* str = article_line(line, &len);
+    if (!str) return;
+    if (shown < len) len = shown;
+    lcd_glyph_run(10, row + 2, str, len, ARTICLE_SCALE, COLOR_BLUE, LCD_GLYPH_NO_BG, article_flags);
+}
 
-// Clamp scroll_offset so we don’t scroll past the end
-if (scroll_offset > total_lines - max_visible_lines) {
-    scroll_offset = total_lines - max_visible_lines;
-    if (scroll_offset < 0) scroll_offset = 0;
+// Teleprinter effect: an article opens with an empty body, which is then
+// typed out TELEPRINTER_CHARS characters a frame, line by line from the
+// top of the view. Lines before teleprinter_line are shown in full, the
+// first teleprinter_pos bytes of that line, and nothing after it.
+#define TELEPRINTER_FRAME_MS    30
+#define TELEPRINTER_CHARS       6
+
+static lcd_anim_t teleprinter_anim;
+static int teleprinter_line;
+static int teleprinter_pos;
+static int teleprinter_last;    // last line in the view
+
+static int article_line_shown(int line) {
+    int len;
+    if (!article_line(line, &len)) return 0;
+    
+    if (!lcd_anim_running(&teleprinter_anim) || line < teleprinter_line) return len;
+    return line == teleprinter_line ? teleprinter_pos : 0;
 }
 
+// Mark the pixels of bytes from..to of a line, where they have just
+// appeared. A kerned glyph can reach one pixel left of its pen position.
+static void teleprinter_mark(int line, int from, int to) {
+    int len;
+    const char* str = article_line(line, &len);
+    if (!str || to <= from) return;
+    
+    int x0 = 10 + lcd_metrics_width(str, from, ARTICLE_SCALE, article_flags) - 1;
+    int x1 = 10 + lcd_metrics_width(str, to, ARTICLE_SCALE, article_flags);
+    lcd_damage_add(x0, article_slot_row(line), x1 - x0, ARTICLE_LINE_HEIGHT);
+}
 
+static void build_article(lcd_dl_t* dl);
 
-    // Footer
-    lcd_text(10, 300, "UP/DOWN ESC", COLOR_GREEN);
+static bool teleprinter_step(lcd_anim_t* anim, int frames) {
+    (void)anim;
+    int last = teleprinter_last;
+    int from = teleprinter_pos;
+    
+    // Moving on to the next line costs a character too, like a carriage
+    // return, so blank lines still take a moment
+    for (int n = frames * TELEPRINTER_CHARS; n > 0 && teleprinter_line <= last; n--) {
+        int len;
+        const char* str = article_line(teleprinter_line, &len);
+        if (teleprinter_pos >= len) {
+            teleprinter_mark(teleprinter_line, from, len);
+            teleprinter_line++;
+            teleprinter_pos = 0;
+            from = 0;
+            continue;
+        }
+        do {
+            teleprinter_pos++;
+        } while (teleprinter_pos < len && (str[teleprinter_pos] & 0xC0) == 0x80);
+    }
+    if (teleprinter_line <= last) teleprinter_mark(teleprinter_line, from, teleprinter_pos);
+    
+    // Only the glyphs that just appeared are sent to the panel
+    screen_show_marked(build_article);
+    return teleprinter_line <= last;
 }
 
+// Start typing out the article body from the top of the view
+static void teleprinter_start(void) {
+    teleprinter_line = scroll_offset;
+    teleprinter_pos = 0;
+    teleprinter_last = scroll_offset + ARTICLE_LINES - 1;
+    while (teleprinter_last > scroll_offset && !article_has_line(teleprinter_last)) {
+        teleprinter_last--;
+    }
+    lcd_anim_start(&teleprinter_anim, teleprinter_step, NULL, TELEPRINTER_FRAME_MS);
+}
 
+// Show the rest of the body at once
+static void teleprinter_finish(void) {
+    if (!lcd_anim_running(&teleprinter_anim)) return;
+    
+    lcd_anim_stop(&teleprinter_anim);
+    screen_show(build_article);
+}
 
+static void build_article(lcd_dl_t* dl) {
+    Article a = guide_article(selected_article);
+    const Article* art = &a;
+    
+    lcd_dl_fill(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_BLACK);
+    
+    // Enhanced article header
+    lcd_dl_widget(dl, WIDGET_HEADER, 0, 0, 320, 50, 0, 0, 0, art->title, art->category);
+    
+    // === Enhanced Diagram area ===
+    lcd_dl_rounded(dl, 10, 55, 300, 100, 8, COLOR_BLACK);
+    lcd_dl_frame(dl, 10, 55, 300, 100, COLOR_CYAN_MEDIUM);
+    
+    // Diagrams stay inside the frame, but some reach one row below it
+    lcd_dl_widget(dl, WIDGET_DIAGRAM, 10, 55, 301, 102, selected_article, 0, 0, NULL, NULL);
+    
+    // === Teleprinter article content ===
+    // Blank the scrolling band first so diagrams cannot spill into it
+    lcd_dl_fill(dl, 0, ARTICLE_BODY_TOP, LCD_WIDTH, ARTICLE_LINES * ARTICLE_LINE_HEIGHT, COLOR_BLACK);
+    
+    // Each visible line goes into its own slot of the scrolling band
+    for (int line = scroll_offset; line < scroll_offset + ARTICLE_LINES && article_has_line(line); line++) {
+        lcd_dl_widget(dl, WIDGET_ARTICLE_LINE, 0, article_slot_row(line), LCD_WIDTH, ARTICLE_LINE_HEIGHT,
+                      selected_article, line, article_line_shown(line), NULL, NULL);
+    }
+    
+    // Footer
+    lcd_dl_text(dl, 10, 300, "UP/DOWN ESC", COLOR_GREEN);
+}
 
+void draw_article(void) {
+    // The line count is known before anything is drawn, so scroll_offset
+    // can be clamped first
+    article_open(selected_article);
+    
+    // Clamp scroll_offset so we don’t scroll past the end
+    while (scroll_offset > 0 && !article_has_line(scroll_offset + ARTICLE_LINES - 1)) {
+        scroll_offset--;
+    }
+    
+    lcd_scroll_define(ARTICLE_BODY_TOP, ARTICLE_LINES * ARTICLE_LINE_HEIGHT);
+    lcd_scroll_to(article_slot_row(scroll_offset));
+    
+    screen_show(build_article);
+}
 
+// Open the selected article at the top of its body, which the
+// teleprinter then types out
+void open_article(void) {
+    current_screen = 3;
+    scroll_offset = 0;
+    article_open(selected_article);
+    teleprinter_start();
+    draw_article();
+}
 
-
+// Scroll the article body by one line: move the scroll start, then let
+// the list diff find the one slot whose line changed
+void scroll_article(int delta) {
+    if (delta > 0) {
+        if (!article_has_line(scroll_offset + ARTICLE_LINES)) return;
+        scroll_offset++;
+    } else {
+        if (scroll_offset <= 0) return;
+        scroll_offset--;
+    }
+    
+    lcd_scroll_to(article_slot_row(scroll_offset));
+    screen_show(build_article);
+}
 
 // Case-insensitive substring search
 int strcasestr_simple(const char* haystack, const char* needle) {
@@ -795,14 +1039,15 @@ void perform_search(void) {
     
     if (search_query_len == 0) {
         // Empty search shows all articles
-        for (int i = 0; i < num_articles && num_search_results < 20; i++) {
+        for (int i = 0; i < article_pack_count() && num_search_results < 20; i++) {
             search_results[num_search_results++] = i;
         }
     } else {
         // Filter by search query
-        for (int i = 0; i < num_articles && num_search_results < 20; i++) {
-            if (strcasestr_simple(articles[i].title, search_query) ||
-                strcasestr_simple(articles[i].category, search_query)) {
+        for (int i = 0; i < article_pack_count() && num_search_results < 20; i++) {
+            Article art = guide_article(i);
+            if (strcasestr_simple(art.title, search_query) ||
+                strcasestr_simple(art.category, search_query)) {
                 search_results[num_search_results++] = i;
             }
         }
@@ -811,61 +1056,49 @@ void perform_search(void) {
     selected_search_result = 0;
 }
 
-void draw_search(void) {
-    lcd_clear(COLOR_BLACK);
+static void build_search(lcd_dl_t* dl) {
+    lcd_dl_fill(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_BLACK);
     
     // Enhanced search header
-    draw_article_header("SEARCH ENGINE", "Query");
+    lcd_dl_widget(dl, WIDGET_HEADER, 0, 0, 320, 50, 0, 0, 0, "SEARCH ENGINE", "Query");
     
     // Enhanced search box with border
-    draw_rounded_rect(10, 60, 280, 25, 5, COLOR_HGTTG_DARK);
-    lcd_rect(10, 60, 280, 25, COLOR_HGTTG_BRIGHT);
+    lcd_dl_rounded(dl, 10, 60, 280, 25, 5, COLOR_HGTTG_DARK);
+    lcd_dl_frame(dl, 10, 60, 280, 25, COLOR_HGTTG_BRIGHT);
     
     char search_display[34];
     snprintf(search_display, sizeof(search_display), "> %s_", search_query);
-    draw_large_text(15, 67, search_display, COLOR_HGTTG_BRIGHT, 1);
+    lcd_dl_large_text(dl, 15, 67, search_display, COLOR_HGTTG_BRIGHT, 1);
     
     // Enhanced results count with icon
     char count[32];
     snprintf(count, sizeof(count), "Found: %d articles", num_search_results);
-    draw_rounded_rect(10, 90, 150, 18, 3, COLOR_AMBER_DARK);
-    lcd_text(15, 95, count, COLOR_YELLOW_BRIGHT);
+    lcd_dl_rounded(dl, 10, 90, 150, 18, 3, COLOR_AMBER_DARK);
+    lcd_dl_text(dl, 15, 95, count, COLOR_YELLOW_BRIGHT);
     
     // Enhanced matching articles list
-    int y = 115;
-    int visible_results = (num_search_results < 7) ? num_search_results : 7;
+    int y = SEARCH_TOP;
+    int visible_results = (num_search_results < SEARCH_ROWS) ? num_search_results : SEARCH_ROWS;
     
     for (int i = 0; i < visible_results; i++) {
-        int article_idx = search_results[i];
-        bool is_selected = (i == selected_search_result);
-        
-        if (is_selected) {
-            draw_rounded_rect(10, y - 2, 280, 22, 5, COLOR_HGTTG_MEDIUM);
-        }
-        
-        uint32_t color = is_selected ? COLOR_BLACK : COLOR_HGTTG_BRIGHT;
-        char line[50];
-        snprintf(line, sizeof(line), "%c %s", 
-                 is_selected ? '>' : ' ',
-                 articles[article_idx].title);
-        draw_large_text(15, y + 2, line, color, 1);
-        
-        // Show category for each result
-        lcd_text(200, y + 5, articles[article_idx].category, COLOR_AMBER_MEDIUM);
-        
-        y += 25;
+        dl_list_row(dl, y, search_results[i], i == selected_search_result);
+        y += LIST_ROW_PITCH;
     }
     
     // Enhanced footer with instructions
-    draw_rounded_rect(10, 280, 280, 25, 5, COLOR_AMBER_DARK);
-    lcd_text(15, 288, "Type/Del/Enter Select  ESC Back", COLOR_YELLOW_BRIGHT);
+    lcd_dl_rounded(dl, 10, 280, 280, 25, 5, COLOR_AMBER_DARK);
+    lcd_dl_text(dl, 15, 288, "Type/Del/Enter Select  ESC Back", COLOR_YELLOW_BRIGHT);
     
     // Search results scroll indicator
-    if (num_search_results > 7) {
-        draw_scroll_indicator(300, 115, num_search_results, 7, selected_search_result);
+    if (num_search_results > SEARCH_ROWS) {
+        dl_scroll_indicator(dl, 300, SEARCH_TOP, num_search_results, SEARCH_ROWS, selected_search_result);
     }
 }
 
+void draw_search(void) {
+    screen_show(build_search);
+}
+
 uint8_t read_keyboard(void) {
     uint16_t buff = 0;
     uint8_t msg[2];
@@ -891,8 +1124,34 @@ uint8_t read_keyboard(void) {
     return 0;
 }
 
+static void build_about(lcd_dl_t* dl) {
+    lcd_dl_fill(dl, 0, 0, LCD_WIDTH, LCD_HEIGHT, COLOR_DARK);
+    lcd_dl_text(dl, 10, 50, "Hitchhiker's Guide", COLOR_HGTTG);
+    lcd_dl_text(dl, 10, 70, "PicoCalc Edition", COLOR_AMBER);
+    lcd_dl_text(dl, 10, 100, "v42.0", COLOR_GRAY);
+    lcd_dl_text(dl, 10, 130, "DON'T PANIC!", COLOR_HGTTG);
+}
+
+// The about screen goes back to the menu after ABOUT_MS or on any key
+#define ABOUT_MS    3000
+
+static lcd_anim_t about_anim;
+
+static bool about_step(lcd_anim_t* anim, int frames) {
+    (void)anim;
+    (void)frames;
+    current_screen = 1;
+    draw_menu();
+    return false;
+}
+
 void handle_input(uint8_t key) {
-    if (current_screen == 1) { // Menu
+    if (current_screen == 0 || current_screen == 5) { // Boot, About
+        lcd_anim_stop(&boot_anim);
+        lcd_anim_stop(&about_anim);
+        current_screen = 1;
+        draw_menu();
+    } else if (current_screen == 1) { // Menu
         if (key == '1') {
             current_screen = 2;
             selected_article = 0;
@@ -903,19 +1162,13 @@ void handle_input(uint8_t key) {
             search_query_len = 0;
             perform_search();
             draw_search();
-        } else if (key == '3') {
-            current_screen = 3;
-            selected_article = rand() % num_articles;
-            scroll_offset = 0;
-            draw_article();
+        } else if (key == '3' && article_pack_count() > 0) {
+            selected_article = rand() % article_pack_count();
+            open_article();
         } else if (key == '4') {
-            lcd_clear(COLOR_DARK);
-            lcd_text(10, 50, "Hitchhiker's Guide", COLOR_HGTTG);
-            lcd_text(10, 70, "PicoCalc Edition", COLOR_AMBER);
-            lcd_text(10, 100, "v42.0", COLOR_GRAY);
-            lcd_text(10, 130, "DON'T PANIC!", COLOR_HGTTG);
-            sleep_ms(3000);
-            draw_menu();
+            current_screen = 5;
+            screen_show(build_about);
+            lcd_anim_start(&about_anim, about_step, NULL, ABOUT_MS);
         }
     } else if (current_screen == 2) { // Browse
         if (key == 0xB1) { // ESC
@@ -927,27 +1180,28 @@ void handle_input(uint8_t key) {
                 draw_browse();
             }
         } else if (key == 0xB6 || key == 's' || key == 'j') { // Down
-            if (selected_article < num_articles - 1) {
+            if (selected_article < article_pack_count() - 1) {
                 selected_article++;
                 draw_browse();
             }
         } else if (key == '\n' || key == '\r' || key == ' ') { // Enter
-            current_screen = 3;
-            scroll_offset = 0;
-            draw_article();
+            open_article();
         }
     } else if (current_screen == 3) { // Article
+        // Any key but ESC first shows the rest of the body
         if (key == 0xB1) { // ESC
+            lcd_anim_stop(&teleprinter_anim);
             current_screen = 2;
+            lcd_scroll_reset();
             draw_browse();
         } else if (key == 0xB5 || key == 'w' || key == 'k') { // Up
-            if (scroll_offset > 0) {
-                scroll_offset--;
-                draw_article();
-            }
+            teleprinter_finish();
+            scroll_article(-1);
         } else if (key == 0xB6 || key == 's' || key == 'j') { // Down
-            scroll_offset++;
-            draw_article();
+            teleprinter_finish();
+            scroll_article(1);
+        } else {
+            teleprinter_finish();
         }
     } else if (current_screen == 4) { // Search
         if (key == 0xB1) { // ESC
@@ -967,9 +1221,7 @@ void handle_input(uint8_t key) {
         } else if (key == '\n' || key == '\r') { // Enter
             if (num_search_results > 0) {
                 selected_article = search_results[selected_search_result];
-                current_screen = 3;
-                scroll_offset = 0;
-                draw_article();
+                open_article();
             }
         } else if (key == 0x08 || key == 0x7F || key == 0xB2) { // Backspace/Delete
             if (search_query_len > 0) {
@@ -0,0 +1,330 @@
+/*
+ * SD card in SPI mode
+ */
+
+#include "sd_card.h"
+
+// Commands
+#define SD_CMD0     0       // GO_IDLE_STATE
+#define SD_CMD6     6       // SWITCH_FUNC
+#define SD_CMD8     8       // SEND_IF_COND
+#define SD_CMD9     9       // SEND_CSD
+#define SD_CMD12    12      // STOP_TRANSMISSION
+#define SD_CMD16    16      // SET_BLOCKLEN
+#define SD_CMD17    17      // READ_SINGLE_BLOCK
+#define SD_CMD18    18      // READ_MULTIPLE_BLOCK
+#define SD_CMD55    55      // APP_CMD
+#define SD_CMD58    58      // READ_OCR
+#define SD_CMD59    59      // CRC_ON_OFF
+#define SD_ACMD41   41      // SD_SEND_OP_COND
+
+// R1 bits
+#define SD_R1_IDLE      0x01
+#define SD_R1_ILLEGAL   0x04
+
+#define SD_TOKEN_DATA   0xFE    // data block follows
+
+#define SD_CMD0_TRIES   16
+#define SD_INIT_TRIES   4000    // ACMD41 rounds, a good second at 400 kHz
+#define SD_R1_TRIES     16      // bytes before a response is given up on
+#define SD_IF_COND      0x1AA   // 2.7-3.6 V, check pattern 0xAA
+#define SD_OCR_CCS      (1u << 30)
+
+// Clock speed the card is running at, for timeouts counted in bytes
+static uint32_t sd_clock_hz;
+
+uint8_t sd_crc7(const uint8_t* buf, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = buf[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc <<= 1;
+            if ((b ^ crc) & 0x80) crc ^= 0x09;
+            b <<= 1;
+        }
+    }
+    return (crc << 1) | 1;
+}
+
+uint16_t sd_crc16(const uint8_t* buf, size_t len) {
+    uint16_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc = (uint8_t)(crc >> 8) | (crc << 8);
+        crc ^= buf[i];
+        crc ^= (uint8_t)(crc & 0xFF) >> 4;
+        crc ^= crc << 12;
+        crc ^= (crc & 0xFF) << 5;
+    }
+    return crc;
+}
+
+static uint8_t sd_byte(const sd_bus_t* bus) {
+    uint8_t b;
+    bus->transfer(NULL, &b, 1);
+    return b;
+}
+
+static void sd_deselect(const sd_bus_t* bus) {
+    bus->select(false);
+    // The card lets go of MISO on the next clock edge
+    bus->transfer(NULL, NULL, 1);
+}
+
+// Send a command with CS already asserted and return its R1, or 0xFF if
+// none came
+static uint8_t sd_command(const sd_bus_t* bus, uint8_t cmd, uint32_t arg) {
+    uint8_t frame[7] = {
+        0xFF, 0x40 | cmd, arg >> 24, arg >> 16, arg >> 8, arg, 0
+    };
+    frame[6] = sd_crc7(frame + 1, 5);
+    bus->transfer(frame, NULL, sizeof(frame));
+    
+    // A stop also ends the block being sent, which takes a byte
+    if (cmd == SD_CMD12) sd_byte(bus);
+    
+    uint8_t r1 = 0xFF;
+    for (int i = 0; i < SD_R1_TRIES && (r1 & 0x80); i++) {
+        r1 = sd_byte(bus);
+    }
+    return r1;
+}
+
+// A command on its own, with the 4 bytes of an R3/R7 response after the
+// R1 into *extra (unless NULL)
+static uint8_t sd_command_alone(const sd_bus_t* bus, uint8_t cmd, uint32_t arg, uint32_t* extra) {
+    bus->select(true);
+    uint8_t r1 = sd_command(bus, cmd, arg);
+    if (extra) {
+        uint8_t b[4];
+        bus->transfer(NULL, b, 4);
+        *extra = (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | b[2] << 8 | b[3];
+    }
+    sd_deselect(bus);
+    return r1;
+}
+
+static uint8_t sd_app_command(const sd_bus_t* bus, uint8_t cmd, uint32_t arg) {
+    uint8_t r1 = sd_command_alone(bus, SD_CMD55, 0, NULL);
+    if (r1 & ~SD_R1_IDLE) return r1;
+    return sd_command_alone(bus, cmd, arg, NULL);
+}
+
+// Wait for the card to stop holding MISO low (busy)
+static bool sd_wait_ready(const sd_bus_t* bus) {
+    for (uint32_t i = sd_clock_hz / 8 / 2; i > 0; i--) {    // half a second
+        if (sd_byte(bus) == 0xFF) return true;
+    }
+    return false;
+}
+
+typedef enum { SD_READ_OK, SD_READ_CRC, SD_READ_FAILED } sd_read_t;
+
+// One data block of len bytes into buf: the token, the data, its CRC
+static sd_read_t sd_read_data(sd_card_t* card, uint8_t* buf, size_t len) {
+    const sd_bus_t* bus = card->bus;
+    
+    // The card has 100 ms to start a block
+    uint8_t token = 0xFF;
+    for (uint32_t i = sd_clock_hz / 8 / 10; i > 0 && token == 0xFF; i--) {
+        token = sd_byte(bus);
+    }
+    if (token != SD_TOKEN_DATA) {
+        card->error = token == 0xFF ? SD_TIMEOUT : SD_DATA_ERROR;
+        return SD_READ_FAILED;
+    }
+    
+    uint16_t crc = bus->read(buf, len);
+    uint8_t sent[2];
+    bus->transfer(NULL, sent, 2);
+    return crc == (sent[0] << 8 | sent[1]) ? SD_READ_OK : SD_READ_CRC;
+}
+
+// A command that answers with one data block
+static sd_read_t sd_command_data(sd_card_t* card, uint8_t cmd, uint32_t arg, uint8_t* buf, size_t len) {
+    const sd_bus_t* bus = card->bus;
+    
+    bus->select(true);
+    uint8_t r1 = sd_command(bus, cmd, arg);
+    sd_read_t result = SD_READ_FAILED;
+    if (r1 == 0) {
+        result = sd_read_data(card, buf, len);
+    } else {
+        card->error = r1 == 0xFF ? SD_TIMEOUT : SD_CMD_ERROR;
+    }
+    sd_deselect(bus);
+    return result;
+}
+
+// Same, sent again while the data fails its CRC
+static bool sd_command_data_retry(sd_card_t* card, uint8_t cmd, uint32_t arg, uint8_t* buf, size_t len) {
+    for (int i = 0; i < SD_RETRIES; i++) {
+        sd_read_t result = sd_command_data(card, cmd, arg, buf, len);
+        if (result == SD_READ_OK) return true;
+        if (result == SD_READ_FAILED) return false;
+        card->crc_errors++;
+    }
+    card->error = SD_DATA_ERROR;
+    return false;
+}
+
+// Card size from the CSD, either structure
+static uint32_t sd_csd_blocks(const uint8_t* csd) {
+    if ((csd[0] >> 6) == 1) {
+        uint32_t c_size = (uint32_t)(csd[7] & 0x3F) << 16 | csd[8] << 8 | csd[9];
+        return (c_size + 1) * 1024;
+    }
+    uint32_t read_bl_len = csd[5] & 0x0F;
+    uint32_t c_size = (uint32_t)(csd[6] & 0x03) << 10 | csd[7] << 2 | csd[8] >> 6;
+    uint32_t c_size_mult = (csd[9] & 0x03) << 1 | csd[10] >> 7;
+    return (c_size + 1) << (c_size_mult + 2 + read_bl_len - 9);
+}
+
+// Switch to high speed if the card has it (CMD6 function group 1)
+static bool sd_switch_high_speed(sd_card_t* card) {
+    uint8_t status[64];
+    
+    // Check first: bit 401 says it is supported, bits 379:376 that the
+    // switch would select it
+    if (!sd_command_data_retry(card, SD_CMD6, 0x00FFFFF1, status, sizeof(status))) return false;
+    if (!(status[13] & 0x02) || (status[16] & 0x0F) != 1) return false;
+    
+    if (!sd_command_data_retry(card, SD_CMD6, 0x80FFFFF1, status, sizeof(status))) return false;
+    return (status[16] & 0x0F) == 1;
+}
+
+bool sd_card_init(sd_card_t* card, const sd_bus_t* bus) {
+    card->bus = bus;
+    card->high_capacity = false;
+    card->high_speed = false;
+    card->num_blocks = 0;
+    card->crc_errors = 0;
+    
+    // 74 clocks or more with CS high put the card in SPI mode after CMD0
+    sd_clock_hz = SD_INIT_HZ;
+    bus->set_clock(SD_INIT_HZ);
+    bus->select(false);
+    bus->transfer(NULL, NULL, 10);
+    
+    uint8_t r1 = 0xFF;
+    for (int i = 0; i < SD_CMD0_TRIES && r1 != SD_R1_IDLE; i++) {
+        r1 = sd_command_alone(bus, SD_CMD0, 0, NULL);
+    }
+    if (r1 != SD_R1_IDLE) {
+        card->error = SD_NO_CARD;
+        return false;
+    }
+    
+    // Version 2 cards echo the voltage and pattern; version 1 cards do
+    // not know the command and can only be standard capacity
+    uint32_t echo;
+    r1 = sd_command_alone(bus, SD_CMD8, SD_IF_COND, &echo);
+    bool v2 = !(r1 & SD_R1_ILLEGAL);
+    if (v2 && (echo & 0xFFF) != SD_IF_COND) {
+        card->error = SD_UNUSABLE;
+        return false;
+    }
+    
+    if (sd_command_alone(bus, SD_CMD59, 1, NULL) & ~SD_R1_IDLE) {
+        card->error = SD_CMD_ERROR;
+        return false;
+    }
+    
+    r1 = SD_R1_IDLE;
+    for (int i = 0; i < SD_INIT_TRIES && r1 == SD_R1_IDLE; i++) {
+        r1 = sd_app_command(bus, SD_ACMD41, v2 ? SD_OCR_CCS : 0);
+    }
+    if (r1 != 0) {
+        card->error = r1 == SD_R1_IDLE ? SD_TIMEOUT : SD_UNUSABLE;
+        return false;
+    }
+    
+    if (v2) {
+        uint32_t ocr;
+        if (sd_command_alone(bus, SD_CMD58, 0, &ocr) != 0) {
+            card->error = SD_CMD_ERROR;
+            return false;
+        }
+        card->high_capacity = (ocr & SD_OCR_CCS) != 0;
+    }
+    if (!card->high_capacity && sd_command_alone(bus, SD_CMD16, SD_BLOCK, NULL) != 0) {
+        card->error = SD_UNUSABLE;
+        return false;
+    }
+    
+    uint8_t csd[16];
+    if (!sd_command_data_retry(card, SD_CMD9, 0, csd, sizeof(csd))) return false;
+    card->num_blocks = sd_csd_blocks(csd);
+    
+    // Cards older than CMD6 refuse it and stay at the default speed
+    card->high_speed = sd_switch_high_speed(card);
+    sd_clock_hz = card->high_speed ? SD_HIGH_SPEED_HZ : SD_DEFAULT_HZ;
+    bus->set_clock(sd_clock_hz);
+    
+    card->error = SD_OK;
+    return true;
+}
+
+// Read blocks from lba on with one CMD18, stopping at the first that
+// fails. *done is how many made it.
+static sd_read_t sd_read_run(sd_card_t* card, uint32_t lba, uint8_t* buf, uint32_t count,
+                             uint32_t* done) {
+    const sd_bus_t* bus = card->bus;
+    
+    *done = 0;
+    bus->select(true);
+    uint8_t r1 = sd_command(bus, SD_CMD18, card->high_capacity ? lba : lba * SD_BLOCK);
+    if (r1 != 0) {
+        card->error = r1 == 0xFF ? SD_TIMEOUT : SD_CMD_ERROR;
+        sd_deselect(bus);
+        return SD_READ_FAILED;
+    }
+    
+    sd_read_t result = SD_READ_OK;
+    while (*done < count) {
+        result = sd_read_data(card, buf + *done * SD_BLOCK, SD_BLOCK);
+        if (result != SD_READ_OK) break;
+        (*done)++;
+    }
+    
+    // The card carries on sending until told to stop, and is busy a while
+    // after
+    sd_command(bus, SD_CMD12, 0);
+    if (!sd_wait_ready(bus) && result == SD_READ_OK) {
+        card->error = SD_TIMEOUT;
+        result = SD_READ_FAILED;
+    }
+    sd_deselect(bus);
+    return result;
+}
+
+bool sd_card_read(sd_card_t* card, uint32_t lba, uint8_t* buf, uint32_t count) {
+    int failures = 0;
+    while (count > 0) {
+        sd_read_t result;
+        uint32_t done = 0;
+        if (count == 1) {
+            result = sd_command_data(card, SD_CMD17, card->high_capacity ? lba : lba * SD_BLOCK,
+                                     buf, SD_BLOCK);
+            if (result == SD_READ_OK) done = 1;
+        } else {
+            result = sd_read_run(card, lba, buf, count, &done);
+        }
+        if (result == SD_READ_FAILED) return false;
+    
+        // Carry on from the block that failed its CRC, giving up on one
+        // that keeps failing
+        lba += done;
+        buf += done * SD_BLOCK;
+        count -= done;
+        if (done > 0) failures = 0;
+        if (result == SD_READ_CRC) {
+            card->crc_errors++;
+            if (++failures == SD_RETRIES) {
+                card->error = SD_DATA_ERROR;
+                return false;
+            }
+        }
+    }
+    card->error = SD_OK;
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ * SD card in SPI mode
+ *
+ * Brings a card up (CMD0, CMD8, CMD55 + ACMD41, CMD58) at the 400 kHz
+ * the spec allows before that, turns on CRC checking (CMD59), switches
+ * to high speed (CMD6) if the card can, and then reads 512-byte blocks:
+ * one with CMD17, a run of them with a single CMD18. Every block's CRC16
+ * is checked, and a command whose data fails it is sent again.
+ *
+ * The protocol has no hardware dependencies. The bus the card is on is
+ * supplied by the caller: sd_spi.h drives spi0 with DMA, and host code
+ * can put a fake card behind one instead.
+ */
+
+#ifndef SD_CARD_H
+#define SD_CARD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SD_BLOCK            512
+#define SD_INIT_HZ          400000
+#define SD_DEFAULT_HZ       25000000    // default speed
+#define SD_HIGH_SPEED_HZ    50000000    // after CMD6 switches to high speed
+#define SD_RETRIES          3           // sends of a command whose data fails its CRC
+
+typedef struct {
+    void (*select)(bool selected);              // CS (true = asserted)
+    void (*set_clock)(uint32_t hz);             // at most hz
+    // Clock out len bytes of tx (0xFF for NULL) and keep what comes back
+    // in rx (unless NULL)
+    void (*transfer)(const uint8_t* tx, uint8_t* rx, size_t len);
+    // Clock in len bytes of data into buf, sending 0xFF, and return
+    // their CRC16 (sd_crc16)
+    uint16_t (*read)(uint8_t* buf, size_t len);
+} sd_bus_t;
+
+typedef enum {
+    SD_OK,
+    SD_NO_CARD,         // nothing answered CMD0
+    SD_UNUSABLE,        // a card, but not one this driver can use
+    SD_TIMEOUT,         // the card stopped answering
+    SD_CMD_ERROR,       // the card refused a command
+    SD_DATA_ERROR,      // a data error token, or bad CRCs every time
+} sd_error_t;
+
+typedef struct {
+    const sd_bus_t* bus;
+    bool high_capacity;     // SDHC/SDXC: addressed in blocks, not bytes
+    bool high_speed;
+    uint32_t num_blocks;    // from the CSD
+    uint32_t crc_errors;    // blocks read again for a bad CRC
+    sd_error_t error;       // why the last call failed
+} sd_card_t;
+
+// Bring up the card on bus. False (and card->error) if there is none or
+// it cannot be used.
+bool sd_card_init(sd_card_t* card, const sd_bus_t* bus);
+
+// Read count blocks from block lba on into buf (count * SD_BLOCK bytes)
+bool sd_card_read(sd_card_t* card, uint32_t lba, uint8_t* buf, uint32_t count);
+
+// CRC7 of a command (shifted into place, with the end bit) and CRC16 of
+// a data block, as the card computes them
+uint8_t sd_crc7(const uint8_t* buf, size_t len);
+uint16_t sd_crc16(const uint8_t* buf, size_t len);
+
+#endif // SD_CARD_H
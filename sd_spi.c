@@ -2,13 +2,22 @@
 #include "sd_spi.h"
 #include "hardware/spi.h"
 #include "hardware/gpio.h"
+#include "hardware/dma.h"
 #include "pico/stdlib.h"
 
+#define SD_SPI  spi0
 #define SD_CS   17
 #define SD_SCK  18
 #define SD_MOSI 19
 #define SD_MISO 16
 
+// Sniffer calculation: CRC-16-CCITT, the SD data CRC
+#define SD_SNIFF_CRC16  0x2
+
+static int sd_dma_tx = -1;
+static int sd_dma_rx = -1;
+static const uint8_t sd_fill = 0xFF;
+
 static inline void sd_cs_select() {
     gpio_put(SD_CS, 0);
     sleep_us(1);
@@ -20,7 +29,7 @@ static inline void sd_cs_deselect() {
 }
 
 void sd_spi_init(void) {
-    spi_init(spi0, 400000);  // Start slow
+    spi_init(SD_SPI, SD_INIT_HZ);  // Start slow
     gpio_set_function(SD_SCK, GPIO_FUNC_SPI);
     gpio_set_function(SD_MOSI, GPIO_FUNC_SPI);
     gpio_set_function(SD_MISO, GPIO_FUNC_SPI);
@@ -28,10 +37,74 @@ void sd_spi_init(void) {
     gpio_init(SD_CS);
     gpio_set_dir(SD_CS, GPIO_OUT);
     gpio_put(SD_CS, 1);
+    
+    // TX replays the fill byte, RX drains the FIFO into the buffer
+    sd_dma_tx = dma_claim_unused_channel(true);
+    sd_dma_rx = dma_claim_unused_channel(true);
+    
+    dma_channel_config c = dma_channel_get_default_config(sd_dma_tx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(SD_SPI, true));
+    dma_channel_configure(sd_dma_tx, &c, &spi_get_hw(SD_SPI)->dr, &sd_fill, 0, false);
+    
+    c = dma_channel_get_default_config(sd_dma_rx);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, false);
+    channel_config_set_write_increment(&c, true);
+    channel_config_set_dreq(&c, spi_get_dreq(SD_SPI, false));
+    channel_config_set_sniff_enable(&c, true);
+    dma_channel_configure(sd_dma_rx, &c, NULL, &spi_get_hw(SD_SPI)->dr, 0, false);
+    dma_sniffer_enable(sd_dma_rx, SD_SNIFF_CRC16, true);
 }
 
 uint8_t sd_spi_transfer(uint8_t data) {
     uint8_t rx;
-    spi_write_read_blocking(spi0, &data, &rx, 1);
+    spi_write_read_blocking(SD_SPI, &data, &rx, 1);
     return rx;
-}
\ No newline at end of file
+}
+
+static void sd_spi_bus_select(bool selected) {
+    if (selected) sd_cs_select();
+    else sd_cs_deselect();
+}
+
+static void sd_spi_bus_set_clock(uint32_t hz) {
+    spi_set_baudrate(SD_SPI, hz);
+}
+
+static void sd_spi_bus_transfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+    if (tx && rx) {
+        spi_write_read_blocking(SD_SPI, tx, rx, len);
+    } else if (tx) {
+        spi_write_blocking(SD_SPI, tx, len);
+    } else if (rx) {
+        spi_read_blocking(SD_SPI, 0xFF, rx, len);
+    } else {
+        for (size_t i = 0; i < len; i++) {
+            sd_spi_transfer(0xFF);
+        }
+    }
+}
+
+static uint16_t sd_spi_bus_read(uint8_t* buf, size_t len) {
+    dma_hw->sniff_data = 0;
+    dma_channel_set_write_addr(sd_dma_rx, buf, false);
+    dma_channel_set_trans_count(sd_dma_rx, len, false);
+    dma_channel_set_trans_count(sd_dma_tx, len, false);
+    dma_channel_set_read_addr(sd_dma_tx, &sd_fill, false);
+    
+    // Both at once, so RX is waiting before the first byte is clocked
+    dma_start_channel_mask((1u << sd_dma_tx) | (1u << sd_dma_rx));
+    dma_channel_wait_for_finish_blocking(sd_dma_rx);
+    
+    return (uint16_t)dma_hw->sniff_data;
+}
+
+const sd_bus_t sd_spi_bus = {
+    sd_spi_bus_select,
+    sd_spi_bus_set_clock,
+    sd_spi_bus_transfer,
+    sd_spi_bus_read,
+};
@@ -0,0 +1,25 @@
+/*
+ * SD card bus on spi0
+ *
+ * The sd_card.h bus for the card slot. Data blocks come in by DMA: one
+ * channel clocks out 0xFF bytes while another stores what comes back in
+ * the caller's buffer, and the DMA sniffer works out the block's CRC16
+ * on the way, so the CPU neither moves nor checksums a byte of it.
+ */
+
+#ifndef SD_SPI_H
+#define SD_SPI_H
+
+#include <stdint.h>
+#include "sd_card.h"
+
+// Bus callbacks for sd_card_init
+extern const sd_bus_t sd_spi_bus;
+
+// Set up spi0 at the 400 kHz of card init, CS and the DMA channels
+void sd_spi_init(void);
+
+// Clock one byte each way
+uint8_t sd_spi_transfer(uint8_t data);
+
+#endif // SD_SPI_H
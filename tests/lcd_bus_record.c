@@ -0,0 +1,47 @@
+/*
+ * Recording LCD bus
+ */
+
+#include "lcd_bus_record.h"
+#include <stdio.h>
+
+static char lcd_bus_record_text[LCD_BUS_RECORD_MAX];
+static size_t lcd_bus_record_len;
+
+static void lcd_bus_record_token(const char* token) {
+    size_t room = sizeof(lcd_bus_record_text) - lcd_bus_record_len;
+    int n = snprintf(lcd_bus_record_text + lcd_bus_record_len, room, "%s%s",
+                     lcd_bus_record_len ? " " : "", token);
+    if (n > 0 && (size_t)n < room) lcd_bus_record_len += n;
+}
+
+static void lcd_bus_record_select(bool selected) {
+    lcd_bus_record_token(selected ? "S" : "s");
+}
+
+static void lcd_bus_record_set_dc(bool data) {
+    lcd_bus_record_token(data ? "D" : "C");
+}
+
+static void lcd_bus_record_write(const uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02X", buf[i]);
+        lcd_bus_record_token(hex);
+    }
+}
+
+void lcd_bus_record_reset(void) {
+    lcd_bus_record_len = 0;
+    lcd_bus_record_text[0] = 0;
+}
+
+const char* lcd_bus_record_log(void) {
+    return lcd_bus_record_text;
+}
+
+const lcd_bus_t lcd_bus_record = {
+    lcd_bus_record_select,
+    lcd_bus_record_set_dc,
+    lcd_bus_record_write,
+};
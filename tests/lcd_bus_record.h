@@ -0,0 +1,27 @@
+/*
+ * Recording LCD bus
+ *
+ * An lcd_bus_t that logs what it is asked to do instead of driving a
+ * panel, as text: "S" asserts CS, "s" releases it, "C" and "D" set DC to
+ * command and data, and each byte written is two hex digits. Tokens are
+ * separated by spaces, so a window command sent in one CS assertion reads
+ *
+ *   S C 2A D 00 00 01 3F C 2B D 00 00 01 3F C 2C D
+ */
+
+#ifndef LCD_BUS_RECORD_H
+#define LCD_BUS_RECORD_H
+
+#include "lcd_cmd.h"
+
+#define LCD_BUS_RECORD_MAX  8192    // characters of log kept
+
+extern const lcd_bus_t lcd_bus_record;
+
+// Forget everything logged so far
+void lcd_bus_record_reset(void);
+
+// The log since the last reset
+const char* lcd_bus_record_log(void);
+
+#endif // LCD_BUS_RECORD_H
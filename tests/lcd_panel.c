@@ -0,0 +1,143 @@
+/*
+ * ILI9488 panel model
+ */
+
+#include "lcd_panel.h"
+#include "lcd_band.h"
+#include "lcd_dma.h"
+
+uint32_t lcd_panel[LCD_PANEL_HEIGHT][LCD_PANEL_WIDTH];
+
+static bool lcd_panel_data;
+static uint8_t lcd_panel_cmd;
+static uint8_t lcd_panel_params[4];
+static int lcd_panel_num_params;
+static int lcd_panel_x0, lcd_panel_x1, lcd_panel_y0, lcd_panel_y1;
+static int lcd_panel_x, lcd_panel_y;    // where the next pixel goes
+static uint32_t lcd_panel_pixel;
+static int lcd_panel_bytes;             // of lcd_panel_pixel received
+
+static void lcd_panel_command(uint8_t cmd) {
+    lcd_panel_cmd = cmd;
+    lcd_panel_num_params = 0;
+    lcd_panel_bytes = 0;
+    if (cmd == LCD_CMD_RAMWR) {
+        lcd_panel_x = lcd_panel_x0;
+        lcd_panel_y = lcd_panel_y0;
+    }
+}
+
+static void lcd_panel_param(uint8_t b) {
+    if (lcd_panel_num_params < 4) lcd_panel_params[lcd_panel_num_params++] = b;
+    if (lcd_panel_num_params < 4) return;
+    
+    int start = lcd_panel_params[0] << 8 | lcd_panel_params[1];
+    int end = lcd_panel_params[2] << 8 | lcd_panel_params[3];
+    if (lcd_panel_cmd == LCD_CMD_CASET) {
+        lcd_panel_x0 = start;
+        lcd_panel_x1 = end;
+    } else {
+        lcd_panel_y0 = start;
+        lcd_panel_y1 = end;
+    }
+}
+
+// One byte of pixel data; the write position wraps inside the window
+static void lcd_panel_write_byte(uint8_t b) {
+    lcd_panel_pixel = lcd_panel_pixel << 8 | b;
+    if (++lcd_panel_bytes < 3) return;
+    
+    if (lcd_panel_x < LCD_PANEL_WIDTH && lcd_panel_y < LCD_PANEL_HEIGHT) {
+        lcd_panel[lcd_panel_y][lcd_panel_x] = lcd_panel_pixel & 0xFFFFFF;
+    }
+    lcd_panel_bytes = 0;
+    if (++lcd_panel_x > lcd_panel_x1) {
+        lcd_panel_x = lcd_panel_x0;
+        if (++lcd_panel_y > lcd_panel_y1) lcd_panel_y = lcd_panel_y0;
+    }
+}
+
+static void lcd_panel_select(bool selected) {
+    (void)selected;
+}
+
+static void lcd_panel_set_dc(bool data) {
+    lcd_panel_data = data;
+}
+
+static void lcd_panel_write(const uint8_t* buf, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (!lcd_panel_data) {
+            lcd_panel_command(buf[i]);
+        } else if (lcd_panel_cmd == LCD_CMD_CASET || lcd_panel_cmd == LCD_CMD_RASET) {
+            lcd_panel_param(buf[i]);
+        } else if (lcd_panel_cmd == LCD_CMD_RAMWR || lcd_panel_cmd == LCD_CMD_RAMWRC) {
+            lcd_panel_write_byte(buf[i]);
+        }
+    }
+}
+
+const lcd_bus_t lcd_panel_bus = { lcd_panel_select, lcd_panel_set_dc, lcd_panel_write };
+
+// What main_bootloader.c provides, over the model
+
+const lcd_bus_t* lcd_bus = &lcd_panel_bus;
+
+void lcd_set_window(int x0, int y0, int x1, int y1) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_window(&list, x0, y0, x1, y1);
+    lcd_cmd_flush(&list, lcd_bus, true);
+}
+
+void lcd_continue_window(void) {
+    lcd_cmd_list_t list;
+    lcd_cmd_reset(&list);
+    lcd_cmd_continue(&list);
+    lcd_cmd_flush(&list, lcd_bus, true);
+}
+
+static void lcd_panel_fill(uint32_t remaining, uint32_t color) {
+    uint8_t rgb[3] = { color >> 16, color >> 8, color };
+    
+    while (remaining-- > 0) {
+        lcd_bus->write(rgb, 3);
+    }
+}
+
+void lcd_fill_rect(int x, int y, int w, int h, uint32_t color) {
+    if (x < 0) { w += x; x = 0; }
+    if (y < 0) { h += y; y = 0; }
+    if (x + w > LCD_PANEL_WIDTH) w = LCD_PANEL_WIDTH - x;
+    if (y + h > LCD_PANEL_HEIGHT) h = LCD_PANEL_HEIGHT - y;
+    if (w <= 0 || h <= 0) return;
+    
+    if (lcd_band_active()) {
+        lcd_band_fill(x, y, w, h, color);
+        return;
+    }
+    
+    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    lcd_panel_fill((uint32_t)w * h, color);
+    lcd_bus->select(false);
+}
+
+void lcd_dma_init(void) {
+}
+
+void lcd_dma_fill_start(int x, int y, int w, int h, uint32_t color) {
+    lcd_set_window(x, y, x + w - 1, y + h - 1);
+    lcd_panel_fill((uint32_t)w * h, color);
+}
+
+void lcd_dma_write_start(const uint8_t* buf, size_t len) {
+    lcd_bus->write(buf, len);
+}
+
+bool lcd_dma_busy(void) {
+    return false;
+}
+
+void lcd_dma_wait(void) {
+    lcd_bus->select(false);
+}
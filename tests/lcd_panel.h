@@ -0,0 +1,32 @@
+/*
+ * ILI9488 panel model
+ *
+ * An lcd_bus_t that takes what it is sent the way the panel does: CASET
+ * and RASET set the window, RAMWR writes RGB888 pixels from its top left
+ * and RAMWRC carries on where the last write stopped. What reaches the
+ * screen is kept in lcd_panel, one RGB888 value per pixel.
+ *
+ * Also provides what the display modules take from main_bootloader.c
+ * (lcd_bus, lcd_set_window, lcd_continue_window, lcd_fill_rect and the
+ * calls of lcd_dma.h), synchronous and over this bus, so they can run on
+ * the host.
+ */
+
+#ifndef LCD_PANEL_H
+#define LCD_PANEL_H
+
+#include "lcd_cmd.h"
+
+#define LCD_PANEL_WIDTH  320
+#define LCD_PANEL_HEIGHT 320
+
+extern const lcd_bus_t lcd_panel_bus;
+extern uint32_t lcd_panel[LCD_PANEL_HEIGHT][LCD_PANEL_WIDTH];
+
+// As main_bootloader.c has them
+extern const lcd_bus_t* lcd_bus;
+void lcd_set_window(int x0, int y0, int x1, int y1);
+void lcd_continue_window(void);
+void lcd_fill_rect(int x, int y, int w, int h, uint32_t color);
+
+#endif // LCD_PANEL_H
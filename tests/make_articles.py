@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+"""Write a directory of articles for the article pack round-trip test:
+long ones that take many blocks, one that ends right on a block boundary,
+Latin-1 text, runs of spaces, words too wide for a line, an empty body.
+
+Usage: make_articles.py DIR
+"""
+
+import os
+import random
+import sys
+
+WORDS = ("the guide is a very unevenly edited book and contains many passages that "
+         "simply seemed to its editors like a good idea at the time "
+         "café naïve Øresund smörgåsbord déjà vu façade Zaphod Beeblebrox "
+         "forty-two towel Magrathea Vogon poetry is the third worst in the universe").split()
+
+def body(rng, size):
+    out = []
+    length = 0
+    while length < size:
+        r = rng.random()
+        if r < 0.02:
+            word = "\n\n"
+        elif r < 0.04:
+            word = "   "
+        elif r < 0.045:
+            word = "X" * rng.randint(60, 120)      # wider than a line
+        else:
+            word = rng.choice(WORDS) + " "
+        out.append(word)
+        length += len(word.encode("utf-8"))
+    return "".join(out).rstrip() + "\n"
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit(__doc__)
+    out = sys.argv[1]
+    os.makedirs(out, exist_ok=True)
+    rng = random.Random(42)
+
+    articles = [
+        ("Long Article", "long.txt", "Tests", body(rng, 40000)),
+        ("Longer Still", "longer.txt", "Tests", body(rng, 70000)),
+        ("Block Sized", "block.txt", "Tests", "A" * 4095 + " " + "B" * 4096),
+        ("Ørsted's Café", "latin1.txt", "Catégorie", body(rng, 2000)),
+        ("Empty", "empty.txt", "Tests", ""),
+        ("One Line", "one.txt", "Tests", "mostly harmless"),
+    ]
+    for _, filename, _, text in articles:
+        with open(os.path.join(out, filename), "w", encoding="utf-8") as f:
+            f.write(text)
+    with open(os.path.join(out, "index.txt"), "w", encoding="utf-8") as f:
+        for title, filename, category, _ in articles:
+            f.write(f"{title}|{filename}|{category}\n")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,337 @@
+#!/usr/bin/env python3
+"""Write a FAT32 disk image for the fat32 host test, and beside it
+IMAGE.files/, the same tree as plain files to compare against.
+
+The image holds README.TXT and guide/: the files of GUIDE_DIR, a long
+article with a long name, big.txt (40000 numbered lines), 300 small files
+that make the directory span many clusters, and sub/deep.txt.
+
+The volume is formatted by mkfs.fat when it is on the PATH, and laid out
+the same way (fatgen103) when it is not; the files are always written by
+this script, so that the options below come out the same either way:
+
+  --sectors-per-cluster N   cluster size (1, 4 or 8 keeps the images small)
+  --partition               put the volume in an MBR partition at 1 MiB
+  --fragment                scatter every chain in runs of 1-3 clusters,
+                            and chain big.txt backwards through the volume
+  --stale-fat               turn FAT mirroring off with FAT 1 active, and
+                            fill FAT 0 with bad-cluster marks
+
+Usage: make_fat32_image.py [options] GUIDE_DIR IMAGE
+"""
+
+import argparse
+import os
+import random
+import shutil
+import struct
+import subprocess
+import tempfile
+
+SECTOR = 512
+EOC = 0x0FFFFFFF
+MIN_CLUSTERS = 65525        # fewer and it would be FAT16
+PART_START = 2048
+
+ATTR_DIRECTORY = 0x10
+ATTR_ARCHIVE = 0x20
+ATTR_VOLUME = 0x08
+ATTR_LFN = 0x0F
+
+def volume_sectors(spc):
+    # Just enough for FAT32, with a little room, in whole KiB for mkfs.fat
+    return ((MIN_CLUSTERS + 4096) * spc + 4096) // 2 * 2
+
+def boot_sector(spc, sectors, hidden):
+    """A FAT32 boot sector laid out as fatgen103 and mkfs.fat do."""
+    reserved, nfats = 32, 2
+    tmp1 = sectors - reserved
+    tmp2 = (256 * spc + nfats) // 2
+    fat_size = (tmp1 + tmp2 - 1) // tmp2
+
+    bs = bytearray(SECTOR)
+    bs[0:3] = b"\xEB\x58\x90"
+    bs[3:11] = b"mkfs.fat"
+    struct.pack_into("<HBHBHHBHHHII", bs, 11, SECTOR, spc, reserved, nfats, 0, 0,
+                     0xF8, 0, 63, 255, hidden, sectors)
+    struct.pack_into("<IHHIHH", bs, 36, fat_size, 0, 0, 2, 1, 6)
+    bs[64] = 0x80
+    bs[66] = 0x29
+    struct.pack_into("<I", bs, 67, 0x1234ABCD)
+    bs[71:82] = b"GUIDE      "
+    bs[82:90] = b"FAT32   "
+    bs[510:512] = b"\x55\xAA"
+
+    fsinfo = bytearray(SECTOR)
+    struct.pack_into("<I", fsinfo, 0, 0x41615252)
+    struct.pack_into("<III", fsinfo, 484, 0x61417272, 0xFFFFFFFF, 0xFFFFFFFF)
+    fsinfo[510:512] = b"\x55\xAA"
+
+    reserved_area = bytearray(reserved * SECTOR)
+    reserved_area[0:SECTOR] = bs
+    reserved_area[SECTOR:2 * SECTOR] = fsinfo
+    reserved_area[6 * SECTOR:7 * SECTOR] = bs
+    reserved_area[7 * SECTOR:8 * SECTOR] = fsinfo
+    return bytes(reserved_area)
+
+def format_volume(spc, sectors, hidden):
+    """The reserved sectors of a fresh volume: mkfs.fat's if there is one."""
+    mkfs = shutil.which("mkfs.fat") or shutil.which("mkfs.vfat")
+    if not mkfs:
+        return boot_sector(spc, sectors, hidden)
+
+    with tempfile.TemporaryDirectory() as tmp:
+        path = os.path.join(tmp, "volume.img")
+        subprocess.run([mkfs, "-C", "-F", "32", "-S", str(SECTOR), "-s", str(spc),
+                        "-n", "GUIDE", "-i", "1234ABCD", "-h", str(hidden),
+                        path, str(sectors * SECTOR // 1024)],
+                       check=True, stdout=subprocess.DEVNULL)
+        with open(path, "rb") as f:
+            bs = f.read(SECTOR)
+            reserved = struct.unpack_from("<H", bs, 14)[0]
+            f.seek(0)
+            return f.read(reserved * SECTOR)
+
+class Volume:
+    def __init__(self, reserved_area, rng, fragment):
+        bs = reserved_area[:SECTOR]
+        (self.spc, self.reserved, self.nfats, self.sectors, self.fat_size,
+         self.root) = (bs[13], struct.unpack_from("<H", bs, 14)[0], bs[16],
+                       struct.unpack_from("<I", bs, 32)[0], struct.unpack_from("<I", bs, 36)[0],
+                       struct.unpack_from("<I", bs, 44)[0])
+        self.reserved_area = bytearray(reserved_area)
+        self.data = self.reserved + self.nfats * self.fat_size
+        self.num_clusters = (self.sectors - self.data) // self.spc
+        assert self.num_clusters >= MIN_CLUSTERS, self.num_clusters
+
+        self.rng = rng
+        self.fragment = fragment
+        self.fat = [0] * (self.num_clusters + 2)
+        self.fat[0] = 0x0FFFFFF8
+        self.fat[1] = EOC
+        self.fat[self.root] = EOC
+        self.next_free = self.root + 1
+        self.clusters = {}          # cluster -> its bytes
+        self.stale_fat = False
+
+    @property
+    def cluster_bytes(self):
+        return self.spc * SECTOR
+
+    def chain(self, clusters):
+        for i, c in enumerate(clusters):
+            assert self.fat[c] == 0
+            self.fat[c] = clusters[i + 1] if i + 1 < len(clusters) else EOC
+        return clusters
+
+    def alloc(self, n, backwards=False):
+        if backwards:
+            clusters = list(range(self.next_free + n - 1, self.next_free - 1, -1))
+            self.next_free += n
+        elif self.fragment:
+            # Runs of 1-3 clusters with holes of 1-4 between them
+            clusters = []
+            c = self.next_free
+            while len(clusters) < n:
+                for _ in range(min(self.rng.randint(1, 3), n - len(clusters))):
+                    clusters.append(c)
+                    c += 1
+                c += self.rng.randint(1, 4)
+            self.next_free = c
+        else:
+            clusters = list(range(self.next_free, self.next_free + n))
+            self.next_free += n
+        assert self.next_free < len(self.fat)
+        return self.chain(clusters)
+
+    def write(self, data, backwards=False):
+        """Data in a chain of its own; its first cluster, or 0 if empty."""
+        cb = self.cluster_bytes
+        n = (len(data) + cb - 1) // cb
+        if n == 0:
+            return 0
+        clusters = self.alloc(n, backwards and self.fragment)
+        self.fill(clusters, data)
+        return clusters[0]
+
+    def fill(self, clusters, data):
+        cb = self.cluster_bytes
+        for i, c in enumerate(clusters):
+            self.clusters[c] = data[i * cb:(i + 1) * cb].ljust(cb, b"\0")
+
+    def save(self, path, partition):
+        start = PART_START if partition else 0
+        with open(path, "wb") as f:
+            f.truncate((start + self.sectors) * SECTOR)
+            if partition:
+                mbr = bytearray(SECTOR)
+                mbr[446:462] = struct.pack("<B3sB3sII", 0x00, b"\0\0\0", 0x0C, b"\0\0\0",
+                                           start, self.sectors)
+                mbr[510:512] = b"\x55\xAA"
+                f.write(mbr)
+
+            base = start * SECTOR
+            if self.stale_fat:
+                for bs in (0, 6 * SECTOR):
+                    struct.pack_into("<H", self.reserved_area, bs + 40, 0x80 | 1)
+            f.seek(base)
+            f.write(self.reserved_area)
+
+            table = struct.pack("<%dI" % len(self.fat), *self.fat)
+            for k in range(self.nfats):
+                f.seek(base + (self.reserved + k * self.fat_size) * SECTOR)
+                if self.stale_fat and k == 0:
+                    f.write(struct.pack("<I", 0x0FFFFFF7) * len(self.fat))
+                else:
+                    f.write(table)
+
+            for c, data in self.clusters.items():
+                f.seek(base + (self.data + (c - 2) * self.spc) * SECTOR)
+                f.write(data)
+
+def lfn_checksum(short):
+    s = 0
+    for b in short:
+        s = (((s & 1) << 7) + (s >> 1) + b) & 0xFF
+    return s
+
+SHORT_CHARS = set("ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_-~!#$%&()@^{}")
+
+def short_name(name, used):
+    """(11-byte 8.3 name, whether a long name is needed, whether it is lower case)."""
+    base, _, ext = name.rpartition(".") if "." in name else (name, "", "")
+    upper_base, upper_ext = base.upper(), ext.upper()
+    plain = (0 < len(base) <= 8 and len(ext) <= 3 and name.count(".") <= 1 and
+             set(upper_base) <= SHORT_CHARS and set(upper_ext) <= SHORT_CHARS)
+    if plain and name in (name.upper(), name.lower()):
+        return (upper_base.ljust(8) + upper_ext.ljust(3)).encode(), False, name != name.upper()
+
+    clean_base = "".join(ch for ch in upper_base if ch in SHORT_CHARS)
+    clean_ext = "".join(ch for ch in upper_ext if ch in SHORT_CHARS)[:3]
+    for n in range(1, 1000):
+        tail = "~%d" % n
+        short = (clean_base[:8 - len(tail)] + tail).ljust(8) + clean_ext.ljust(3)
+        if short not in used:
+            return short.encode(), True, False
+    raise ValueError("no short name left for " + name)
+
+def entry(short, attr, cluster, size, lower=False):
+    e = bytearray(32)
+    e[0:11] = short
+    e[11] = attr
+    e[12] = 0x18 if lower else 0        # base and extension in lower case
+    struct.pack_into("<H", e, 20, cluster >> 16)
+    struct.pack_into("<H", e, 26, cluster & 0xFFFF)
+    struct.pack_into("<I", e, 28, size)
+    return bytes(e)
+
+class Directory:
+    def __init__(self):
+        self.entries = []
+        self.used = set()
+
+    def raw(self, short, attr, cluster=0, size=0):
+        self.entries.append(entry(short, attr, cluster, size))
+
+    def add(self, name, attr, cluster, size):
+        short, long_name, lower = short_name(name, self.used)
+        self.used.add(short.decode())
+        if long_name:
+            units = [name.encode("utf-16-le")[i:i + 2] for i in range(0, 2 * len(name), 2)]
+            count = (len(units) + 12) // 13
+            if len(units) % 13:
+                units.append(b"\0\0")
+            units += [b"\xFF\xFF"] * (count * 13 - len(units))
+            for k in range(count, 0, -1):
+                part = units[(k - 1) * 13:k * 13]
+                e = bytearray(32)
+                e[0] = k | (0x40 if k == count else 0)
+                e[1:11] = b"".join(part[0:5])
+                e[11] = ATTR_LFN
+                e[13] = lfn_checksum(short)
+                e[14:26] = b"".join(part[5:11])
+                e[28:32] = b"".join(part[11:13])
+                self.entries.append(bytes(e))
+        self.entries.append(entry(short, attr, cluster, size, lower))
+
+    def data(self):
+        return b"".join(self.entries)
+
+def guide_files(guide_dir, rng):
+    files = {}
+    for name in sorted(os.listdir(guide_dir)):
+        with open(os.path.join(guide_dir, name), "rb") as f:
+            files[name] = f.read()
+    files["A Very Long Article Name About Towels.txt"] = bytes(rng.randrange(256) for _ in range(300000))
+    files["big.txt"] = b"".join(b"line %06d of a big article\n" % i for i in range(40000))
+    for i in range(300):
+        files["extra file number %d.txt" % i] = b"extra %d\n" % i
+    return files
+
+def build(args):
+    rng = random.Random(args.seed)
+    sectors = volume_sectors(args.sectors_per_cluster)
+    hidden = PART_START if args.partition else 0
+    vol = Volume(format_volume(args.sectors_per_cluster, sectors, hidden), rng, args.fragment)
+    vol.stale_fat = args.stale_fat
+
+    files = guide_files(args.guide_dir, rng)
+    deep = b"deep article\n" * 100
+    readme = b"readme at the root\n"
+
+    # guide/ first, so its own clusters can be scattered too
+    guide_entries = 2 + 2 + sum((len(name) + 12) // 13 + 1 for name in files) + 2
+    guide = vol.alloc((guide_entries * 32 + vol.cluster_bytes - 1) // vol.cluster_bytes + 1)
+    sub = vol.alloc(1)
+
+    gd = Directory()
+    gd.raw(b".          ", ATTR_DIRECTORY, guide[0])
+    gd.raw(b"..         ", ATTR_DIRECTORY)
+    # A deleted file, long name and all
+    gd.entries.append(b"\xE5" + bytes(10) + bytes([ATTR_LFN]) + bytes(20))
+    gd.entries.append(b"\xE5NDEX   TXT" + bytes(21))
+    for name, data in files.items():
+        gd.add(name, ATTR_ARCHIVE, vol.write(data, backwards=name == "big.txt"), len(data))
+    gd.add("sub", ATTR_DIRECTORY, sub[0], 0)
+
+    sd = Directory()
+    sd.raw(b".          ", ATTR_DIRECTORY, sub[0])
+    sd.raw(b"..         ", ATTR_DIRECTORY, guide[0])
+    sd.add("deep.txt", ATTR_ARCHIVE, vol.write(deep), len(deep))
+
+    root = Directory()
+    root.raw(b"GUIDE      ", ATTR_VOLUME)
+    root.add("guide", ATTR_DIRECTORY, guide[0], 0)
+    root.add("README.TXT", ATTR_ARCHIVE, vol.write(readme), len(readme))
+
+    vol.fill(guide, gd.data())
+    vol.fill(sub, sd.data())
+    vol.fill([vol.root], root.data())
+    vol.save(args.image, args.partition)
+
+    # The same tree as plain files
+    out = args.image + ".files"
+    shutil.rmtree(out, ignore_errors=True)
+    os.makedirs(os.path.join(out, "guide", "sub"))
+    for name, data in files.items():
+        with open(os.path.join(out, "guide", name), "wb") as f:
+            f.write(data)
+    with open(os.path.join(out, "guide", "sub", "deep.txt"), "wb") as f:
+        f.write(deep)
+    with open(os.path.join(out, "README.TXT"), "wb") as f:
+        f.write(readme)
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sectors-per-cluster", type=int, default=1, choices=(1, 2, 4, 8))
+    parser.add_argument("--partition", action="store_true")
+    parser.add_argument("--fragment", action="store_true")
+    parser.add_argument("--stale-fat", action="store_true")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("guide_dir")
+    parser.add_argument("image")
+    build(parser.parse_args())
+
+if __name__ == "__main__":
+    main()
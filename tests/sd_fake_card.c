@@ -0,0 +1,330 @@
+/*
+ * Fake SD card
+ */
+
+#include "sd_fake_card.h"
+#include <stdio.h>
+#include <string.h>
+
+sd_fake_card_t sd_fake_card;
+
+// Bytes the card has lined up to send, oldest first
+static uint8_t sd_fake_out[1 << 16];
+static uint32_t sd_fake_head, sd_fake_tail;
+
+// The command coming in
+static uint8_t sd_fake_frame[6];
+static int sd_fake_frame_len;
+
+static bool sd_fake_selected;
+static bool sd_fake_idle;
+static bool sd_fake_crc_on;
+static bool sd_fake_app;            // the last command was CMD55
+static bool sd_fake_seen_cmd0;
+static int sd_fake_acmd41s;
+static uint32_t sd_fake_blocks_sent;
+
+// CMD18 in progress
+static bool sd_fake_streaming;
+static bool sd_fake_stream_ended;   // out of range: nothing more comes
+static uint32_t sd_fake_stream_lba;
+
+static char sd_fake_log_text[SD_FAKE_CARD_LOG_MAX];
+static size_t sd_fake_log_len;
+
+static void sd_fake_put(uint8_t b) {
+    sd_fake_out[sd_fake_tail++ % sizeof(sd_fake_out)] = b;
+}
+
+static uint32_t sd_fake_queued(void) {
+    return sd_fake_tail - sd_fake_head;
+}
+
+static void sd_fake_drop(void) {
+    sd_fake_head = sd_fake_tail;
+}
+
+static void sd_fake_log_command(const char* prefix, int cmd) {
+    size_t room = sizeof(sd_fake_log_text) - sd_fake_log_len;
+    int n = snprintf(sd_fake_log_text + sd_fake_log_len, room, "%s%s%d",
+                     sd_fake_log_len ? " " : "", prefix, cmd);
+    if (n > 0 && (size_t)n < room) sd_fake_log_len += n;
+}
+
+void sd_fake_card_block(uint32_t lba, uint8_t* buf) {
+    for (int i = 0; i < SD_BLOCK; i++) {
+        buf[i] = (uint8_t)(lba * 7 + (lba >> 8) * 3 + i * 13 + (i >> 5));
+    }
+}
+
+// A data block after a few bytes of the card thinking about it
+static void sd_fake_data(const uint8_t* data, size_t len) {
+    for (uint32_t i = 0; i < sd_fake_blocks_sent % 4; i++) sd_fake_put(0xFF);
+    sd_fake_put(0xFE);
+    for (size_t i = 0; i < len; i++) sd_fake_put(data[i]);
+    
+    uint16_t crc = sd_crc16(data, len);
+    sd_fake_blocks_sent++;
+    bool fail = sd_fake_card.crc_fail_every && sd_fake_blocks_sent % sd_fake_card.crc_fail_every == 0;
+    if (sd_fake_card.crc_fail_next > 0) {
+        sd_fake_card.crc_fail_next--;
+        fail = true;
+    }
+    if (fail) {
+        crc ^= 1;
+        sd_fake_card.broken_blocks++;
+    }
+    sd_fake_put(crc >> 8);
+    sd_fake_put(crc);
+}
+
+// Block lba, or the out-of-range error token in its place
+static bool sd_fake_block(uint32_t lba) {
+    if (lba >= sd_fake_card.num_blocks) {
+        sd_fake_put(0x08);
+        return false;
+    }
+    uint8_t buf[SD_BLOCK];
+    sd_fake_card_block(lba, buf);
+    sd_fake_data(buf, sizeof(buf));
+    return true;
+}
+
+static void sd_fake_csd(void) {
+    uint8_t csd[16] = { 0 };
+    if (sd_fake_card.high_capacity) {
+        uint32_t c_size = sd_fake_card.num_blocks / 1024 - 1;
+        csd[0] = 0x40;
+        csd[7] = (c_size >> 16) & 0x3F;
+        csd[8] = c_size >> 8;
+        csd[9] = c_size;
+    } else {
+        // 512-byte blocks (READ_BL_LEN 9) and C_SIZE_MULT 7: 512 per C_SIZE
+        uint32_t c_size = sd_fake_card.num_blocks / 512 - 1;
+        csd[5] = 0x09;
+        csd[6] = (c_size >> 10) & 0x03;
+        csd[7] = c_size >> 2;
+        csd[8] = (c_size & 0x03) << 6;
+        csd[9] = 0x03;
+        csd[10] = 0x80;
+    }
+    sd_fake_data(csd, sizeof(csd));
+}
+
+static void sd_fake_command(void) {
+    int cmd = sd_fake_frame[0] & 0x3F;
+    uint32_t arg = (uint32_t)sd_fake_frame[1] << 24 | sd_fake_frame[2] << 16 |
+                   sd_fake_frame[3] << 8 | sd_fake_frame[4];
+    bool app = sd_fake_app;
+    sd_fake_app = false;
+    uint8_t idle = sd_fake_idle ? 0x01 : 0x00;
+    
+    sd_fake_log_command(app ? "ACMD" : "CMD", cmd);
+    
+    // A stop ends the block being sent with one more byte, then the
+    // card is busy a little while
+    if (cmd == 12 && sd_fake_streaming) {
+        sd_fake_streaming = false;
+        sd_fake_drop();
+        sd_fake_put(0xFF);
+        sd_fake_put(0x00);
+        for (int i = 0; i < 5; i++) sd_fake_put(0x00);
+        return;
+    }
+    
+    sd_fake_put(0xFF);
+    
+    // CMD0 and CMD8 always carry a real CRC; the rest once CMD59 asks
+    if ((sd_fake_crc_on || cmd == 0 || cmd == 8) && sd_crc7(sd_fake_frame, 5) != sd_fake_frame[5]) {
+        sd_fake_card.bad_crcs++;
+        sd_fake_put(0x08 | idle);
+        return;
+    }
+    
+    switch (app ? 100 + cmd : cmd) {
+    case 0:
+        if (!sd_fake_seen_cmd0) sd_fake_card.cmd0_clock_hz = sd_fake_card.clock_hz;
+        sd_fake_seen_cmd0 = true;
+        sd_fake_idle = true;
+        sd_fake_crc_on = false;
+        sd_fake_put(0x01);
+        break;
+    case 8:
+        if (sd_fake_card.version < 2) {
+            sd_fake_put(0x04 | idle);
+            break;
+        }
+        sd_fake_put(idle);
+        sd_fake_put(0x00);
+        sd_fake_put(0x00);
+        sd_fake_put((arg >> 8) & 0x0F);
+        sd_fake_put(arg);
+        break;
+    case 59:
+        sd_fake_crc_on = arg & 1;
+        sd_fake_put(idle);
+        break;
+    case 55:
+        sd_fake_app = true;
+        sd_fake_put(idle);
+        break;
+    case 100 + 41:
+        if (sd_fake_card.idle_rounds && ++sd_fake_acmd41s >= sd_fake_card.idle_rounds) {
+            sd_fake_idle = false;
+        }
+        sd_fake_put(sd_fake_idle ? 0x01 : 0x00);
+        break;
+    case 58: {
+        uint32_t ocr = 0x00FF8000;
+        if (!sd_fake_idle) ocr |= 0x80000000 | (sd_fake_card.high_capacity ? 1u << 30 : 0);
+        sd_fake_put(idle);
+        for (int shift = 24; shift >= 0; shift -= 8) sd_fake_put(ocr >> shift);
+        break;
+    }
+    case 16:
+        sd_fake_put(idle ? 0x05 : arg == SD_BLOCK ? 0x00 : 0x40);
+        break;
+    case 9:
+        if (idle) {
+            sd_fake_put(0x05);
+            break;
+        }
+        sd_fake_put(0x00);
+        sd_fake_csd();
+        break;
+    case 6: {
+        if (idle || !sd_fake_card.high_speed) {
+            sd_fake_put(0x04 | idle);
+            break;
+        }
+        // Function 1 of group 1 supported (bit 401) and selected
+        uint8_t status[64] = { 0 };
+        status[13] = 0x03;
+        status[16] = 0x01;
+        sd_fake_put(0x00);
+        sd_fake_data(status, sizeof(status));
+        break;
+    }
+    case 17:
+    case 18: {
+        if (idle) {
+            sd_fake_put(0x05);
+            break;
+        }
+        if (!sd_fake_card.high_capacity && arg % SD_BLOCK) {
+            sd_fake_put(0x20);
+            break;
+        }
+        uint32_t lba = sd_fake_card.high_capacity ? arg : arg / SD_BLOCK;
+        sd_fake_put(0x00);
+        if (cmd == 18) {
+            sd_fake_streaming = true;
+            sd_fake_stream_ended = false;
+            sd_fake_stream_lba = lba;
+        } else if (!sd_fake_card.stall) {
+            sd_fake_block(lba);
+        }
+        break;
+    }
+    default:
+        sd_fake_put(0x04 | idle);
+        break;
+    }
+}
+
+static uint8_t sd_fake_clock(uint8_t in) {
+    if (!sd_fake_card.present) return 0xFF;
+    if (!sd_fake_selected) {
+        if (!sd_fake_seen_cmd0) sd_fake_card.idle_bytes++;
+        return 0xFF;
+    }
+    
+    // Everything but a stop is ignored while blocks are streaming out
+    if (sd_fake_frame_len > 0 || (in & 0xC0) == 0x40) {
+        sd_fake_frame[sd_fake_frame_len++] = in;
+        if (sd_fake_frame_len == sizeof(sd_fake_frame)) {
+            sd_fake_frame_len = 0;
+            if (!sd_fake_streaming || (sd_fake_frame[0] & 0x3F) == 12) {
+                uint8_t out = sd_fake_queued() ? sd_fake_out[sd_fake_head++ % sizeof(sd_fake_out)] : 0xFF;
+                sd_fake_command();
+                return out;
+            }
+        }
+    }
+    
+    if (sd_fake_streaming && !sd_fake_stream_ended && !sd_fake_card.stall &&
+        sd_fake_queued() < SD_BLOCK + 8) {
+        sd_fake_stream_ended = !sd_fake_block(sd_fake_stream_lba++);
+    }
+    return sd_fake_queued() ? sd_fake_out[sd_fake_head++ % sizeof(sd_fake_out)] : 0xFF;
+}
+
+static void sd_fake_select(bool selected) {
+    sd_fake_selected = selected;
+    if (!selected) {
+        sd_fake_frame_len = 0;
+        if (!sd_fake_streaming) sd_fake_drop();
+    }
+}
+
+static void sd_fake_set_clock(uint32_t hz) {
+    sd_fake_card.clock_hz = hz;
+}
+
+static void sd_fake_transfer(const uint8_t* tx, uint8_t* rx, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        uint8_t b = sd_fake_clock(tx ? tx[i] : 0xFF);
+        if (rx) rx[i] = b;
+    }
+}
+
+static uint16_t sd_fake_read(uint8_t* buf, size_t len) {
+    sd_fake_transfer(NULL, buf, len);
+    return sd_crc16(buf, len);
+}
+
+const sd_bus_t sd_fake_card_bus = {
+    sd_fake_select,
+    sd_fake_set_clock,
+    sd_fake_transfer,
+    sd_fake_read,
+};
+
+void sd_fake_card_defaults(void) {
+    memset(&sd_fake_card, 0, sizeof(sd_fake_card));
+    sd_fake_card.present = true;
+    sd_fake_card.version = 2;
+    sd_fake_card.high_capacity = true;
+    sd_fake_card.high_speed = true;
+    sd_fake_card.num_blocks = 1 << 20;
+    sd_fake_card.idle_rounds = 50;
+}
+
+void sd_fake_card_reset(void) {
+    sd_fake_card.clock_hz = 0;
+    sd_fake_card.cmd0_clock_hz = 0;
+    sd_fake_card.idle_bytes = 0;
+    sd_fake_card.bad_crcs = 0;
+    sd_fake_card.broken_blocks = 0;
+    
+    sd_fake_head = sd_fake_tail = 0;
+    sd_fake_frame_len = 0;
+    sd_fake_selected = false;
+    sd_fake_idle = true;
+    sd_fake_crc_on = false;
+    sd_fake_app = false;
+    sd_fake_seen_cmd0 = false;
+    sd_fake_acmd41s = 0;
+    sd_fake_blocks_sent = 0;
+    sd_fake_streaming = false;
+    sd_fake_card_clear_log();
+}
+
+const char* sd_fake_card_log(void) {
+    return sd_fake_log_text;
+}
+
+void sd_fake_card_clear_log(void) {
+    sd_fake_log_len = 0;
+    sd_fake_log_text[0] = 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * Fake SD card
+ *
+ * An sd_bus_t with a card behind it that answers the SPI-mode protocol:
+ * CMD0, CMD8 (version 2 only), CMD59, CMD55 + ACMD41, CMD58, CMD16, CMD9,
+ * CMD6 (if it has high speed), CMD17, CMD18 and CMD12. Once CMD59 turns
+ * CRC checking on, a command with a bad CRC7 is refused, as a real card
+ * does. Block lba holds sd_fake_card_block(lba).
+ *
+ * What kind of card it is and how it misbehaves is set in sd_fake_card
+ * before sd_fake_card_reset(). Every command it accepts is logged, as
+ * "CMD0 CMD8 CMD59 CMD55 ACMD41 ...".
+ */
+
+#ifndef SD_FAKE_CARD_H
+#define SD_FAKE_CARD_H
+
+#include "sd_card.h"
+
+#define SD_FAKE_CARD_LOG_MAX    8192    // characters of log kept
+
+typedef struct {
+    // The card
+    bool present;           // false: nothing on the bus at all
+    int version;            // 1: does not know CMD8
+    bool high_capacity;
+    bool high_speed;        // answers CMD6
+    uint32_t num_blocks;    // reads past this get an out-of-range token
+
+    // How it misbehaves
+    int idle_rounds;        // ACMD41s before it is ready, 0 for never
+    int crc_fail_every;     // every nth data block goes out with a bad CRC
+    int crc_fail_next;      // so do the next n, counting down
+    bool stall;             // accepts reads, then never sends the data
+
+    // What it saw
+    uint32_t clock_hz;      // set_clock
+    uint32_t cmd0_clock_hz; // the clock when CMD0 came
+    uint32_t idle_bytes;    // clocked with CS high before CMD0
+    uint32_t bad_crcs;      // commands refused for their CRC7
+    uint32_t broken_blocks; // data blocks sent with a bad CRC16
+} sd_fake_card_t;
+
+extern sd_fake_card_t sd_fake_card;
+extern const sd_bus_t sd_fake_card_bus;
+
+// A ready, high-capacity, high-speed version 2 card of 1M blocks
+void sd_fake_card_defaults(void);
+
+// Power the card up again as sd_fake_card describes, clearing the log and
+// what it saw
+void sd_fake_card_reset(void);
+
+// The contents of block lba
+void sd_fake_card_block(uint32_t lba, uint8_t* buf);
+
+// Commands accepted since the last reset or sd_fake_card_clear_log()
+const char* sd_fake_card_log(void);
+void sd_fake_card_clear_log(void);
+
+#endif // SD_FAKE_CARD_H
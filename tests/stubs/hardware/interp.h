@@ -0,0 +1,64 @@
+/*
+ * Host stand-in for the SIO interpolators
+ *
+ * Just the lane arithmetic lcd_fb uses: result = base + ((accum >> shift)
+ * & mask). The base is pointer sized, so a lane result can be dereferenced
+ * on a 64-bit host as on the RP2040.
+ */
+
+#ifndef HARDWARE_INTERP_H
+#define HARDWARE_INTERP_H
+
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+typedef struct {
+    uint shift;
+    uint mask_lsb;
+    uint mask_msb;
+} interp_config;
+
+typedef struct {
+    uint32_t accum[2];
+    uintptr_t base[2];
+    interp_config config[2];
+} interp_hw_t;
+
+extern interp_hw_t host_interp[2];
+#define interp0 (&host_interp[0])
+#define interp1 (&host_interp[1])
+
+static inline interp_config interp_default_config(void) {
+    interp_config c = { 0, 0, 31 };
+    return c;
+}
+
+static inline void interp_config_set_shift(interp_config* c, uint shift) {
+    c->shift = shift;
+}
+
+static inline void interp_config_set_mask(interp_config* c, uint lsb, uint msb) {
+    c->mask_lsb = lsb;
+    c->mask_msb = msb;
+}
+
+static inline void interp_set_config(interp_hw_t* interp, uint lane, interp_config* c) {
+    interp->config[lane] = *c;
+}
+
+static inline void interp_set_base(interp_hw_t* interp, uint lane, uintptr_t base) {
+    interp->base[lane] = base;
+}
+
+static inline void interp_set_accumulator(interp_hw_t* interp, uint lane, uint32_t value) {
+    interp->accum[lane] = value;
+}
+
+static inline uintptr_t interp_peek_lane_result(interp_hw_t* interp, uint lane) {
+    const interp_config* c = &interp->config[lane];
+    uint32_t mask = (uint32_t)(0xFFFFFFFFull >> (31 - c->mask_msb)) & ~((1u << c->mask_lsb) - 1);
+    return interp->base[lane] + ((interp->accum[lane] >> c->shift) & mask);
+}
+
+#endif // HARDWARE_INTERP_H
@@ -0,0 +1,13 @@
+/*
+ * Host stand-in for pico.h
+ *
+ * Just what a generated article pack uses: on the host it is ordinary
+ * read-only data.
+ */
+
+#ifndef PICO_H
+#define PICO_H
+
+#define __in_flash(group)
+
+#endif // PICO_H
@@ -0,0 +1,42 @@
+/*
+ * Host test checks
+ *
+ * CHECK counts a condition and reports it if false; a test's main ends
+ * with `return test_report();`, which fails the ctest run if anything did.
+ */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+static int test_checks;
+static int test_failures;
+
+#define CHECK(cond) do { \
+        test_checks++; \
+        if (!(cond)) { \
+            test_failures++; \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+        } \
+    } while (0)
+
+// Two strings equal, printing both if not
+#define CHECK_STR(got, want) do { \
+        const char* got_ = (got); \
+        const char* want_ = (want); \
+        test_checks++; \
+        if (strcmp(got_, want_) != 0) { \
+            test_failures++; \
+            printf("%s:%d: %s\n  got  \"%s\"\n  want \"%s\"\n", __FILE__, __LINE__, #got, got_, want_); \
+        } \
+    } while (0)
+
+static inline int test_report(void) {
+    printf("%d checks, %d failed\n", test_checks, test_failures);
+    return test_failures ? 1 : 0;
+}
+
+#endif // TEST_H
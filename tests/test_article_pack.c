@@ -0,0 +1,175 @@
+/*
+ * Article pack round trip
+ *
+ * guide_pack is packed by article_manager.py at build time from the
+ * directory given on the command line. Every article read back through
+ * article_pack.c has to match its source file: title, category, the body
+ * folded to upper case as LCD_GLYPH_UPPER folds it, and line tables that
+ * break exactly where lcd_metrics_wrap does. Then damaged headers have to
+ * be turned away.
+ *
+ * Usage: test_article_pack DIR
+ */
+
+#include "article_pack.h"
+#include "lcd_metrics.h"
+#include "test.h"
+#include <stdlib.h>
+
+static char* slurp(const char* path, long* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("cannot read %s\n", path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != (size_t)*size) *size = 0;
+    data[*size] = 0;
+    fclose(f);
+    return data;
+}
+
+// As article_manager.py: trailing newlines dropped, a-z and the Latin-1
+// letters (U+00E0..U+00FE but U+00F7) upper-cased
+static void fold_upper(char* text, long* len) {
+    while (*len > 0 && text[*len - 1] == '\n') (*len)--;
+    
+    for (long i = 0; i < *len; i++) {
+        uint8_t c = text[i];
+        if (c >= 'a' && c <= 'z') {
+            text[i] -= 32;
+        } else if (c == 0xC3 && i + 1 < *len) {
+            uint8_t next = text[i + 1];
+            if (next >= 0xA0 && next <= 0xBE && next != 0xB7) text[i + 1] -= 32;
+            i++;
+        }
+    }
+}
+
+static void check_article(int index, const char* title, const char* category, char* body, long len) {
+    Article art;
+    
+    CHECK(article_pack_get(index, &art));
+    CHECK_STR(art.title, title);
+    CHECK_STR(art.category, category);
+    CHECK(art.size == (uint32_t)len);
+    CHECK(art.layout.scale == 1 && art.layout.flags == 0 && art.layout.width == 305);
+    
+    // All of it at once, then pieces that start and end all over the blocks
+    char* got = malloc(len + ARTICLE_PACK_BLOCK);
+    CHECK(art.read(art.source, 0, (uint8_t*)got, len + 10) == len);
+    CHECK(memcmp(got, body, len) == 0);
+    bool same = true;
+    for (long at = 0; at < len; at += 1237) {
+        for (int n = 1; n < 3 * ARTICLE_PACK_BLOCK; n = n * 3 + 1) {
+            int want = at + n > len ? len - at : n;
+            same &= art.read(art.source, at, (uint8_t*)got, n) == want;
+            same &= memcmp(got, body + at, want) == 0;
+        }
+    }
+    CHECK(same);
+    CHECK(art.read(art.source, len, (uint8_t*)got, 10) == 0);
+    free(got);
+    
+    // Line tables as lcd_metrics_wrap breaks the text
+    int line = 0;
+    long start = 0;
+    same = true;
+    do {
+        int next;
+        int n = lcd_metrics_wrap(body + start, len - start, 1, 0, 305, &next);
+        same &= line < art.num_lines;
+        if (!same) break;
+        same &= art.line_starts[line] == (uint32_t)start && art.line_lengths[line] == n;
+        start += next;
+        line++;
+    } while (start < len);
+    CHECK(same && line == art.num_lines);
+    if (!same) printf("  %s: line %d differs\n", title, line);
+}
+
+// Damaged or foreign packs are turned away and leave no articles
+static void test_damaged(void) {
+    const article_pack_header_t* h = (const article_pack_header_t*)guide_pack;
+    uint32_t* copy = malloc(h->size);
+    article_pack_header_t* c = (article_pack_header_t*)copy;
+    
+    memcpy(copy, guide_pack, h->size);
+    CHECK(article_pack_open((const uint8_t*)copy));
+    
+    c->magic ^= 1;
+    CHECK(!article_pack_open((const uint8_t*)copy) && article_pack_count() == 0);
+    c->magic ^= 1;
+    c->version++;
+    CHECK(!article_pack_open((const uint8_t*)copy));
+    c->version--;
+    c->entry_size += 4;
+    CHECK(!article_pack_open((const uint8_t*)copy));
+    c->entry_size -= 4;
+    c->block_size = ARTICLE_PACK_BLOCK + 1;
+    CHECK(!article_pack_open((const uint8_t*)copy));
+    c->block_size = h->block_size;
+    
+    // Shrunk until the last article's tables are outside it
+    c->size = h->size - 4;
+    CHECK(!article_pack_open((const uint8_t*)copy));
+    c->size = h->size;
+    CHECK(article_pack_open((const uint8_t*)copy));
+    
+    // A line longer than the reader fetches, though inside its body (of
+    // which only long texts have room)
+    Article art;
+    int i = 0;
+    while (article_pack_get(i, &art) && art.size <= ARTICLE_READER_MAX_LINE) i++;
+    if (i < article_pack_count() && art.num_lines > 0) {
+        uint16_t* lengths = (uint16_t*)art.line_lengths;
+        uint16_t len = lengths[0];
+        lengths[0] = ARTICLE_READER_MAX_LINE + 1;
+        CHECK(!article_pack_open((const uint8_t*)copy));
+        lengths[0] = len;
+        CHECK(article_pack_open((const uint8_t*)copy));
+    }
+    
+    free(copy);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        printf("usage: test_article_pack DIR\n");
+        return 1;
+    }
+    
+    CHECK(article_pack_open(guide_pack));
+    
+    char path[512];
+    long size;
+    snprintf(path, sizeof(path), "%s/index.txt", argv[1]);
+    char* index = slurp(path, &size);
+    
+    int count = 0;
+    for (char* line = strtok(index, "\n"); line; line = strtok(NULL, "\n")) {
+        char* title = line;
+        char* file = strchr(title, '|');
+        char* category = file ? strchr(file + 1, '|') : NULL;
+        if (!category) continue;
+        *file++ = 0;
+        *category++ = 0;
+    
+        snprintf(path, sizeof(path), "%s/%s", argv[1], file);
+        char* body = slurp(path, &size);
+        fold_upper(body, &size);
+        check_article(count++, title, category, body, size);
+        free(body);
+    }
+    free(index);
+    
+    CHECK(count > 0 && article_pack_count() == count);
+    Article art;
+    CHECK(!article_pack_get(count, &art) && !article_pack_get(-1, &art));
+    
+    test_damaged();
+    return test_report();
+}
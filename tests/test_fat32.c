@@ -0,0 +1,348 @@
+/*
+ * fat32 host test
+ *
+ * Reads the images make_fat32_image.py writes (contiguous and fragmented
+ * chains, a backwards one, a partition, a stale FAT, 1-8 sectors per
+ * cluster) and compares every file with the plain copy beside the image:
+ * whole, in random pieces, and streamed through article_reader, counting
+ * the FAT sectors it takes. Then the first image is damaged as it is
+ * read: chains cut short, into free or bad clusters, past the volume or
+ * round in a loop; boot sectors that are not FAT32; read errors; and
+ * random bytes all over its FATs and directories.
+ *
+ * Usage: test_fat32 IMAGE...
+ */
+
+#define _GNU_SOURCE
+#include "fat32.h"
+#include "article_reader.h"
+#include "test.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define PATCHES_MAX 256
+
+// A disk image, with bytes changed as it is read
+typedef struct {
+    int fd;                 // -1: every sector reads as zeros
+    uint32_t reads;
+    int64_t fail_after;     // reads that succeed before they all fail, -1 for all
+    int num_patches;
+    struct {
+        uint64_t offset;
+        uint8_t value;
+    } patches[PATCHES_MAX];
+} image_t;
+
+static bool image_read(void* device, uint32_t lba, uint8_t* buf, uint32_t count) {
+    image_t* img = device;
+    if (img->fail_after >= 0 && img->reads >= img->fail_after) return false;
+    img->reads++;
+    
+    uint64_t start = (uint64_t)lba * FAT32_SECTOR;
+    size_t len = (size_t)count * FAT32_SECTOR;
+    if (img->fd < 0) {
+        memset(buf, 0, len);
+    } else if (pread(img->fd, buf, len, start) != (ssize_t)len) {
+        return false;
+    }
+    for (int i = 0; i < img->num_patches; i++) {
+        uint64_t at = img->patches[i].offset;
+        if (at >= start && at < start + len) buf[at - start] = img->patches[i].value;
+    }
+    return true;
+}
+
+static void patch8(image_t* img, uint64_t offset, uint8_t value) {
+    if (img->num_patches < PATCHES_MAX) {
+        img->patches[img->num_patches].offset = offset;
+        img->patches[img->num_patches++].value = value;
+    }
+}
+
+static void patch32(image_t* img, uint64_t offset, uint32_t value) {
+    for (int i = 0; i < 4; i++) patch8(img, offset + i, value >> (i * 8));
+}
+
+static uint32_t le32(const uint8_t* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint8_t* slurp(const char* path, long* size) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("cannot read %s\n", path);
+        exit(1);
+    }
+    fseek(f, 0, SEEK_END);
+    *size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* data = malloc(*size + 1);
+    if (fread(data, 1, *size, f) != (size_t)*size) *size = 0;
+    fclose(f);
+    return data;
+}
+
+// path on the volume against local, its plain copy
+static void compare(fat32_t* vol, const char* path, const char* local, unsigned seed) {
+    long n;
+    uint8_t* want = slurp(local, &n);
+    uint8_t* got = malloc(n + 20000);
+    fat32_file_t file;
+    
+    bool opened = fat32_open(vol, &file, path);
+    CHECK(opened);
+    if (!opened) {
+        printf("  %s: error %d\n", path, vol->error);
+        free(got);
+        free(want);
+        return;
+    }
+    CHECK(file.size == (uint32_t)n);
+    CHECK(fat32_read(&file, 0, got, n) == n && memcmp(got, want, n) == 0);
+    CHECK(fat32_read(&file, n, got, 10) == 0);
+    
+    bool pieces = true;
+    srand(seed);
+    for (int i = 0; i < 2000 && n > 0; i++) {
+        uint32_t offset = rand() % n;
+        int len = rand() % 3 ? rand() % 700 : rand() % 20000;
+        int expect = offset + len > (uint32_t)n ? n - offset : len;
+        pieces &= fat32_read(&file, offset, got, len) == expect && memcmp(got, want + offset, expect) == 0;
+    }
+    CHECK(pieces);
+    
+    // Once the chain is known, a file in no more runs than are kept is
+    // read anywhere without the FAT
+    if (file.every == 1) {
+        uint32_t fat_reads = vol->fat_reads;
+        for (int i = 0; i < 500 && n > 0; i++) fat32_read(&file, rand() % n, got, 100);
+        CHECK(vol->fat_reads == fat_reads);
+    }
+    
+    // Reading straight through in small pieces walks the chain once, as
+    // reading it all in one go does
+    fat32_open(vol, &file, path);
+    uint32_t fat_reads = vol->fat_reads;
+    for (long offset = 0; offset < n; offset += 300) fat32_read(&file, offset, got, 300);
+    uint32_t in_pieces = vol->fat_reads - fat_reads;
+    
+    vol->fat_lba = 0;
+    fat32_open(vol, &file, path);
+    fat_reads = vol->fat_reads;
+    fat32_read(&file, 0, got, n);
+    CHECK(in_pieces <= vol->fat_reads - fat_reads + 1);
+    
+    free(got);
+    free(want);
+}
+
+static void test_image(const char* image) {
+    static const char* names[] = {
+        "index.txt", "babel_fish.txt", "earth.txt", "s-l1600.jpg", "sd_card_lib.h", "vogons.txt",
+        "big.txt", "A Very Long Article Name About Towels.txt", "extra file number 299.txt",
+        "sub/deep.txt",
+    };
+    image_t img = { open(image, O_RDONLY), 0, -1, 0 };
+    char path[512], local[512];
+    fat32_t vol;
+    fat32_file_t file;
+    
+    printf("%s\n", image);
+    bool mounted = fat32_mount(&vol, image_read, &img);
+    CHECK(mounted);
+    if (!mounted) return;
+    
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        snprintf(path, sizeof(path), "guide/%s", names[i]);
+        snprintf(local, sizeof(local), "%s.files/guide/%s", image, names[i]);
+        compare(&vol, path, local, i);
+    }
+    snprintf(local, sizeof(local), "%s.files/README.TXT", image);
+    compare(&vol, "readme.txt", local, 20);
+    
+    // Any case, either name, extra slashes, "." and ".."
+    snprintf(local, sizeof(local), "%s.files/guide/sub/deep.txt", image);
+    compare(&vol, "/GUIDE//SUB/Deep.TXT", local, 21);
+    snprintf(local, sizeof(local), "%s.files/guide/index.txt", image);
+    compare(&vol, "guide/sub/../INDEX.TXT", local, 22);
+    compare(&vol, "guide/sub/.././index.txt", local, 22);
+    snprintf(local, sizeof(local), "%s.files/guide/A Very Long Article Name About Towels.txt", image);
+    compare(&vol, "guide/a very long article name about towels.TXT", local, 23);
+    compare(&vol, "guide/AVERYL~1.TXT", local, 23);
+    snprintf(local, sizeof(local), "%s.files/guide/babel_fish.txt", image);
+    compare(&vol, "guide/BABEL_~1.TXT", local, 24);
+    
+    // Near misses, directories, the volume label and deleted entries
+    static const char* missing[] = {
+        "guide/nope.txt", "guide", "guide/index.txt/x", "guide/index.tx", "guide/index.txtx",
+        "guide/babel_fish.tx", "guide/babel_fish.txt2", "guide/A Very Long Article Name About Towels.tx",
+        "guide/extra file number 300.txt", "", "GUIDE      ", "guide/NDEX.TXT",
+    };
+    for (size_t i = 0; i < sizeof(missing) / sizeof(missing[0]); i++) {
+        CHECK(!fat32_open(&vol, &file, missing[i]) && vol.error == FAT32_NOT_FOUND);
+    }
+    
+    // Streamed through article_reader, as the firmware does
+    CHECK(fat32_open(&vol, &file, "guide/big.txt"));
+    article_reader_t* reader = malloc(sizeof(*reader));
+    article_reader_open(reader, fat32_read, &file, file.size, 1, 0, 2000);
+    int len;
+    const char* line = article_reader_line(reader, 0, &len);
+    CHECK(line && len >= 11 && memcmp(line, "line 000000", 11) == 0);
+    line = article_reader_line(reader, 39999, &len);
+    CHECK(line && len >= 11 && memcmp(line, "line 039999", 11) == 0);
+    line = article_reader_line(reader, 20000, &len);
+    CHECK(line && len >= 11 && memcmp(line, "line 020000", 11) == 0);
+    free(reader);
+    
+    // The card going away
+    img.fail_after = img.reads;
+    vol.fat_lba = 0;
+    vol.sector_lba = 0;
+    CHECK(!fat32_open(&vol, &file, "guide/index.txt") && vol.error == FAT32_IO_ERROR);
+    
+    close(img.fd);
+}
+
+// FAT entry for cluster, as the image has it now
+static uint32_t fat_entry(fat32_t* vol, image_t* img, uint32_t cluster) {
+    uint8_t sector[FAT32_SECTOR];
+    image_read(img, vol->fat + cluster / (FAT32_SECTOR / 4), sector, 1);
+    return le32(sector + cluster % (FAT32_SECTOR / 4) * 4) & 0x0FFFFFFF;
+}
+
+// Change the FAT entry for cluster, forgetting what the volume has cached
+static void set_fat(fat32_t* vol, image_t* img, uint32_t cluster, uint32_t value) {
+    patch32(img, (uint64_t)vol->fat * FAT32_SECTOR + cluster * 4, value);
+    vol->fat_lba = 0;
+    vol->sector_lba = 0;
+}
+
+// The error reading all of path ends in, FAT32_OK if it does not
+static fat32_error_t read_error(fat32_t* vol, const char* path, uint8_t* buf) {
+    fat32_file_t file;
+    if (!fat32_open(vol, &file, path)) return vol->error;
+    int got = fat32_read(&file, 0, buf, file.size);
+    return got == (int)file.size ? FAT32_OK : vol->error;
+}
+
+static void test_damage(const char* image) {
+    static uint8_t buf[1300000];
+    image_t img = { open(image, O_RDONLY), 0, -1, 0 };
+    fat32_t vol;
+    fat32_file_t file;
+    
+    printf("%s, damaged\n", image);
+    if (!fat32_mount(&vol, image_read, &img) || !fat32_open(&vol, &file, "guide/big.txt")) {
+        CHECK(false);
+        return;
+    }
+    
+    // The tenth cluster of big.txt, and the one after it
+    uint32_t cluster = file.cursor.cluster;
+    for (int i = 0; i < 9; i++) cluster = fat_entry(&vol, &img, cluster);
+    uint32_t next = fat_entry(&vol, &img, cluster);
+    uint32_t cluster_bytes = FAT32_SECTOR << vol.cluster_shift;
+    
+    // Cut short: the ten clusters there are, then an error
+    set_fat(&vol, &img, cluster, 0x0FFFFFFF);
+    CHECK(fat32_open(&vol, &file, "guide/big.txt"));
+    CHECK(fat32_read(&file, 0, buf, file.size) == (int)(10 * cluster_bytes));
+    CHECK(vol.error == FAT32_CORRUPT);
+    
+    // Into a free cluster, a bad one, or past the end of the volume
+    set_fat(&vol, &img, cluster, 0);
+    CHECK(read_error(&vol, "guide/big.txt", buf) == FAT32_CORRUPT);
+    set_fat(&vol, &img, cluster, 0x0FFFFFF7);
+    CHECK(read_error(&vol, "guide/big.txt", buf) == FAT32_CORRUPT);
+    set_fat(&vol, &img, cluster, vol.num_clusters + 2);
+    CHECK(read_error(&vol, "guide/big.txt", buf) == FAT32_CORRUPT);
+    
+    // Round in a loop: only as far as the size says
+    set_fat(&vol, &img, cluster, file.cursor.cluster);
+    CHECK(read_error(&vol, "guide/big.txt", buf) == FAT32_OK);
+    
+    set_fat(&vol, &img, cluster, next);
+    CHECK(read_error(&vol, "guide/big.txt", buf) == FAT32_OK);
+    
+    // Boot sectors that are not FAT32: no root, too few clusters for it
+    uint8_t sector[FAT32_SECTOR];
+    image_read(&img, 0, sector, 1);
+    uint64_t boot = sector[0] == 0xEB || sector[0] == 0xE9 ? 0 : (uint64_t)le32(sector + 446 + 8) * FAT32_SECTOR;
+    int clean = img.num_patches;
+    patch32(&img, boot + 44, 0);
+    CHECK(!fat32_mount(&vol, image_read, &img) && vol.error == FAT32_NOT_FAT32);
+    img.num_patches = clean;
+    patch32(&img, boot + 32, 40000);
+    CHECK(!fat32_mount(&vol, image_read, &img) && vol.error == FAT32_NOT_FAT32);
+    img.num_patches = clean;
+    CHECK(fat32_mount(&vol, image_read, &img));
+    
+    // Nothing at all, and an MBR with only a Linux partition
+    image_t blank = { -1, 0, -1, 0 };
+    CHECK(!fat32_mount(&vol, image_read, &blank) && vol.error == FAT32_NOT_FAT32);
+    patch8(&blank, 446 + 4, 0x83);
+    patch8(&blank, 446 + 8, 1);
+    patch8(&blank, 510, 0x55);
+    patch8(&blank, 511, 0xAA);
+    CHECK(!fat32_mount(&vol, image_read, &blank) && vol.error == FAT32_NOT_FAT32);
+    
+    // No card
+    image_t gone = { -1, 0, 0, 0 };
+    CHECK(!fat32_mount(&vol, image_read, &gone) && vol.error == FAT32_IO_ERROR);
+    
+    // Random bytes in the boot sector, the FATs and the first directories:
+    // whatever comes back has to be an error or no more than was asked for
+    static const char* paths[] = {
+        "guide/index.txt", "guide/big.txt", "guide/A Very Long Article Name About Towels.txt",
+        "guide/sub/deep.txt", "readme.txt", "guide/s-l1600.jpg", "guide/extra file number 150.txt",
+    };
+    CHECK(fat32_mount(&vol, image_read, &img));
+    uint64_t metadata = (uint64_t)(vol.data + 64) * FAT32_SECTOR - boot;
+    bool sane = true;
+    int mounted = 0;
+    srand(7);
+    for (int round = 0; round < 200; round++) {
+        img.num_patches = 0;
+        int n = 1 + rand() % 200;
+        for (int i = 0; i < n; i++) {
+            uint64_t at = rand() % 2 ? rand() % FAT32_SECTOR : (uint64_t)rand() % metadata;
+            patch8(&img, boot + at, rand() % 4 ? rand() : (rand() % 2 ? 0xFF : 0x00));
+        }
+        if (!fat32_mount(&vol, image_read, &img)) {
+            sane &= vol.error == FAT32_NOT_FAT32 || vol.error == FAT32_IO_ERROR;
+            continue;
+        }
+        mounted++;
+        for (size_t p = 0; p < sizeof(paths) / sizeof(paths[0]); p++) {
+            if (!fat32_open(&vol, &file, paths[p])) {
+                sane &= vol.error != FAT32_OK && vol.error <= FAT32_CORRUPT;
+                continue;
+            }
+            uint32_t len = file.size < sizeof(buf) ? file.size : sizeof(buf);
+            int got = fat32_read(&file, 0, buf, len);
+            sane &= got >= 0 && (uint32_t)got <= len && ((uint32_t)got == len || vol.error != FAT32_OK);
+            for (int i = 0; i < 50 && file.size > 0; i++) {
+                int want = rand() % 5000;
+                got = fat32_read(&file, rand() % file.size, buf, want);
+                sane &= got >= 0 && got <= want;
+            }
+        }
+    }
+    CHECK(sane);
+    CHECK(mounted > 0);
+    
+    close(img.fd);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("usage: test_fat32 IMAGE...\n");
+        return 1;
+    }
+    for (int i = 1; i < argc; i++) test_image(argv[i]);
+    test_damage(argv[1]);
+    return test_report();
+}
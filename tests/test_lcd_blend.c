@@ -0,0 +1,96 @@
+/*
+ * lcd_blend host test
+ *
+ * Every step of every table has to be the rounded blend it stands for,
+ * and lcd_blend_color has to give the same color without a table. Then
+ * anti-aliased text drawn in bands over a gradient, a new background
+ * every pixel, has to blend each edge pixel against what is under it
+ * while leaving the tables solid-background text uses in the cache.
+ */
+
+#include "lcd_blend.h"
+#include "lcd_glyph.h"
+#include "lcd_band.h"
+#include "lcd_panel.h"
+#include "test.h"
+#include <stddef.h>
+
+#define FG      0xFFD000
+#define TEXT_BG 0x000080
+
+static uint32_t reference(uint32_t fg, uint32_t bg, int a) {
+    uint32_t c = 0;
+    for (int shift = 0; shift <= 16; shift += 8) {
+        int f = (fg >> shift) & 0xFF;
+        int b = (bg >> shift) & 0xFF;
+        c |= (uint32_t)((f * a + b * (15 - a) + 7) / 15) << shift;
+    }
+    return c;
+}
+
+static void test_colors(void) {
+    bool exact = true;
+    for (int i = 0; i < 2000; i++) {
+        uint32_t fg = (i * 2654435761u) & 0xFFFFFF;
+        uint32_t bg = (i * 40503u + 0x00FF00) & 0xFFFFFF;
+        if (i == 0) fg = 0xFFFFFF, bg = 0x000000;
+        const uint32_t* lut = lcd_blend_lut(fg, bg);
+        for (int a = 0; a < LCD_BLEND_STEPS; a++) {
+            exact &= lut[a] == reference(fg, bg, a);
+            exact &= lcd_blend_color(fg, bg, a) == reference(fg, bg, a);
+        }
+    }
+    CHECK(exact);
+}
+
+static void test_cache(void) {
+    CHECK(lcd_blend_lut_cached(0x123456, 0x654321) == NULL);
+    CHECK(lcd_blend_lut_cached(0x123456, 0x654321) == NULL);
+    const uint32_t* lut = lcd_blend_lut(0x123456, 0x654321);
+    CHECK(lcd_blend_lut_cached(0x123456, 0x654321) == lut);
+    CHECK(lcd_blend_lut(0x123456, 0x654321) == lut);
+}
+
+// A horizontal and vertical gradient: no two neighbours alike
+static uint32_t gradient(int x, int y) {
+    return (uint32_t)((x * 3) & 0xFF) << 16 | (uint32_t)((y * 5) & 0xFF) << 8 | 0x40;
+}
+
+static void gradient_scene(void) {
+    for (int x = 0; x < LCD_PANEL_WIDTH; x++) {
+        for (int y = 0; y < LCD_PANEL_HEIGHT; y++) lcd_band_fill(x, y, 1, 1, gradient(x, y));
+    }
+    lcd_glyph_run(50, 85, "GUIDE ENTRY", 11, 2, FG, LCD_GLYPH_NO_BG, 0);
+    lcd_glyph_run(20, 200, "Mostly harmless", 15, 2, FG, LCD_GLYPH_NO_BG, 0);
+}
+
+static void test_gradient(void) {
+    const uint32_t* lut = lcd_blend_lut(FG, TEXT_BG);
+    lcd_band_render(gradient_scene);
+    
+    // Every pixel is some step from the gradient under it to FG, and some
+    // are in between
+    bool blended = true;
+    int edges = 0;
+    for (int y = 0; y < LCD_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < LCD_PANEL_WIDTH; x++) {
+            uint32_t got = lcd_panel[y][x];
+            int a = 0;
+            while (a < LCD_BLEND_STEPS && reference(FG, gradient(x, y), a) != got) a++;
+            blended &= a < LCD_BLEND_STEPS;
+            if (a > 0 && a < LCD_BLEND_STEPS - 1) edges++;
+        }
+    }
+    CHECK(blended);
+    CHECK(edges > 100);
+    
+    // None of it went through the cache
+    CHECK(lcd_blend_lut_cached(FG, TEXT_BG) == lut);
+}
+
+int main(void) {
+    test_colors();
+    test_cache();
+    test_gradient();
+    return test_report();
+}
@@ -0,0 +1,165 @@
+/*
+ * lcd_cmd host test
+ *
+ * Flushes command lists over the recording bus and checks the bytes, the
+ * DC switching and the CS framing the panel would see, then that the
+ * tagged units for the PIO transport describe the same stream.
+ */
+
+#include "lcd_cmd.h"
+#include "lcd_bus_record.h"
+#include "test.h"
+#include <stdio.h>
+
+static void test_window(void) {
+    lcd_cmd_list_t list;
+    
+    lcd_cmd_reset(&list);
+    CHECK(lcd_cmd_window(&list, 0, 0, 319, 319));
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, true);
+    CHECK_STR(lcd_bus_record_log(), "S C 2A D 00 00 01 3F C 2B D 00 00 01 3F C 2C D");
+    
+    // Released instead when nothing follows
+    lcd_cmd_reset(&list);
+    CHECK(lcd_cmd_window(&list, 258, 7, 300, 260));
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, false);
+    CHECK_STR(lcd_bus_record_log(), "S C 2A D 01 02 01 2C C 2B D 00 07 01 04 C 2C s");
+}
+
+static void test_commands(void) {
+    lcd_cmd_list_t list;
+    static const uint8_t pixfmt[] = { 0x66 };
+    
+    // A command without parameters never switches DC to data
+    lcd_cmd_reset(&list);
+    CHECK(lcd_cmd_add(&list, 0x21, NULL, 0));
+    CHECK(lcd_cmd_add(&list, 0x3A, pixfmt, sizeof(pixfmt)));
+    CHECK(lcd_cmd_continue(&list));
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, false);
+    CHECK_STR(lcd_bus_record_log(), "S C 21 C 3A D 66 C 3C s");
+    
+    lcd_cmd_reset(&list);
+    CHECK(lcd_cmd_scroll_area(&list, 0, 320, 160));
+    CHECK(lcd_cmd_scroll_start(&list, 300));
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, false);
+    CHECK_STR(lcd_bus_record_log(), "S C 33 D 00 00 01 40 00 A0 C 37 D 01 2C s");
+    
+    // An empty list is just a CS pulse
+    lcd_cmd_reset(&list);
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, false);
+    CHECK_STR(lcd_bus_record_log(), "S s");
+}
+
+static void test_full(void) {
+    lcd_cmd_list_t list;
+    uint8_t params[LCD_CMD_MAX_BYTES] = { 0 };
+    
+    // Out of commands
+    lcd_cmd_reset(&list);
+    for (int i = 0; i < LCD_CMD_MAX_CMDS; i++) {
+        CHECK(lcd_cmd_add(&list, 0x00, NULL, 0));
+    }
+    CHECK(!lcd_cmd_add(&list, 0x00, NULL, 0));
+    CHECK(list.num_cmds == LCD_CMD_MAX_CMDS);
+    
+    // Out of bytes: a command that does not fit leaves the list as it was
+    lcd_cmd_reset(&list);
+    CHECK(lcd_cmd_add(&list, 0x2C, params, LCD_CMD_MAX_BYTES - 2));
+    CHECK(!lcd_cmd_add(&list, 0x3A, params, 1));
+    CHECK(list.len == LCD_CMD_MAX_BYTES - 1 && list.num_cmds == 1);
+    CHECK(lcd_cmd_add(&list, 0x00, NULL, 0));
+    CHECK(!lcd_cmd_window(&list, 0, 0, 1, 1));
+}
+
+// Turn tagged units back into the recording bus's log, as lcd_cmd_flush
+// would have driven the bus for them
+static const char* untag(const uint16_t* units, size_t n) {
+    static char text[LCD_BUS_RECORD_MAX];
+    size_t len = 0;
+    bool selected = false;
+    bool data = false;
+    
+    text[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint16_t u = units[i];
+        if (u & LCD_TAG_END) {
+            len += snprintf(text + len, sizeof(text) - len, " s");
+            selected = false;
+            continue;
+        }
+        if (!selected) {
+            len += snprintf(text + len, sizeof(text) - len, " S");
+            selected = true;
+            data = false;
+        }
+        if (!(u & LCD_TAG_DATA)) {
+            len += snprintf(text + len, sizeof(text) - len, " C");
+        } else if (!data) {
+            len += snprintf(text + len, sizeof(text) - len, " D");
+        }
+        data = (u & LCD_TAG_DATA) != 0;
+        len += snprintf(text + len, sizeof(text) - len, " %02X", (u >> 6) & 0xFF);
+    }
+    return text + (len ? 1 : 0);
+}
+
+static void test_tagged(void) {
+    lcd_cmd_list_t list;
+    uint16_t units[LCD_CMD_MAX_BYTES + 1];
+    static const uint8_t pixfmt[] = { 0x66 };
+    
+    // Window left open for pixels: no END
+    lcd_cmd_reset(&list);
+    lcd_cmd_window(&list, 1, 2, 0x123, 0x140);
+    static const uint16_t window[] = {
+        LCD_TAG_CMD(0x2A), LCD_TAG_PARAM(0x00), LCD_TAG_PARAM(0x01), LCD_TAG_PARAM(0x01), LCD_TAG_PARAM(0x23),
+        LCD_TAG_CMD(0x2B), LCD_TAG_PARAM(0x00), LCD_TAG_PARAM(0x02), LCD_TAG_PARAM(0x01), LCD_TAG_PARAM(0x40),
+        LCD_TAG_CMD(0x2C),
+    };
+    CHECK(lcd_cmd_encode_tagged(&list, units, 64, true) == 11);
+    CHECK(memcmp(units, window, sizeof(window)) == 0);
+    
+    // Closed: one END after the last byte
+    CHECK(lcd_cmd_encode_tagged(&list, units, 64, false) == 12);
+    CHECK(memcmp(units, window, sizeof(window)) == 0 && units[11] == LCD_TAG_END);
+    
+    // The byte field covers all eight bits without touching the flags
+    CHECK(LCD_TAG_PARAM(0xFF) == 0x7FC0 && LCD_TAG_CMD(0xFF) == 0x3FC0);
+    
+    // Exactly big enough, and one unit short
+    CHECK(lcd_cmd_encode_tagged(&list, units, 11, true) == 11);
+    CHECK(lcd_cmd_encode_tagged(&list, units, 11, false) == 0);
+    CHECK(lcd_cmd_encode_tagged(&list, units, 10, true) == 0);
+    
+    // Same stream as lcd_cmd_flush sends
+    lcd_cmd_reset(&list);
+    lcd_cmd_add(&list, 0x21, NULL, 0);
+    lcd_cmd_add(&list, 0x3A, pixfmt, sizeof(pixfmt));
+    lcd_cmd_window(&list, 0, 0, 319, 319);
+    lcd_cmd_continue(&list);
+    lcd_cmd_scroll_start(&list, 479);
+    size_t n = lcd_cmd_encode_tagged(&list, units, LCD_CMD_MAX_BYTES + 1, false);
+    CHECK(n == (size_t)list.len + 1);
+    lcd_bus_record_reset();
+    lcd_cmd_flush(&list, &lcd_bus_record, false);
+    CHECK_STR(untag(units, n), lcd_bus_record_log());
+    
+    // A full list still fits its END
+    lcd_cmd_reset(&list);
+    uint8_t params[LCD_CMD_MAX_BYTES] = { 0 };
+    lcd_cmd_add(&list, 0x2C, params, LCD_CMD_MAX_BYTES - 1);
+    CHECK(lcd_cmd_encode_tagged(&list, units, LCD_CMD_MAX_BYTES + 1, false) == LCD_CMD_MAX_BYTES + 1);
+}
+
+int main(void) {
+    test_window();
+    test_commands();
+    test_full();
+    test_tagged();
+    return test_report();
+}
@@ -0,0 +1,136 @@
+/*
+ * lcd_dl host test
+ *
+ * Builds a screen's worth of primitives and checks the list through
+ * lcd_dl_dump, then what lcd_dl_diff marks when the list changes.
+ */
+
+#include "lcd_dl.h"
+#include "test.h"
+#include <stdio.h>
+
+// lcd_dl_dump of a list, as one string
+static const char* dump(const lcd_dl_t* dl) {
+    static char text[4096];
+    FILE* f = tmpfile();
+    
+    lcd_dl_dump(dl, f);
+    rewind(f);
+    size_t n = fread(text, 1, sizeof(text) - 1, f);
+    text[n] = 0;
+    fclose(f);
+    return text;
+}
+
+static char marks[1024];
+
+static void mark(int x, int y, int w, int h) {
+    size_t len = strlen(marks);
+    snprintf(marks + len, sizeof(marks) - len, "%s%d,%d,%dx%d", len ? " " : "", x, y, w, h);
+}
+
+static const char* diff(const lcd_dl_t* old_dl, const lcd_dl_t* new_dl) {
+    marks[0] = 0;
+    lcd_dl_diff(old_dl, new_dl, mark);
+    return marks;
+}
+
+// The article screen in miniature: frame, title, a body line and footer
+static void build(lcd_dl_t* dl, int line, int shown) {
+    lcd_dl_reset(dl);
+    lcd_dl_fill(dl, 0, 0, 320, 320, 0x000000);
+    lcd_dl_gradient(dl, 0, 0, 320, 40, 0x002040, 0x000000, false);
+    lcd_dl_rounded(dl, 10, 55, 300, 100, 8, 0x000000);
+    lcd_dl_frame(dl, 10, 55, 300, 100, 0x00C0C0);
+    lcd_dl_outlined_text(dl, 20, 10, "Towel", 0xFFFF00, 0x000000, 2);
+    lcd_dl_widget(dl, 4, 0, 170, 320, 12, 3, line, shown, NULL, NULL);
+    lcd_dl_text(dl, 10, 300, "UP/DOWN ESC", 0x00FF00);
+}
+
+static void test_dump(void) {
+    static lcd_dl_t dl;
+    
+    build(&dl, 40000, 12);
+    CHECK_STR(dump(&dl),
+        "fill          box=0,0,320x320 at=0,0 args=0,0,0,0 color=#000000,#000000\n"
+        "gradient      box=0,0,320x40 at=0,0 args=0,0,0,0 color=#002040,#000000\n"
+        "rounded       box=10,55,300x100 at=10,55 args=8,0,0,0 color=#000000,#000000\n"
+        "frame         box=10,55,301x101 at=10,55 args=300,100,0,0 color=#00c0c0,#000000\n"
+        "outlined_text box=19,9,60x16 at=20,10 args=2,0,0,0 color=#ffff00,#000000 \"Towel\"\n"
+        "widget        box=0,170,320x12 at=0,170 args=4,3,40000,12 color=#000000,#000000\n"
+        "text          box=10,300,62x7 at=10,300 args=0,0,0,0 color=#00ff00,#000000 \"UP/DOWN ESC\"\n");
+    
+    // Strings of both kinds, and none
+    lcd_dl_reset(&dl);
+    lcd_dl_widget(&dl, 0, 0, 0, 320, 50, 0, 0, 0, "GUIDE", "Earth");
+    lcd_dl_widget(&dl, 1, 60, 80, 200, 25, 2, 1, 0, "Browse", NULL);
+    CHECK_STR(dump(&dl),
+        "widget        box=0,0,320x50 at=0,0 args=0,0,0,0 color=#000000,#000000 \"GUIDE\" \"Earth\"\n"
+        "widget        box=60,80,200x25 at=60,80 args=1,2,1,0 color=#000000,#000000 \"Browse\"\n");
+}
+
+static void test_diff(void) {
+    static lcd_dl_t a, b;
+    
+    // Nothing changed
+    build(&a, 5, 12);
+    build(&b, 5, 12);
+    CHECK_STR(diff(&a, &b), "");
+    
+    // One line further along: just that line's slot
+    build(&b, 5, 13);
+    CHECK_STR(diff(&a, &b), "0,170,320x12 0,170,320x12");
+    
+    // Lines 65536 apart are different lines
+    build(&a, 7, 12);
+    build(&b, 7 + 65536, 12);
+    CHECK_STR(diff(&a, &b), "0,170,320x12 0,170,320x12");
+    CHECK(b.prims[5].c == 7 + 65536);
+    
+    // Matched by content: the same primitives in another order are left alone
+    lcd_dl_reset(&a);
+    lcd_dl_fill(&a, 0, 0, 10, 10, 0xFF0000);
+    lcd_dl_fill(&a, 20, 0, 10, 10, 0x00FF00);
+    lcd_dl_reset(&b);
+    lcd_dl_fill(&b, 20, 0, 10, 10, 0x00FF00);
+    lcd_dl_fill(&b, 0, 0, 10, 10, 0xFF0000);
+    CHECK_STR(diff(&a, &b), "");
+    
+    // A primitive that went away is painted over
+    b.num_prims = 1;
+    CHECK_STR(diff(&a, &b), "0,0,10x10");
+    
+    // Text compares by content, not by where it sits in the pool
+    lcd_dl_reset(&a);
+    lcd_dl_text(&a, 0, 0, "MOSTLY", 0xFFFFFF);
+    lcd_dl_reset(&b);
+    lcd_dl_widget(&b, 0, 0, 0, 1, 1, 0, 0, 0, "padding", NULL);
+    lcd_dl_text(&b, 0, 0, "MOSTLY", 0xFFFFFF);
+    CHECK_STR(diff(&a, &b), "0,0,1x1");
+}
+
+static void test_full(void) {
+    static lcd_dl_t dl;
+    static char big[LCD_DL_TEXT_POOL];
+    
+    lcd_dl_reset(&dl);
+    for (int i = 0; i < LCD_DL_MAX_PRIMS; i++) {
+        CHECK(lcd_dl_fill(&dl, i, 0, 1, 1, 0));
+    }
+    CHECK(!lcd_dl_fill(&dl, 0, 0, 1, 1, 0));
+    CHECK(dl.num_prims == LCD_DL_MAX_PRIMS);
+    
+    // A string that does not fit adds nothing, not even its first part
+    memset(big, 'A', sizeof(big) - 1);
+    lcd_dl_reset(&dl);
+    CHECK(lcd_dl_widget(&dl, 0, 0, 0, 1, 1, 0, 0, 0, "ONE", NULL));
+    CHECK(!lcd_dl_widget(&dl, 0, 0, 0, 1, 1, 0, 0, 0, "TWO", big));
+    CHECK(dl.num_prims == 1 && dl.text_len == 4);
+}
+
+int main(void) {
+    test_dump();
+    test_diff();
+    test_full();
+    return test_report();
+}
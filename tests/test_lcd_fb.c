@@ -0,0 +1,93 @@
+/*
+ * lcd_fb host test
+ *
+ * Redraws one spot in more colors than the palette holds and checks every
+ * one of them is kept exactly, because entries nothing shows any more are
+ * reclaimed; and that a screen really showing 256 colors keeps them all.
+ */
+
+#include "lcd_fb.h"
+#include "hardware/interp.h"
+#include "test.h"
+
+interp_hw_t host_interp[2];
+
+static uint32_t color_of(int i) {
+    return (uint32_t)(i * 2654435761u) & 0xFFFFFF;
+}
+
+static void test_redraw(void) {
+    bool exact = true;
+    
+    lcd_fb_reset_palette();
+    lcd_fb_fill(0, 0, LCD_FB_WIDTH, LCD_FB_HEIGHT, 0x000000);
+    
+    // A gradient bar redrawn 40 times in new colors: 1600 colors in all
+    for (int frame = 0; frame < 40; frame++) {
+        for (int i = 0; i < 40; i++) {
+            uint32_t color = color_of(frame * 40 + i + 1);
+            lcd_fb_fill(10 + i * 4, 20, 4, 30, color);
+            lcd_fb_pixel(200, 200 + i, color ^ 0x010101);
+            exact &= lcd_fb_get(10 + i * 4, 20) == color;
+            exact &= lcd_fb_get(200, 200 + i) == (color ^ 0x010101);
+        }
+    }
+    CHECK(exact);
+    CHECK(lcd_fb_get(0, 0) == 0x000000);
+    CHECK(lcd_fb_get(319, 319) == 0x000000);
+}
+
+static void test_full_screen(void) {
+    bool exact = true;
+    
+    // 256 colors really on screen: nothing to reclaim
+    lcd_fb_reset_palette();
+    lcd_fb_fill(0, 0, LCD_FB_WIDTH, LCD_FB_HEIGHT, 0x000000);
+    for (int i = 1; i < LCD_FB_COLORS; i++) {
+        lcd_fb_pixel(i, 5, color_of(i));
+    }
+    CHECK(lcd_fb_reclaim_palette() == 0);
+    
+    // A new color takes the nearest entry and leaves the others alone
+    lcd_fb_pixel(0, 6, 0x010101);
+    CHECK(lcd_fb_get(0, 6) == 0x000000);
+    for (int i = 1; i < LCD_FB_COLORS; i++) {
+        exact &= lcd_fb_get(i, 5) == color_of(i);
+    }
+    CHECK(exact);
+    
+    // Once some of them are drawn over, their entries come back
+    lcd_fb_fill(0, 5, 100, 1, 0x000000);
+    CHECK(lcd_fb_reclaim_palette() == 99);
+    lcd_fb_pixel(0, 6, 0x010101);
+    CHECK(lcd_fb_get(0, 6) == 0x010101);
+    CHECK(lcd_fb_get(100, 5) == color_of(100));
+}
+
+static void test_expand(void) {
+    uint8_t out[LCD_FB_WIDTH * 3];
+    bool same = true;
+    
+    lcd_fb_reset_palette();
+    for (int x = 0; x < LCD_FB_WIDTH; x++) {
+        lcd_fb_pixel(x, 7, color_of(x % 50));
+    }
+    
+    // From every alignment, so both the single and the word paths run
+    for (int x = 0; x < 4; x++) {
+        lcd_fb_expand(x, 7, LCD_FB_WIDTH - x - 1, 1, out);
+        for (int i = 0; i < LCD_FB_WIDTH - x - 1; i++) {
+            uint32_t rgb = (uint32_t)out[i * 3] << 16 | out[i * 3 + 1] << 8 | out[i * 3 + 2];
+            same &= rgb == color_of((x + i) % 50);
+        }
+    }
+    CHECK(same);
+}
+
+int main(void) {
+    lcd_fb_init();
+    test_redraw();
+    test_full_screen();
+    test_expand();
+    return test_report();
+}
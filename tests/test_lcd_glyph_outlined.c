@@ -0,0 +1,157 @@
+/*
+ * lcd_glyph_run_outlined golden test
+ *
+ * The single-pass outlined run has to put on the panel exactly what the
+ * nine-pass renderer it replaced did: the run in the outline color at the
+ * eight surrounding offsets, then in the foreground on top. Both are drawn
+ * through the panel model over a patterned screen, at every scale, in
+ * several places (some clipped by the screen edges) and with characters
+ * outside ASCII, and the frames compared pixel for pixel.
+ *
+ * Band renders are compared too at the 1bpp scales. At 2x the 12x16 font
+ * is anti-aliased and a band blends its edges, against the outline in one
+ * pass but against the layers below in nine, so there the two differ by
+ * design (see lcd_glyph.h).
+ */
+
+#include "lcd_glyph.h"
+#include "lcd_band.h"
+#include "lcd_panel.h"
+#include "test.h"
+
+#define FG      0xFFD000
+#define OUTLINE 0x200040
+
+static uint32_t reference[LCD_PANEL_HEIGHT][LCD_PANEL_WIDTH];
+
+static const char* const texts[] = {
+    "DON'T PANIC",
+    "Mostly harmless",
+    "42",
+    "\xc3\x86r\xc3\xb8 \xc3\x9f\xc3\xa9 \xc2\xbf?",     // Latin-1 letters, upper-cased
+    "i!|.,'",
+};
+
+static const int places[][2] = {
+    { 20, 40 },
+    { -4, -3 },     // off the top left
+    { 250, 300 },   // off the right and the bottom
+    { 0, 0 },       // outline clipped, glyphs not
+};
+
+#define NUM_TEXTS  (int)(sizeof(texts) / sizeof(texts[0]))
+#define NUM_PLACES (int)(sizeof(places) / sizeof(places[0]))
+
+// The run being drawn by the scene
+static const char* run_text;
+static int run_x, run_y, run_scale;
+static bool run_nine_pass;
+
+static void nine_pass(int x, int y, const char* text, int scale) {
+    int len = strlen(text);
+    
+    for (int ox = -1; ox <= 1; ox++) {
+        for (int oy = -1; oy <= 1; oy++) {
+            if (ox == 0 && oy == 0) continue;
+            lcd_glyph_run(x + ox, y + oy, text, len, scale, OUTLINE, LCD_GLYPH_NO_BG, LCD_GLYPH_UPPER);
+        }
+    }
+    lcd_glyph_run(x, y, text, len, scale, FG, LCD_GLYPH_NO_BG, LCD_GLYPH_UPPER);
+}
+
+static void draw_run(void) {
+    if (run_nine_pass) {
+        nine_pass(run_x, run_y, run_text, run_scale);
+    } else {
+        lcd_glyph_run_outlined(run_x, run_y, run_text, strlen(run_text), run_scale,
+                               FG, OUTLINE, LCD_GLYPH_UPPER);
+    }
+}
+
+// Something under the text that is not one color, so a pixel touched
+// that should not have been shows
+static void draw_background(void) {
+    for (int y = 0; y < LCD_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < LCD_PANEL_WIDTH; x++) {
+            lcd_panel[y][x] = ((x * 7) ^ (y * 13)) & 0x3F3F3F;
+        }
+    }
+}
+
+static void band_scene(void) {
+    lcd_fill_rect(0, 0, LCD_PANEL_WIDTH, LCD_PANEL_HEIGHT, 0x103010);
+    for (int y = 0; y < LCD_PANEL_HEIGHT; y += 6) {
+        lcd_fill_rect(0, y, LCD_PANEL_WIDTH, 2, 0x305030);
+    }
+    draw_run();
+}
+
+static bool same_as_reference(const char* how) {
+    for (int y = 0; y < LCD_PANEL_HEIGHT; y++) {
+        for (int x = 0; x < LCD_PANEL_WIDTH; x++) {
+            if (lcd_panel[y][x] != reference[y][x]) {
+                printf("%s \"%s\" at %d,%d scale %d: pixel %d,%d is #%06x, nine passes gave #%06x\n",
+                       how, run_text, run_x, run_y, run_scale, x, y,
+                       (unsigned)lcd_panel[y][x], (unsigned)reference[y][x]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_panel(void) {
+    for (int t = 0; t < NUM_TEXTS; t++) {
+        for (int p = 0; p < NUM_PLACES; p++) {
+            for (int scale = 1; scale <= 5; scale++) {
+                run_text = texts[t];
+                run_x = places[p][0];
+                run_y = places[p][1];
+                run_scale = scale;
+    
+                draw_background();
+                run_nine_pass = true;
+                draw_run();
+                memcpy(reference, lcd_panel, sizeof(reference));
+    
+                draw_background();
+                run_nine_pass = false;
+                draw_run();
+                CHECK(same_as_reference("panel"));
+            }
+        }
+    }
+}
+
+static void test_band(void) {
+    static const int scales[] = { 1, 3, 4, 5 };
+    
+    for (int t = 0; t < NUM_TEXTS; t++) {
+        for (int p = 0; p < NUM_PLACES; p++) {
+            for (int s = 0; s < 4; s++) {
+                run_text = texts[t];
+                run_x = places[p][0];
+                run_y = places[p][1];
+                run_scale = scales[s];
+    
+                // The whole screen, then a region whose edges cut the text
+                run_nine_pass = true;
+                lcd_band_render(band_scene);
+                lcd_band_render_region(band_scene, run_x + 5, run_y + 3, 41, 9);
+                memcpy(reference, lcd_panel, sizeof(reference));
+    
+                draw_background();
+                run_nine_pass = false;
+                lcd_band_render(band_scene);
+                lcd_band_render_region(band_scene, run_x + 5, run_y + 3, 41, 9);
+                CHECK(same_as_reference("band"));
+            }
+        }
+    }
+}
+
+int main(void) {
+    test_panel();
+    test_band();
+    return test_report();
+}
@@ -0,0 +1,244 @@
+/*
+ * sd_card host test
+ *
+ * Brings up fake cards of every kind (version 1, version 2 standard and
+ * high capacity, with and without high speed) and reads them with CMD17
+ * and CMD18; then cards that break CRCs now and then or always, never
+ * finish initialising, are not there, or stop sending data.
+ */
+
+#include "sd_card.h"
+#include "sd_fake_card.h"
+#include "test.h"
+#include <stdlib.h>
+
+static uint8_t buf[64 * SD_BLOCK];
+
+// Read count blocks from lba on and check every one of them
+static bool read_blocks(sd_card_t* card, uint32_t lba, uint32_t count) {
+    memset(buf, 0, count * SD_BLOCK);
+    if (!sd_card_read(card, lba, buf, count)) return false;
+    
+    uint8_t want[SD_BLOCK];
+    for (uint32_t i = 0; i < count; i++) {
+        sd_fake_card_block(lba + i, want);
+        if (memcmp(buf + i * SD_BLOCK, want, SD_BLOCK) != 0) return false;
+    }
+    return true;
+}
+
+static void test_crc(void) {
+    static const uint8_t cmd0[5] = { 0x40, 0x00, 0x00, 0x00, 0x00 };
+    static const uint8_t cmd8[5] = { 0x48, 0x00, 0x00, 0x01, 0xAA };
+    uint8_t ones[SD_BLOCK];
+    memset(ones, 0xFF, sizeof(ones));
+    
+    // The two the spec spells out, and a block of 0xFF
+    CHECK(sd_crc7(cmd0, 5) == 0x95);
+    CHECK(sd_crc7(cmd8, 5) == 0x87);
+    CHECK(sd_crc16(ones, sizeof(ones)) == 0x7FA1);
+}
+
+// Initialise the card sd_fake_card describes, expecting it to work
+static bool init(sd_card_t* card) {
+    sd_fake_card_reset();
+    bool ok = sd_card_init(card, &sd_fake_card_bus);
+    CHECK(ok);
+    CHECK(card->error == SD_OK);
+    CHECK(sd_fake_card.bad_crcs == 0);
+    
+    // At most 400 kHz until the card is up, after 74 clocks or more
+    CHECK(sd_fake_card.cmd0_clock_hz <= SD_INIT_HZ);
+    CHECK(sd_fake_card.idle_bytes * 8 >= 74);
+    return ok;
+}
+
+static void test_init(void) {
+    sd_card_t card;
+    
+    sd_fake_card_defaults();
+    if (init(&card)) {
+        CHECK(strncmp(sd_fake_card_log(), "CMD0 CMD8 CMD59 CMD55 ACMD41", 28) == 0);
+        CHECK(strstr(sd_fake_card_log(), "ACMD41 CMD58 CMD9 CMD6 CMD6") != NULL);
+        CHECK(card.high_capacity);
+        CHECK(card.high_speed);
+        CHECK(card.num_blocks == 1 << 20);
+        CHECK(sd_fake_card.clock_hz == SD_HIGH_SPEED_HZ);
+    }
+    
+    // No CMD6: stays at the default speed
+    sd_fake_card_defaults();
+    sd_fake_card.high_speed = false;
+    if (init(&card)) {
+        CHECK(!card.high_speed);
+        CHECK(sd_fake_card.clock_hz == SD_DEFAULT_HZ);
+    }
+    
+    // Standard capacity: byte addresses and CMD16 for the block length
+    sd_fake_card_defaults();
+    sd_fake_card.high_capacity = false;
+    sd_fake_card.num_blocks = 4096 * 512;
+    if (init(&card)) {
+        CHECK(strstr(sd_fake_card_log(), "CMD58 CMD16 CMD9") != NULL);
+        CHECK(!card.high_capacity);
+        CHECK(card.num_blocks == 4096 * 512);
+    }
+    
+    // Version 1: CMD8 is refused and there is no OCR to ask for
+    sd_fake_card_defaults();
+    sd_fake_card.version = 1;
+    sd_fake_card.high_capacity = false;
+    sd_fake_card.high_speed = false;
+    sd_fake_card.num_blocks = 2048 * 512;
+    if (init(&card)) {
+        CHECK(strstr(sd_fake_card_log(), "CMD58") == NULL);
+        CHECK(strstr(sd_fake_card_log(), "ACMD41 CMD16 CMD9") != NULL);
+        CHECK(!card.high_capacity);
+        CHECK(card.num_blocks == 2048 * 512);
+    }
+}
+
+static void test_reads(void) {
+    static const struct {
+        int version;
+        bool high_capacity;
+        bool high_speed;
+    } kinds[] = {
+        { 2, true, true },
+        { 2, true, false },
+        { 2, false, true },
+        { 1, false, false },
+    };
+    
+    for (size_t k = 0; k < sizeof(kinds) / sizeof(kinds[0]); k++) {
+        sd_card_t card;
+        sd_fake_card_defaults();
+        sd_fake_card.version = kinds[k].version;
+        sd_fake_card.high_capacity = kinds[k].high_capacity;
+        sd_fake_card.high_speed = kinds[k].high_speed;
+        if (!kinds[k].high_capacity) sd_fake_card.num_blocks = 4096 * 512;
+        if (!init(&card)) continue;
+    
+        // One block is a CMD17, more a single CMD18 and its stop
+        sd_fake_card_clear_log();
+        CHECK(read_blocks(&card, 12345, 1));
+        CHECK_STR(sd_fake_card_log(), "CMD17");
+    
+        sd_fake_card_clear_log();
+        CHECK(read_blocks(&card, 70000, 64));
+        CHECK_STR(sd_fake_card_log(), "CMD18 CMD12");
+    
+        bool all = true;
+        srand(k);
+        for (int i = 0; i < 200; i++) {
+            uint32_t count = 1 + rand() % 64;
+            all &= read_blocks(&card, rand() % (sd_fake_card.num_blocks - count), count);
+        }
+        CHECK(all);
+    
+        // The last blocks, and one past them
+        CHECK(read_blocks(&card, sd_fake_card.num_blocks - 8, 8));
+        CHECK(!sd_card_read(&card, sd_fake_card.num_blocks - 8, buf, 9));
+        CHECK(card.error == SD_DATA_ERROR);
+        CHECK(!sd_card_read(&card, sd_fake_card.num_blocks, buf, 1));
+        CHECK(card.error == SD_DATA_ERROR);
+        CHECK(read_blocks(&card, 0, 2));
+        CHECK(card.crc_errors == 0);
+    }
+}
+
+static void test_crc_retry(void) {
+    sd_card_t card;
+    
+    // Now and then: each block that fails is read again, carrying on
+    // from it in a run
+    sd_fake_card_defaults();
+    sd_fake_card.crc_fail_every = 7;
+    if (init(&card)) {
+        bool all = true;
+        for (uint32_t lba = 0; lba < 4000; lba += 40) {
+            all &= read_blocks(&card, lba, lba % 80 ? 40 : 1);
+        }
+        CHECK(all);
+        CHECK(card.crc_errors > 0);
+        // A run reads a block ahead, which the stop throws away
+        CHECK(card.crc_errors <= sd_fake_card.broken_blocks);
+    
+        sd_fake_card.crc_fail_every = 0;
+        sd_fake_card.crc_fail_next = 2;
+        sd_fake_card_clear_log();
+        CHECK(read_blocks(&card, 100, 1));
+        CHECK_STR(sd_fake_card_log(), "CMD17 CMD17 CMD17");
+    
+        // In a run, the read starts again at the block that failed
+        sd_fake_card.crc_fail_next = 1;
+        sd_fake_card_clear_log();
+        CHECK(read_blocks(&card, 100, 16));
+        CHECK_STR(sd_fake_card_log(), "CMD18 CMD12 CMD18 CMD12");
+    }
+    
+    // Every time: given up after SD_RETRIES sends, in init or a read
+    sd_fake_card_defaults();
+    sd_fake_card.crc_fail_every = 1;
+    sd_fake_card_reset();
+    CHECK(!sd_card_init(&card, &sd_fake_card_bus));
+    CHECK(card.error == SD_DATA_ERROR);
+    CHECK(card.crc_errors == SD_RETRIES);
+    
+    sd_fake_card_defaults();
+    if (init(&card)) {
+        sd_fake_card.crc_fail_every = 1;
+        sd_fake_card_clear_log();
+        CHECK(!sd_card_read(&card, 5, buf, 1));
+        CHECK(card.error == SD_DATA_ERROR);
+        CHECK_STR(sd_fake_card_log(), "CMD17 CMD17 CMD17");
+    
+        CHECK(!sd_card_read(&card, 5, buf, 16));
+        CHECK(card.error == SD_DATA_ERROR);
+    }
+}
+
+static void test_broken_cards(void) {
+    sd_card_t card;
+    
+    // Nothing on the bus
+    sd_fake_card_defaults();
+    sd_fake_card.present = false;
+    sd_fake_card_reset();
+    CHECK(!sd_card_init(&card, &sd_fake_card_bus));
+    CHECK(card.error == SD_NO_CARD);
+    
+    // Never ready
+    sd_fake_card_defaults();
+    sd_fake_card.idle_rounds = 0;
+    sd_fake_card_reset();
+    CHECK(!sd_card_init(&card, &sd_fake_card_bus));
+    CHECK(card.error == SD_TIMEOUT);
+    
+    // Ready just before the driver gives up
+    sd_fake_card_defaults();
+    sd_fake_card.idle_rounds = 3999;
+    init(&card);
+    
+    // Takes reads, then never sends the data
+    sd_fake_card_defaults();
+    if (init(&card)) {
+        sd_fake_card.stall = true;
+        CHECK(!sd_card_read(&card, 10, buf, 1));
+        CHECK(card.error == SD_TIMEOUT);
+        CHECK(!sd_card_read(&card, 10, buf, 4));
+        CHECK(card.error == SD_TIMEOUT);
+    
+        sd_fake_card.stall = false;
+        CHECK(read_blocks(&card, 10, 4));
+    }
+}
+
+int main(void) {
+    test_crc();
+    test_init();
+    test_reads();
+    test_crc_retry();
+    test_broken_cards();
+    return test_report();
+}